@@ -10,6 +10,7 @@
 #include "Resource/Mesh.h"
 #include "Resource/Model.h"
 #include "Scene/GameObject.h"
+#include "Scene/SceneCommandBuffer.h"
 #include "Utils/Color.h"
 
 Editor::Editor()
@@ -52,9 +53,13 @@ void Editor::Initialize()
     resourceManager->Load<Model>(RESOURCE_PATH"/models/Suzanne.obj");
     resourceManager->Load<Model>(RESOURCE_PATH"/models/Plane.obj");
     model = resourceManager->Load<Model>(RESOURCE_PATH"/models/Sponza/sponza.obj");
-    model->EOnLoaded.Bind([model, this, currentScene]()
+    model->EOnLoaded.Bind([model, currentScene]()
     {
-        auto go = Model::CreateGameObject(model.getPtr(), currentScene);
+        // Called from the loading thread, the objects are created at the next scene sync point
+        currentScene->GetCommandBuffer().Enqueue([model](Scene& scene)
+        {
+            Model::CreateGameObject(model.getPtr(), &scene);
+        });
     });
     
     // auto go = currentScene->CreateGameObject();
@@ -7,6 +7,7 @@
 
 #include "Render/Vulkan/VulkanTexture.h"
 #include "Render/Vulkan/VulkanRenderer.h"
+#include "Debug/Log.h"
 
 // Validation callback (like in the example)
 static void check_vk_result(VkResult err)
@@ -18,10 +19,16 @@ static void check_vk_result(VkResult err)
         abort();
 }
 
-void ImGuiHandler::Initialize(Window* window, VulkanRenderer* renderer)
+void ImGuiHandler::Initialize(Window* window, IRenderer* renderer)
 {
-    m_renderer = renderer;
-    m_device = renderer->GetDevice();
+    // The ImGui backend records into the Vulkan command buffers
+    if (renderer->GetRenderAPI() != RenderAPI::Vulkan)
+    {
+        PrintError("ImGuiHandler needs the Vulkan renderer");
+        return;
+    }
+    m_renderer = static_cast<VulkanRenderer*>(renderer);
+    m_device = m_renderer->GetDevice();
     
     VkDescriptorPoolSize pool_sizes[] =
     {
@@ -65,7 +72,7 @@ void ImGuiHandler::Initialize(Window* window, VulkanRenderer* renderer)
     ImGui_ImplGlfw_InitForVulkan(glfwWindow, true);
 
     ImGui_ImplVulkan_InitInfo init_info = {};
-    init_info.Instance = renderer->GetContext()->GetInstance();
+    init_info.Instance = m_renderer->GetContext()->GetInstance();
     init_info.PhysicalDevice = m_device->GetPhysicalDevice();
     init_info.Device = m_device->GetDevice();
     init_info.QueueFamily = m_device->GetGraphicsQueueFamily();
@@ -73,7 +80,7 @@ void ImGuiHandler::Initialize(Window* window, VulkanRenderer* renderer)
     init_info.PipelineCache = VK_NULL_HANDLE;
     init_info.DescriptorPool = m_descriptorPool;
     init_info.MinImageCount = 2;
-    init_info.ImageCount = renderer->GetSwapChain()->GetImageCount();
+    init_info.ImageCount = m_renderer->GetSwapChain()->GetImageCount();
     init_info.Allocator = nullptr;
     init_info.CheckVkResultFn = check_vk_result;
     
@@ -82,9 +89,9 @@ void ImGuiHandler::Initialize(Window* window, VulkanRenderer* renderer)
     VkPipelineRenderingCreateInfoKHR pipeline_rendering_create_info = {};
     pipeline_rendering_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
     pipeline_rendering_create_info.colorAttachmentCount = 1;
-    VkFormat colorFormat = renderer->GetRenderPass()->GetColorFormat();
+    VkFormat colorFormat = m_renderer->GetRenderPass()->GetColorFormat();
     pipeline_rendering_create_info.pColorAttachmentFormats = &colorFormat;
-    pipeline_rendering_create_info.depthAttachmentFormat = renderer->GetRenderPass()->GetDepthFormat();
+    pipeline_rendering_create_info.depthAttachmentFormat = m_renderer->GetRenderPass()->GetDepthFormat();
     
     init_info.PipelineInfoMain.PipelineRenderingCreateInfo = pipeline_rendering_create_info;
 
@@ -10,13 +10,14 @@
 
 class Texture;
 class Window;
+class IRenderer;
 class VulkanRenderer;
 class VulkanDevice;
 
 class ImGuiHandler
 {
 public:
-    void Initialize(Window* window, VulkanRenderer* renderer);
+    void Initialize(Window* window, IRenderer* renderer);
     void Cleanup();
     
     void BeginFrame();
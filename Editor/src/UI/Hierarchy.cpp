@@ -35,7 +35,7 @@ void Hierarchy::DisplayObject(GameObject* object, uint64_t& index, bool display)
     }
     ImGui::PushID(static_cast<int>(index));
     // Display arrow button
-    if (!object->GetChildrenUUID().empty())
+    if (object->HasChildren())
     {
         auto& open = openMap[object->GetUUID()];
         if (!open)
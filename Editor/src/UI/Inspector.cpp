@@ -158,6 +158,7 @@ void Inspector::ShowMaterials(const Property& property)
 {
     auto materials = static_cast<std::vector<SafePtr<Material>>*>(property.data);
     auto materialList = *materials;
+    bool changed = false;
     size_t i = 0;
     for (SafePtr<Material>& material : materialList)
     {
@@ -177,6 +178,7 @@ void Inspector::ShowMaterials(const Property& property)
                 if (ImGui::MenuItem(mat->GetName().c_str()))
                 {
                     material = mat;
+                    changed = true;
                 }
                 ImGui::PopID();
             }
@@ -190,7 +192,13 @@ void Inspector::ShowMaterials(const Property& property)
         }
         ImGui::PopID();
     }
-    *materials = materialList;
+    if (!changed)
+        return;
+    // The setter keeps the handles of the component in sync
+    if (property.setter)
+        property.setter(&materialList);
+    else
+        *materials = materialList;
 }
 
 void Inspector::ShowMesh(const Property& property)
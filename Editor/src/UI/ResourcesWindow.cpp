@@ -9,6 +9,8 @@ void ResourcesWindow::OnRender()
         ImGui::Text("FPS: %f", ImGui::GetIO().Framerate);
         ImGui::Text("Triangle Count: %llu", p_engine->GetRenderer()->GetTriangleCount());
         ImGui::Text("Vertex Count: %llu", p_engine->GetRenderer()->GetVertexCount());
+        for (uint32_t lod = 0; lod < Mesh::MaxLodCount; lod++)
+            ImGui::Text("LOD %u Triangles: %llu", lod, p_engine->GetRenderer()->GetLodTriangleCount(lod));
         
         if (ImGui::CollapsingHeader("Resources"))
         {
@@ -1,8 +1,23 @@
 ﻿#include "IComponent.h"
 
-#include "Debug/Log.h"
+#include <cmath>
 
-IComponent::~IComponent()
+#include "TransformComponent.h"
+#include "Scene/GameObject.h"
+
+IComponent::~IComponent() = default;
+
+float IComponent::GetSignificance(const Vec3f& viewPosition) const
 {
-    PrintLog("Component %s destroyed", GetTypeName());
+    // Half rate at this distance, a tenth at nine times it
+    constexpr float HalfRateDistance = 50.0f;
+
+    const TransformComponent* transform = p_gameObject ? p_gameObject->ResolveTransform() : nullptr;
+    if (!transform)
+        return 1.0f;
+    const Vec3f position = transform->GetWorld().position;
+    const float dx = position.x - viewPosition.x;
+    const float dy = position.y - viewPosition.y;
+    const float dz = position.z - viewPosition.z;
+    return HalfRateDistance / (HalfRateDistance + std::sqrt(dx * dx + dy * dy + dz * dz));
 }
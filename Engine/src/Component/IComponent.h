@@ -3,6 +3,7 @@
 
 #include "Core/UUID.h"
 #include "Scene/ClassDescriptor.h"
+#include "Utils/Handle.h"
 
 #define DECLARE_COMPONENT_TYPE_PARENT(T, P) \
     T() = default; \
@@ -12,14 +13,17 @@
     T(T&&) noexcept = default;\
     virtual ~T() override = default;\
     const char* GetTypeName() const override { return #T; } \
+    static constexpr const char* StaticTypeName() { return #T; } \
     using Super = P;
 
 
 #define DECLARE_COMPONENT_TYPE(T) DECLARE_COMPONENT_TYPE_PARENT(T, IComponent)
     
 
-class VulkanRenderer;
+class IRenderer;
 class GameObject;
+struct ComponentUpdateInfo;
+class Scene;
 
 class IComponent
 {
@@ -33,20 +37,40 @@ class IComponent
     
     virtual const char* GetTypeName() const { return "IComponent"; }
     virtual void Describe(ClassDescriptor& d) {}
+    // Hide in a derived type to declare what its OnUpdate reads and writes
+    static void DescribeUpdate(ComponentUpdateInfo& info) {}
 
     virtual void OnCreate() {}
     virtual void OnStart() {}
     virtual void OnUpdate(float deltaTime) {}
-    virtual void OnRender(VulkanRenderer* renderer) {}
+    virtual void OnRender(IRenderer* renderer) {}
     virtual void OnDestroy() {}
+
+    // For types declaring Significance, in (0, 1]: the instance updates at this fraction of the rate of its type.
+    // Defaults to a falloff with the distance of the GameObject to the view.
+    virtual float GetSignificance(const Vec3f& viewPosition) const;
     
     bool IsEnable() const { return p_enable; }
     void SetEnable(bool enable) { p_enable = enable; }
     
     Core::UUID GetUUID() const { return p_uuid; }
     GameObject* GetGameObject() const { return p_gameObject; }
+    // Resolved through Scene::Resolve, valid until the component is removed
+    Handle<IComponent> GetHandle() const { return m_handle; }
 protected:
     bool p_enable = true;
     Core::UUID p_uuid;
     GameObject* p_gameObject = nullptr;
+private:
+    friend struct ComponentArray;
+    friend Scene;
+    friend class ComponentScheduler;
+    
+    // Position inside the scene ComponentArray of this type
+    uint32_t m_storageIndex = 0;
+    Handle<IComponent> m_handle;
+    // For the types updated at their own rate: time counted since the last OnUpdate,
+    // and the wait before counting starts, spreading new instances. Negative until scheduled once.
+    float m_updateElapsed = 0.0f;
+    float m_updateDelay = -1.0f;
 };
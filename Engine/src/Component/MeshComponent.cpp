@@ -1,74 +1,151 @@
 ﻿#include "MeshComponent.h"
 
+#include <cfloat>
+#include <cmath>
+
 #include "Core/Engine.h"
 
-#include "Render/Vulkan/VulkanRenderer.h"
+#include "Render/IRenderer.h"
 
+#include "Scene/ComponentHandler.h"
 #include "Scene/GameObject.h"
 
 #include "TransformComponent.h"
 #include "Utils/Color.h"
 
+namespace
+{
+    // Projected height of the sphere around the bounds, as a fraction of the screen height
+    float ComputeScreenSize(const CameraData& camera, const BoundingBox& worldBounds)
+    {
+        if (!worldBounds.IsValid())
+            return FLT_MAX;
+
+        const Vec3f center = worldBounds.GetCenter();
+        const Vec3f extents = worldBounds.GetExtents();
+        const Vec3f top = center + camera.up * std::sqrt(extents.Dot(extents));
+        // Column order matrix, like the batch math kernels
+        const float* m = reinterpret_cast<const float*>(&camera.VP);
+        const float centerY = m[1] * center.x + m[5] * center.y + m[9] * center.z + m[13];
+        const float centerW = m[3] * center.x + m[7] * center.y + m[11] * center.z + m[15];
+        const float topY = m[1] * top.x + m[5] * top.y + m[9] * top.z + m[13];
+        const float topW = m[3] * top.x + m[7] * top.y + m[11] * top.z + m[15];
+        // Around or behind the camera
+        if (centerW <= 0.0f || topW <= 0.0f)
+            return FLT_MAX;
+        // Radius in NDC, where the screen is 2 high, so also the diameter over the screen height
+        return std::fabs(topY / topW - centerY / centerW);
+    }
+}
+
 void MeshComponent::Describe(ClassDescriptor& d)
 {
-    d.AddProperty("Mesh", PropertyType::Mesh, &m_mesh);
-    d.AddProperty("Materials", PropertyType::Materials, &m_materials);
+    d.AddProperty("Mesh", PropertyType::Mesh, &m_mesh).setter = [this](void* data)
+    {
+        SetMesh(*static_cast<std::shared_ptr<Mesh>*>(data));
+    };
+    d.AddProperty("Materials", PropertyType::Materials, &m_materials).setter = [this](void* data)
+    {
+        SetMaterials(*static_cast<std::vector<SafePtr<Material>>*>(data));
+    };
+    d.AddProperty("Occluder", PropertyType::Bool, &m_occluder);
+}
+
+void MeshComponent::DescribeUpdate(ComponentUpdateInfo& info)
+{
+    info.Read<TransformComponent>().Parallel();
 }
 
 void MeshComponent::OnUpdate(float deltaTime)
 {    
-    if (!m_mesh)
+    const Mesh* mesh = ResolveMesh();
+    const bool boundsValid = mesh && mesh->GetBoundingBox().IsValid();
+    if (mesh == m_boundsMesh && boundsValid == m_boundsValid)
         return;
 
-    CameraData cameraData = p_gameObject->GetScene()->GetCameraData();
-    auto transform = p_gameObject->GetTransform();
-    m_visible = m_mesh->GetBoundingBox().IsOnFrustum(cameraData.frustum, transform.getPtr());
-    if (!m_visible)
-        return;
-    Mat4 VP = cameraData.VP;
+    // The transform keeps the world box of the mesh, one mesh per GameObject, and the scene culls it.
+    // A mesh without bounds is always drawn, a removed mesh clears them.
+    // Only the slot of this transform is written, like its dirty flag.
+    p_gameObject->ResolveTransform()->SetLocalBounds(boundsValid ? mesh->GetBoundingBox() : BoundingBox(), mesh && !boundsValid);
+    m_boundsMesh = mesh;
+    m_boundsValid = boundsValid;
+}
 
-    for (auto& material : m_materials)
-    {
-        material->SetAttribute("viewProj", VP);
-    }
+void MeshComponent::OnDestroy()
+{
+    if (!m_boundsMesh)
+        return;
+    if (TransformComponent* transform = p_gameObject->ResolveTransform())
+        transform->SetLocalBounds(BoundingBox());
 }
 
-void MeshComponent::OnRender(VulkanRenderer* renderer) 
+// Only called for the objects the scene found visible
+void MeshComponent::OnRender(IRenderer* renderer) 
 {
-    if (!m_visible)
+    const ResourceManager* resourceManager = p_gameObject->GetScene()->GetResourceManager();
+    if (!resourceManager)
         return;
+
+    // Resolved once per frame and reused by the draw, null for a material destroyed since
+    thread_local std::vector<Material*> s_materials;
+    s_materials.clear();
+    for (const Handle<Material>& handle : m_materialHandles)
+        s_materials.push_back(resourceManager->Resolve(handle));
+
+    // Materials are shared between meshes, written here on the main thread instead of in the parallel update
+    const Mat4& VP = p_gameObject->GetScene()->GetCameraData().VP;
+    for (Material* material : s_materials)
+    {
+        if (material)
+            material->SetAttribute("viewProj", VP);
+    }
+    Mesh* mesh = ResolveMesh();
+    if (mesh && mesh->GetLodCount() > 1)
+    {
+        const float screenSize = ComputeScreenSize(p_gameObject->GetScene()->GetCameraData(), p_gameObject->ResolveTransform()->GetWorldBounds());
+        m_lod = mesh->SelectLod(screenSize, std::min(m_lod, mesh->GetLodCount() - 1));
+    }
+    else
+    {
+        m_lod = 0;
+    }
 #ifdef RENDER_QUEUE
     auto queue = renderer->GetRenderQueueManager()->GetOpaqueQueue();
-    queue->SubmitMeshRenderer(GetGameObject(), this->m_mesh.getPtr(), m_materials);
+    queue->SubmitMeshRenderer(GetGameObject(), mesh, s_materials, m_lod);
 #else
-    if (!m_mesh || !m_mesh->IsLoaded() || !m_mesh->SentToGPU() || !m_mesh->GetVertexBuffer() || !m_mesh->GetIndexBuffer())
+    if (!mesh || !mesh->IsLoaded() || !mesh->SentToGPU() || !mesh->GetVertexBuffer() || !mesh->GetIndexBuffer())
         return;
 
-    auto transformComponent = p_gameObject->GetComponent<TransformComponent>();
-    auto model = transformComponent->GetWorldMatrix();
+    if (s_materials.empty())
+        return;
+
+    const Mat4 model = p_gameObject->ResolveTransform()->GetRenderMatrix();
     // Render each submesh with its corresponding material
-    size_t materialCount = m_materials.size();
+    size_t materialCount = s_materials.size();
         
-    auto subMeshes = m_mesh->GetSubMeshes();
+    const auto& subMeshes = mesh->GetSubMeshes(m_lod);
     for (size_t i = 0; i < subMeshes.size(); ++i)
     {
         size_t materialIndex = i % materialCount;
-        auto& material = m_materials[materialIndex];
+        Material* material = s_materials[materialIndex];
+        if (!material)
+            continue;
             
-        auto shader = material->GetShader().getPtr();
+        Shader* shader = resourceManager->Resolve(material->GetShaderHandle());
         if (!renderer->BindShader(shader))
             continue;
-        if (!renderer->BindMaterial(material.getPtr()))
+        if (!renderer->BindMaterial(material))
             continue;
 
-        renderer->BindVertexBuffers(m_mesh->GetVertexBuffer(), m_mesh->GetIndexBuffer());
+        renderer->BindVertexBuffers(mesh->GetVertexBuffer(), mesh->GetIndexBuffer());
 
         PushConstant pushConstant = shader->GetPushConstants()[ShaderType::Vertex];
         renderer->SendPushConstants(&model, sizeof(model), shader, pushConstant);
             
-        renderer->DrawVertexSubMesh(m_mesh->GetIndexBuffer(), 
+        renderer->DrawVertexSubMesh(mesh->GetIndexBuffer(), 
                                    subMeshes[i].startIndex, 
-                                   subMeshes[i].count);
+                                   subMeshes[i].count,
+                                   m_lod);
     }
 #endif
 }
@@ -76,9 +153,35 @@ void MeshComponent::OnRender(VulkanRenderer* renderer)
 void MeshComponent::SetMesh(const SafePtr<Mesh>& mesh)
 {
     m_mesh = mesh;
+    m_meshHandle = mesh ? mesh->GetResourceHandle().Cast<Mesh>() : Handle<Mesh>();
+}
+
+Mesh* MeshComponent::ResolveMesh() const
+{
+    const ResourceManager* resourceManager = p_gameObject->GetScene()->GetResourceManager();
+    if (!m_meshHandle || !resourceManager)
+        return nullptr;
+    return resourceManager->Resolve(m_meshHandle);
+}
+
+const Mesh* MeshComponent::GetOccluderMesh() const
+{
+    if (!m_occluder)
+        return nullptr;
+    const Mesh* mesh = ResolveMesh();
+    return mesh && mesh->IsLoaded() && !mesh->GetVertices().empty() ? mesh : nullptr;
+}
+
+void MeshComponent::SetMaterials(const std::vector<SafePtr<Material>>& materials)
+{
+    m_materials = materials;
+    m_materialHandles.clear();
+    for (const SafePtr<Material>& material : m_materials)
+        m_materialHandles.push_back(material ? material->GetResourceHandle().Cast<Material>() : Handle<Material>());
 }
 
 void MeshComponent::AddMaterial(const SafePtr<Material>& material)
 {
     m_materials.push_back(material);
+    m_materialHandles.push_back(material ? material->GetResourceHandle().Cast<Material>() : Handle<Material>());
 }
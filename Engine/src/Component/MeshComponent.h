@@ -11,17 +11,41 @@ class MeshComponent : public IComponent
     DECLARE_COMPONENT_TYPE(MeshComponent)
     
     void Describe(ClassDescriptor& d) override;
+    static void DescribeUpdate(ComponentUpdateInfo& info);
     
     void OnUpdate(float deltaTime) override;
-    void OnRender(VulkanRenderer* renderer) override;
+    void OnRender(IRenderer* renderer) override;
+    void OnDestroy() override;
     
     void SetMesh(const SafePtr<Mesh>& mesh);
     
     void AddMaterial(const SafePtr<Material>& material);
+    void SetMaterials(const std::vector<SafePtr<Material>>& materials);
     
     std::vector<SafePtr<Material>> GetMaterials() const { return m_materials; }
+
+    // Occluders are rasterized by the scene occlusion culling, pick large closed meshes like walls
+    void SetOccluder(bool occluder) { m_occluder = occluder; }
+    bool IsOccluder() const { return m_occluder; }
+    // Mesh to rasterize, null if this is not an occluder or the mesh is not loaded
+    const Mesh* GetOccluderMesh() const;
+
+    // Level of detail picked at the last render
+    uint32_t GetLod() const { return m_lod; }
+private:
+    Mesh* ResolveMesh() const;
 private:
+    // m_materials keeps the editor and serialization view, the per-frame code goes through the handles
     std::vector<SafePtr<Material>> m_materials;
+    std::vector<Handle<Material>> m_materialHandles;
+    // m_mesh keeps the editor and serialization view, the per-frame code goes through the handle
     SafePtr<Mesh> m_mesh;
-    bool m_visible = true;
+    Handle<Mesh> m_meshHandle;
+
+    // Mesh whose bounds were given to the transform, and whether they were valid, a mesh may get them once loaded
+    const Mesh* m_boundsMesh = nullptr;
+    bool m_boundsValid = false;
+
+    bool m_occluder = false;
+    uint32_t m_lod = 0;
 };
@@ -10,6 +10,15 @@
 #include "Utils/Color.h"
 #include "Utils/Random.h"
 
+namespace
+{
+    // The compute simulation only exists on the Vulkan backend, see OnCreate
+    VulkanRenderer* GetVulkanRenderer()
+    {
+        return static_cast<VulkanRenderer*>(Engine::Get()->GetRenderer());
+    }
+}
+
 
 template <typename T>
 T MinMax<T>::RandomValue(Seed seed) const
@@ -50,7 +59,6 @@ void ParticleSystemComponent::OnCreate()
 {
     m_seed = Random::Global().Range(0, 100000);
     auto resourceManager = Engine::Get()->GetResourceManager();
-    auto renderer = Engine::Get()->GetRenderer();
 
     auto computeShader = resourceManager->Load<Shader>(RESOURCE_PATH"/shaders/ParticleCompute/particle.shader");
     auto instancingShader = resourceManager->Load<Shader>(RESOURCE_PATH"/shaders/Instancing/instancing.shader");
@@ -63,6 +71,11 @@ void ParticleSystemComponent::OnCreate()
     m_mesh = resourceManager->Load<Mesh>(RESOURCE_PATH"/models/Cube.obj/Cube.mesh");
     SetParticleCount(m_particleSettings.general.particleCount);
 
+    // The simulation runs in a compute shader, there is no device to run it on
+    if (Engine::Get()->GetRenderer()->GetRenderAPI() != RenderAPI::Vulkan)
+        return;
+    VulkanRenderer* renderer = GetVulkanRenderer();
+
     computeShader->EOnSentToGPU.Bind([this, computeShader, renderer]()
     {
         m_compute = computeShader->CreateDispatch(renderer);
@@ -190,7 +203,7 @@ void ParticleSystemComponent::OnUpdate(float deltaTime)
         m_currentTime += deltaTime;
     }
 
-    auto renderer = Engine::Get()->GetRenderer();
+    VulkanRenderer* renderer = GetVulkanRenderer();
     VkCommandBuffer cmd = renderer->GetCommandBuffer();
 
     VulkanMaterial* mat = m_compute->GetMaterial();
@@ -286,7 +299,7 @@ void ParticleSystemComponent::OnUpdate(float deltaTime)
     }
 }
 
-void ParticleSystemComponent::OnRender(VulkanRenderer* renderer)
+void ParticleSystemComponent::OnRender(IRenderer* renderer)
 {
     if (!m_mesh || !m_mesh->IsLoaded() || !m_mesh->SentToGPU())
         return;
@@ -354,7 +367,7 @@ void ParticleSystemComponent::SetBillboard(bool enable)
 
 void ParticleSystemComponent::RecreateParticleBuffers()
 {
-    auto renderer = Engine::Get()->GetRenderer();
+    VulkanRenderer* renderer = GetVulkanRenderer();
     auto device = renderer->GetDevice();
 
     renderer->WaitForGPU();
@@ -504,7 +517,7 @@ void ParticleSystemComponent::ReadbackDebugData()
     if (!m_debugReadbackEnabled || !m_debugReadbackBuffer)
         return;
 
-    auto renderer = Engine::Get()->GetRenderer();
+    VulkanRenderer* renderer = GetVulkanRenderer();
 
     renderer->WaitForGPU();
 
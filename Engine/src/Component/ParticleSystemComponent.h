@@ -129,7 +129,7 @@ class ParticleSystemComponent : public IComponent
     void Describe(ClassDescriptor& d) override;
     void OnCreate() override;
     void OnUpdate(float deltaTime) override;
-    void OnRender(VulkanRenderer* renderer) override;
+    void OnRender(IRenderer* renderer) override;
     void OnDestroy() override;
 
     void SetParticleCount(int count);
@@ -2,6 +2,7 @@
 
 #include "TransformComponent.h"
 #include "Debug/Log.h"
+#include "Scene/ComponentHandler.h"
 #include "Scene/GameObject.h"
 
 void TestComponent::Describe(ClassDescriptor& d)
@@ -9,19 +10,26 @@ void TestComponent::Describe(ClassDescriptor& d)
     d.AddFloat("Speed", m_speed);
 }
 
+void TestComponent::DescribeUpdate(ComponentUpdateInfo& info)
+{
+    // Only touches the transform of its own GameObject
+    info.Write<TransformComponent>().Parallel();
+}
+
 void TestComponent::OnCreate()
 {
-    m_transform = GetGameObject()->GetComponent<TransformComponent>();
+    m_transform = GetGameObject()->GetTransformHandle();
 }
 
 void TestComponent::OnUpdate(float deltaTime)
 {
-    if (!m_transform)
+    TransformComponent* transform = p_gameObject->GetScene()->Resolve(m_transform);
+    if (!transform)
     {
         PrintError("TestComponent::OnUpdate: m_transform is null");
         return;
     }
     
-    Quat rotation = m_transform->GetLocalRotation();
-    m_transform->SetLocalRotation(rotation * Quat::AngleAxis(deltaTime * m_speed, Vec3f::Up()));
+    Quat rotation = transform->GetLocalRotation();
+    transform->SetLocalRotation(rotation * Quat::AngleAxis(deltaTime * m_speed, Vec3f::Up()));
 }
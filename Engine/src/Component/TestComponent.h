@@ -9,11 +9,12 @@ class TestComponent : public IComponent
     DECLARE_COMPONENT_TYPE(TestComponent)
     
     void Describe(ClassDescriptor& d) override;
+    static void DescribeUpdate(ComponentUpdateInfo& info);
     
     void OnCreate() override;
     void OnUpdate(float deltaTime) override;
 
 private:
-    SafePtr<TransformComponent> m_transform;
+    Handle<TransformComponent> m_transform;
     float m_speed = 60.f;
 };
@@ -1,59 +1,89 @@
 ﻿#include "TransformComponent.h"
-#include "Scene/GameObject.h"
 
 void TransformComponent::Describe(ClassDescriptor& d)
 {
     d.AddProperty("", PropertyType::Transform, this);
 }
 
-void TransformComponent::OnUpdate(float deltaTime)
+const Mat4& TransformComponent::GetWorldMatrix() const
 {
-    UpdateMatrix();
+    return m_hierarchy ? m_hierarchy->GetWorldMatrix(m_hierarchyIndex) : m_modelMatrix;
 }
 
-Mat4 TransformComponent::GetWorldMatrix() const
+const Mat4& TransformComponent::GetRenderMatrix() const
 {
-    return m_modelMatrix;
+    return m_hierarchy ? m_hierarchy->GetRenderMatrix(m_hierarchyIndex) : m_modelMatrix;
+}
+
+void TransformComponent::SkipInterpolation()
+{
+    if (m_hierarchy)
+        m_hierarchy->SkipInterpolation(m_hierarchyIndex);
 }
 
 Mat4 TransformComponent::GetLocalMatrix() const
 {
-    return Mat4::CreateTransformMatrix(m_localPosition, m_localRotation, m_localScale);
+    const TransformLocal& local = Local();
+    return Mat4::CreateTransformMatrix(local.position, local.rotation, local.scale);
 }
 
 Vec3f TransformComponent::GetForward() const
 {
-    return m_localRotation * Vec3f::Forward();
+    return Local().rotation * Vec3f::Forward();
 }
 
 Vec3f TransformComponent::GetRight() const
 {
-    return m_localRotation * Vec3f::Right();
+    return Local().rotation * Vec3f::Right();
 }
 
 Vec3f TransformComponent::GetUp() const
 {
-    return m_localRotation * Vec3f::Up();
+    return Local().rotation * Vec3f::Up();
+}
+
+TransformComponent* TransformComponent::GetParentTransform() const
+{
+    return m_hierarchy ? m_hierarchy->GetParent(m_hierarchyIndex) : nullptr;
+}
+
+void TransformComponent::SetLocalBounds(const BoundingBox& bounds, bool alwaysVisible)
+{
+    if (!m_hierarchy)
+        return;
+    // Read by the scene with the changed bounds
+    m_alwaysVisible = alwaysVisible;
+    m_hierarchy->SetLocalBounds(m_hierarchyIndex, bounds);
+}
+
+std::vector<TransformComponent*> TransformComponent::GetChildTransforms() const
+{
+    if (!m_hierarchy)
+        return {};
+    return m_hierarchy->GetChildren(m_hierarchyIndex);
+}
+
+void TransformComponent::SetDirty()
+{
+    if (m_hierarchy)
+        m_hierarchy->SetDirty(m_hierarchyIndex);
+    else
+        m_dirty = true;
 }
 
 void TransformComponent::SetLocalPosition(const Vec3f& position)
 {
-    m_localPosition = position;
+    Local().position = position;
     SetDirty();
 }
 
 void TransformComponent::SetWorldPosition(const Vec3f& position)
 {
-    if (!p_gameObject)
-    {
-        SetLocalPosition(position);
-        return;
-    }
-
-    auto parent = p_gameObject->GetParent();
-    if (parent)
+    if (TransformComponent* parent = GetParentTransform())
     {
-        Mat4 parentWorldMatrix = parent->GetTransform()->GetWorldMatrix();
+        // Current even if the parent moved this frame
+        Mat4 parentWorldMatrix;
+        m_hierarchy->ComputeCurrentWorld(parent->m_hierarchyIndex, &parentWorldMatrix);
         SetLocalPosition(parentWorldMatrix.GetInverseMatrix() * position);
     }
     else
@@ -62,31 +92,30 @@ void TransformComponent::SetWorldPosition(const Vec3f& position)
     }
 }
 
+TransformWorld TransformComponent::GetWorld() const
+{
+    if (!m_hierarchy)
+        return { m_local.position, m_local.rotation, m_local.scale };
+    // Recomputed when the transform or one of its ancestors changed this frame, else the values of the last update
+    return m_hierarchy->ComputeCurrentWorld(m_hierarchyIndex);
+}
+
 Vec3f TransformComponent::GetWorldPosition() const
 {
-    if (!p_gameObject)
-        return m_localPosition;
-    return GetWorldMatrix().GetTranslation();
+    return GetWorld().position;
 }
 
 void TransformComponent::SetLocalRotation(const Quat& rotation)
 {
-    m_localRotation = rotation;
+    Local().rotation = rotation;
     SetDirty();
 }
 
 void TransformComponent::SetWorldRotation(const Quat& rotation)
 {
-    if (!p_gameObject)
-    {
-        SetLocalRotation(rotation);
-        return;
-    }
-
-    auto parent = p_gameObject->GetParent();
-    if (parent)
+    if (TransformComponent* parent = GetParentTransform())
     {
-        Quat parentRotation = parent->GetTransform()->GetWorldRotation();
+        Quat parentRotation = parent->GetWorldRotation();
         SetLocalRotation(parentRotation.GetInverse() * rotation);
     }
     else
@@ -97,35 +126,20 @@ void TransformComponent::SetWorldRotation(const Quat& rotation)
 
 Quat TransformComponent::GetWorldRotation() const
 {
-    if (!p_gameObject)
-        return m_localRotation;
-
-    auto parent = p_gameObject->GetParent();
-    if (parent)
-    {
-        return parent->GetTransform()->GetWorldRotation() * m_localRotation;
-    }
-    return m_localRotation;
+    return GetWorld().rotation;
 }
 
 void TransformComponent::SetLocalScale(const Vec3f& scale)
 {
-    m_localScale = scale;
+    Local().scale = scale;
     SetDirty();
 }
 
 void TransformComponent::SetWorldScale(const Vec3f& scale)
 {
-    if (!p_gameObject)
-    {
-        SetLocalScale(scale);
-        return;
-    }
-
-    auto parent = p_gameObject->GetParent();
-    if (parent)
+    if (TransformComponent* parent = GetParentTransform())
     {
-        Vec3f parentScale = parent->GetTransform()->GetWorldScale();
+        Vec3f parentScale = parent->GetWorldScale();
 
         Vec3f newLocalScale;
         newLocalScale.x = (parentScale.x != 0.0f) ? scale.x / parentScale.x : 0.0f;
@@ -142,14 +156,7 @@ void TransformComponent::SetWorldScale(const Vec3f& scale)
 
 Vec3f TransformComponent::GetWorldScale() const
 {
-    if (!p_gameObject)
-        return m_localScale;
-    if (auto parent = p_gameObject->GetParent())
-    {
-        Vec3f parentScale = parent->GetTransform()->GetWorldScale();
-        return parentScale * m_localScale;
-    }
-    return m_localScale;
+    return GetWorld().scale;
 }
 
 void TransformComponent::Rotate(const Vec3f& axis, const float angle, Space relativeTo)
@@ -193,45 +200,13 @@ Vec3f TransformComponent::TransformDirection(Vec3f dir) const
     return GetWorldRotation() * dir;
 }
 
-void TransformComponent::UpdateMatrix(bool force)
+void TransformComponent::UpdateMatrix()
 {
-    if (!m_dirty && !force) 
-        return;
-    
-    if (!p_gameObject)
-    {
-        ComputeModelMatrix();
+    if (m_hierarchy || !m_dirty)
         return;
-    }
-    
-    if (SafePtr<GameObject> parent = p_gameObject->GetParent())
-    {
-        ComputeModelMatrix(parent->GetTransform()->GetWorldMatrix());
-    }
-    else
-    {
-        ComputeModelMatrix();
-    }
-    
-    for (auto& child : p_gameObject->GetChildren())
-    {
-        child->GetTransform()->UpdateMatrix(true);
-    }
-}
 
-void TransformComponent::ComputeModelMatrix(const Mat4& parentMatrix)
-{
-    UpdateModelMatrix(parentMatrix * GetLocalMatrix());
-}
-
-void TransformComponent::ComputeModelMatrix()
-{
-    UpdateModelMatrix(GetLocalMatrix());
-}
-
-void TransformComponent::UpdateModelMatrix(const Mat4& matrix)
-{
-    m_modelMatrix = matrix;
-    EOnUpdateModelMatrix.Invoke();
+    m_modelMatrix = GetLocalMatrix();
+    m_version++;
     m_dirty = false;
+    EOnUpdateModelMatrix.Invoke();
 }
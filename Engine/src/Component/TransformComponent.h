@@ -3,6 +3,7 @@
 
 #include <galaxymath/Maths.h>
 
+#include "Scene/TransformHierarchy.h"
 #include "Utils/Event.h"
 
 enum class Space
@@ -18,9 +19,14 @@ class TransformComponent : public IComponent
     
     void Describe(ClassDescriptor& d) override;
 
-    void OnUpdate(float deltaTime) override;
+    // Only needed for transforms outside of a scene, the scene updates its hierarchy in one pass
+    void UpdateMatrix();
 
-    Mat4 GetWorldMatrix() const;
+    const Mat4& GetWorldMatrix() const;
+    // World matrix blended between the last two scene updates, what should be drawn
+    const Mat4& GetRenderMatrix() const;
+    // The next move is drawn at once instead of blended from the previous position
+    void SkipInterpolation();
     Mat4 GetLocalMatrix() const;
 
     Vec3f GetForward() const;
@@ -28,43 +34,64 @@ class TransformComponent : public IComponent
     Vec3f GetUp() const;
 
     void SetLocalPosition(const Vec3f& position);
-    Vec3f GetLocalPosition() const { return m_localPosition; }
+    Vec3f GetLocalPosition() const { return Local().position; }
     
     void SetWorldPosition(const Vec3f& position);
     Vec3f GetWorldPosition() const;
     
     void SetLocalRotation(const Quat& rotation);
-    Quat GetLocalRotation() const { return m_localRotation; }
+    Quat GetLocalRotation() const { return Local().rotation; }
     
     void SetWorldRotation(const Quat& rotation);
     Quat GetWorldRotation() const;
     
     void SetLocalScale(const Vec3f& scale);
-    Vec3f GetLocalScale() const { return m_localScale; }
+    Vec3f GetLocalScale() const { return Local().scale; }
     
     void SetWorldScale(const Vec3f& scale);
     Vec3f GetWorldScale() const;
+    // World position, rotation and scale at once, without walking the parents
+    TransformWorld GetWorld() const;
     
     void Rotate(const Vec3f& axis, const float angle, Space relativeTo = Space::Local);
     void RotateAround(const Vec3f point, const Vec3f axis, const float angle);
     void RotateAround(const Vec3f axis, const float angle);
     Vec3f TransformDirection(Vec3f dir) const;
+
+    TransformComponent* GetParentTransform() const;
+    std::vector<TransformComponent*> GetChildTransforms() const;
+    bool HasChildren() const { return m_hierarchy && m_hierarchy->GetSubtreeSize(m_hierarchyIndex) > 1; }
+    // Position in the scene hierarchy, TransformHierarchy::InvalidIndex when detached
+    uint32_t GetHierarchyIndex() const { return m_hierarchyIndex; }
+
+    // Grows every time the world matrix or the world bounds change
+    uint64_t GetChangeVersion() const { return m_hierarchy ? m_hierarchy->GetVersion(m_hierarchyIndex) : m_version; }
+    // Local bounds of what the object renders, the world box follows the transform. Scene transforms only.
+    // An object rendering something without bounds is never culled.
+    void SetLocalBounds(const BoundingBox& bounds, bool alwaysVisible = false);
+    BoundingBox GetWorldBounds() const { return m_hierarchy ? m_hierarchy->GetWorldBounds(m_hierarchyIndex) : BoundingBox(); }
     
 public:
     Event<> EOnUpdateModelMatrix;
 private:
-    void SetDirty() { m_dirty = true; }
-    
-    void UpdateMatrix(bool force = false);
-    void ComputeModelMatrix(const Mat4& parentMatrix);
-    void ComputeModelMatrix();
-    void UpdateModelMatrix(const Mat4& matrix);
+    friend TransformHierarchy;
+    friend Scene;
+
+    // Stored in the scene hierarchy once attached, in the component otherwise
+    TransformLocal& Local() { return m_hierarchy ? m_hierarchy->GetLocal(m_hierarchyIndex) : m_local; }
+    const TransformLocal& Local() const { return m_hierarchy ? m_hierarchy->GetLocal(m_hierarchyIndex) : m_local; }
+    void SetDirty();
 private:
+    TransformHierarchy* m_hierarchy = nullptr;
+    uint32_t m_hierarchyIndex = TransformHierarchy::InvalidIndex;
+
+    TransformLocal m_local;
     Mat4 m_modelMatrix;
-    
-    Vec3f m_localPosition = Vec3f::Zero();
-    Quat m_localRotation = Quat::Identity();
-    Vec3f m_localScale = Vec3f::One();
-    
+    uint64_t m_version = 0;
+    // Leaf of the scene BVH holding the world bounds
+    uint32_t m_cullingProxy = TransformHierarchy::InvalidIndex;
+    // Position in the scene list of the objects never culled
+    uint32_t m_alwaysVisibleSlot = TransformHierarchy::InvalidIndex;
+    bool m_alwaysVisible = false;
     bool m_dirty = true;
 };
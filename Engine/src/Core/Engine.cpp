@@ -5,7 +5,7 @@
 
 #include "Debug/Log.h"
 
-#include "Render/Vulkan/VulkanRenderer.h"
+#include "Render/IRenderer.h"
 
 #include "Resource/Mesh.h"
 #include "Resource/Model.h"
@@ -30,14 +30,17 @@ Engine* Engine::Create()
 bool Engine::Initialize(EngineDesc desc)
 {
     m_window = desc.window;
-    if (!m_window)
+    m_timestep = FixedTimestep(desc.timestep);
+    m_firstFrame = true;
+    if (!m_window && desc.renderAPI != RenderAPI::Null)
     {
         PrintError("No window provided");
         return false;
     }
 
-    m_renderer = std::make_unique<VulkanRenderer>();
-    m_renderer->Initialize(m_window);
+    m_renderer = IRenderer::Create(desc.renderAPI);
+    if (m_renderer)
+        m_renderer->Initialize(m_window);
     
     if (!m_renderer || !m_renderer->IsInitialized())
     {
@@ -78,12 +81,17 @@ bool Engine::BeginFrame()
 
 void Engine::Update()
 {
-    static auto lastTime = std::chrono::high_resolution_clock::now();
-    auto currentTime = std::chrono::high_resolution_clock::now();
-    m_deltaTime = std::chrono::duration<float>(currentTime - lastTime).count();
-    lastTime = currentTime;
-    
-    m_sceneHolder->Update(m_deltaTime);
+    const auto currentTime = std::chrono::steady_clock::now();
+    m_deltaTime = m_firstFrame ? 0.0f : std::chrono::duration<float>(currentTime - m_lastFrameTime).count();
+    m_lastFrameTime = currentTime;
+    m_firstFrame = false;
+
+    // Simulation at a fixed rate, capped so a slow frame does not ask for more steps the next one
+    const uint32_t steps = m_timestep.Advance(m_deltaTime);
+    for (uint32_t i = 0; i < steps; i++)
+        m_sceneHolder->Update(static_cast<float>(m_timestep.GetStep()));
+    // Camera, interpolation and culling follow the frame rate, even on frames without a step
+    m_sceneHolder->UpdateView(m_deltaTime, m_timestep.GetAlpha());
 }
 
 void Engine::Render()
@@ -124,7 +132,8 @@ void Engine::Cleanup()
     
     ThreadPool::Terminate();
 
-    m_window->Terminate();
+    if (m_window)
+        m_window->Terminate();
 }
 
 Engine* Engine::Get()
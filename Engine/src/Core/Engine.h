@@ -1,16 +1,22 @@
 ﻿#pragma once
 #include "EngineAPI.h"
+#include <chrono>
 #include <memory>
 
+#include "Core/FixedTimestep.h"
 #include "Core/Window.h"
 #include "Resource/ResourceManager.h"
-#include "Render/Vulkan/VulkanRenderer.h"
+#include "Render/IRenderer.h"
 #include "Scene/ComponentHandler.h"
 #include "Scene/SceneHolder.h"
 
 struct ENGINE_API EngineDesc
 {
-    Window* window;
+    // Can be null with the null render API
+    Window* window = nullptr;
+    RenderAPI renderAPI = RenderAPI::Vulkan;
+    // The scene is updated at a fixed rate, rendering blends between the last two updates
+    TimestepSettings timestep;
 };
 
 class ENGINE_API Engine
@@ -29,17 +35,24 @@ class ENGINE_API Engine
     static Engine* Get();
 
     Window* GetWindow() const { return m_window; }
-    VulkanRenderer* GetRenderer() const { return m_renderer.get(); }
+    IRenderer* GetRenderer() const { return m_renderer.get(); }
     SceneHolder* GetSceneHolder() const { return m_sceneHolder.get(); }
     ResourceManager* GetResourceManager() const { return m_resourceManager.get(); }
+    ComponentRegister* GetComponentRegister() const { return m_componentRegister.get(); }
+    const FixedTimestep& GetTimestep() const { return m_timestep; }
+    // Wall time of the last frame, in seconds
+    float GetDeltaTime() const { return m_deltaTime; }
 private:
     Window* m_window;
-    std::unique_ptr<VulkanRenderer> m_renderer;
+    std::unique_ptr<IRenderer> m_renderer;
     std::unique_ptr<ResourceManager> m_resourceManager;
     std::unique_ptr<ComponentRegister> m_componentRegister;
     std::unique_ptr<SceneHolder> m_sceneHolder;
     
     inline static std::unique_ptr<Engine> s_instance = nullptr;
     
+    FixedTimestep m_timestep;
+    std::chrono::steady_clock::time_point m_lastFrameTime;
+    bool m_firstFrame = true;
     float m_deltaTime = 0.0f;
 };
@@ -0,0 +1,33 @@
+#include "FixedTimestep.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Debug/Log.h"
+
+FixedTimestep::FixedTimestep(const TimestepSettings& settings)
+    : m_settings(settings)
+{
+    if (m_settings.step <= 0.0)
+    {
+        PrintWarning("Invalid fixed timestep %f, using 1/60", m_settings.step);
+        m_settings.step = 1.0 / 60.0;
+    }
+    m_settings.maxStepsPerFrame = std::max<uint32_t>(m_settings.maxStepsPerFrame, 1);
+    m_accumulator = m_settings.step;
+}
+
+uint32_t FixedTimestep::Advance(double frameTime)
+{
+    m_accumulator += std::max(frameTime, 0.0);
+
+    const double available = std::floor(m_accumulator / m_settings.step);
+    const uint32_t steps = available > m_settings.maxStepsPerFrame ? m_settings.maxStepsPerFrame : static_cast<uint32_t>(available);
+    // Catching up would make the next frame even longer, the simulation slows down instead
+    m_droppedTime += (available - steps) * m_settings.step;
+    // Rounding can leave the remainder a hair outside [0, step)
+    m_accumulator = std::clamp(m_accumulator - available * m_settings.step, 0.0, std::nextafter(m_settings.step, 0.0));
+
+    m_stepCount += steps;
+    return steps;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+
+struct TimestepSettings
+{
+    // Simulated time per step, in seconds
+    double step = 1.0 / 60.0;
+    // Steps run by one Advance at most, the time past it is dropped
+    uint32_t maxStepsPerFrame = 5;
+};
+
+// Splits the variable frame time in fixed simulation steps. The time left after the last step
+// gives the render alpha, how far the frame is between the last two simulation states.
+class FixedTimestep
+{
+public:
+    explicit FixedTimestep(const TimestepSettings& settings = {});
+
+    // Adds the frame time, in seconds, and returns the number of steps to run now.
+    // The first call always returns at least one step so there is a state to render.
+    uint32_t Advance(double frameTime);
+
+    double GetStep() const { return m_settings.step; }
+    // In [0, 1): 0 renders the last simulation state, values near 1 the next one
+    float GetAlpha() const { return static_cast<float>(m_accumulator / m_settings.step); }
+    uint64_t GetStepCount() const { return m_stepCount; }
+    // Time dropped when a frame needed more than maxStepsPerFrame steps, in seconds
+    double GetDroppedTime() const { return m_droppedTime; }
+
+    const TimestepSettings& GetSettings() const { return m_settings; }
+
+private:
+    TimestepSettings m_settings;
+    double m_accumulator = 0.0;
+    double m_droppedTime = 0.0;
+    uint64_t m_stepCount = 0;
+};
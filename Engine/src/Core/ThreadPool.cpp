@@ -17,6 +17,13 @@ void ThreadPool::Initialize()
     }
 }
 
+size_t ThreadPool::GetThreadCount()
+{
+    if (!s_instance || !s_instance->m_threadPool)
+        return 0;
+    return s_instance->m_threadPool->get_thread_count();
+}
+
 void ThreadPool::WaitUntilAllTasksFinished()
 {
     s_instance->m_threadPool->wait();
@@ -1,6 +1,9 @@
 ﻿#pragma once
+#include <algorithm>
+#include <exception>
 #include <memory>
 #include <future>
+#include <vector>
 
 #include <BS_thread_pool.hpp>
 
@@ -20,6 +23,7 @@ class ThreadPool
     static void Terminate();
     
     static bool IsMainThread() { return std::this_thread::get_id() == s_instance->m_mainThreadID; }
+    static size_t GetThreadCount();
 
     template <typename F, typename R = std::invoke_result_t<std::decay_t<F>>>
     static std::future<R> Enqueue(F&& task)
@@ -40,6 +44,57 @@ class ThreadPool
 #endif
     }
 
+    // Split [0, count) in blocks of at least minBlockSize and run body(begin, end) on the pool.
+    // The calling thread takes the first block and returns once every block is done.
+    // An exception from a block is rethrown after that, the first one if several threw.
+    // Runs inline when called off the main thread, to never wait on the pool from inside it.
+    template <typename F>
+    static void ParallelFor(size_t count, F&& body, size_t minBlockSize = 1)
+    {
+        if (count == 0)
+            return;
+#ifdef MULTI_THREAD
+        const size_t blockCount = std::clamp<size_t>(count / std::max<size_t>(minBlockSize, 1), 1, GetThreadCount() + 1);
+        if (blockCount > 1 && IsMainThread())
+        {
+            const size_t blockSize = (count + blockCount - 1) / blockCount;
+            std::vector<std::future<void>> futures;
+            futures.reserve(blockCount - 1);
+            for (size_t begin = blockSize; begin < count; begin += blockSize)
+            {
+                const size_t end = std::min(begin + blockSize, count);
+                futures.push_back(s_instance->m_threadPool->submit_task([&body, begin, end]() { body(begin, end); }));
+            }
+            // Every task refers to body, so all of them must finish before leaving, even when one throws
+            std::exception_ptr exception;
+            try
+            {
+                body(0, blockSize);
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+            for (std::future<void>& future : futures)
+            {
+                try
+                {
+                    future.get();
+                }
+                catch (...)
+                {
+                    if (!exception)
+                        exception = std::current_exception();
+                }
+            }
+            if (exception)
+                std::rethrow_exception(exception);
+            return;
+        }
+#endif
+        body(0, count);
+    }
+
 private:
     static std::unique_ptr<ThreadPool> s_instance;
     std::unique_ptr<BS::thread_pool<>> m_threadPool;
@@ -22,11 +22,42 @@ Vec3f BoundingBox::GetExtents() const
     return max - GetCenter();
 }
 
+BoundingBox BoundingBox::Transform(const Mat4& matrix) const
+{
+    BoundingBox result;
+    for (int i = 0; i < 8; i++)
+    {
+        Vec3f corner;
+        corner.x = (i & 0x1) ? max.x : min.x;
+        corner.y = (i & 0x2) ? max.y : min.y;
+        corner.z = (i & 0x4) ? max.z : min.z;
+        corner = matrix * corner;
+
+        for (int j = 0; j < 3; j++)
+        {
+            result.min[j] = fminf(result.min[j], corner[j]);
+            result.max[j] = fmaxf(result.max[j], corner[j]);
+        }
+    }
+    return result;
+}
+
+bool BoundingBox::IsOnFrustum(const Frustum& frustum) const
+{
+    for (const auto& plane : frustum.planes)
+    {
+        if (!isOnOrForwardPlane(plane))
+            return false;
+    }
+    return true;
+}
+
 bool BoundingBox::IsOnFrustum(const Frustum& frustum, const TransformComponent* objectTransform) const
 {
-    Vec3f position = objectTransform->GetWorldPosition();
-    Quat rotation = objectTransform->GetWorldRotation();
-    Vec3f scale = objectTransform->GetWorldScale();
+    const TransformWorld world = objectTransform->GetWorld();
+    const Vec3f& position = world.position;
+    const Quat& rotation = world.rotation;
+    const Vec3f& scale = world.scale;
 
     Vec3f localCenter = (min + max) * 0.5f;
     Vec3f localExtents = (max - min) * 0.5f;
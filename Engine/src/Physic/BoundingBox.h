@@ -20,7 +20,14 @@ struct BoundingBox
 
     Vec3f GetCenter() const;
     Vec3f GetExtents() const;
+    // False for the default, empty box
+    bool IsValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+    // Box around the 8 transformed corners
+    BoundingBox Transform(const Mat4& matrix) const;
 
     bool IsOnFrustum(const Frustum& frustum, const TransformComponent* objectTransform) const;
+    // For a box already in world space
+    bool IsOnFrustum(const Frustum& frustum) const;
     bool isOnOrForwardPlane(const Plane& plane) const;
 };
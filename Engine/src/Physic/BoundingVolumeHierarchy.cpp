@@ -0,0 +1,515 @@
+﻿#include "BoundingVolumeHierarchy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "Plane.h"
+#include "Core/ThreadPool.h"
+#include "Utils/BatchMath.h"
+
+namespace
+{
+    BoundingBox Union(const BoundingBox& a, const BoundingBox& b)
+    {
+        return BoundingBox(
+            Vec3f(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z)),
+            Vec3f(std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z)));
+    }
+
+    float Area(const BoundingBox& box)
+    {
+        const Vec3f size = box.max - box.min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    // Small trees built by insertion are good enough
+    constexpr size_t MinRebuildProxyCount = 256;
+}
+
+BoundingVolumeHierarchy::~BoundingVolumeHierarchy()
+{
+    if (m_pendingBuild.valid())
+        m_pendingBuild.wait();
+}
+
+uint32_t BoundingVolumeHierarchy::CreateProxy(const BoundingBox& bounds, void* userData)
+{
+    uint32_t proxy = m_freeProxy;
+    if (proxy != InvalidIndex)
+    {
+        m_freeProxy = m_proxies[proxy].node;
+    }
+    else
+    {
+        proxy = static_cast<uint32_t>(m_proxies.size());
+        m_proxies.emplace_back();
+    }
+
+    const uint32_t leaf = AllocateNode();
+    m_nodes[leaf].bounds = bounds;
+    m_nodes[leaf].proxy = proxy;
+    m_proxies[proxy] = { bounds, userData, leaf };
+    if (m_batching)
+        m_batchLeaves.push_back(leaf);
+    else
+        InsertLeaf(leaf);
+    SetFlatBounds(proxy, bounds);
+
+    m_proxyCount++;
+    m_changesSinceCheck++;
+    m_changedDuringBuild |= m_pendingBuild.valid();
+    return proxy;
+}
+
+void BoundingVolumeHierarchy::DestroyProxy(uint32_t proxy)
+{
+    const uint32_t leaf = m_proxies[proxy].node;
+    const auto pending = std::find(m_batchLeaves.begin(), m_batchLeaves.end(), leaf);
+    if (pending != m_batchLeaves.end())
+        m_batchLeaves.erase(pending);
+    else
+        RemoveLeaf(leaf);
+    FreeNode(leaf);
+
+    m_proxies[proxy] = { BoundingBox(), nullptr, m_freeProxy };
+    m_freeProxy = proxy;
+    ClearFlatBounds(proxy);
+
+    m_proxyCount--;
+    m_changesSinceCheck++;
+    m_changedDuringBuild |= m_pendingBuild.valid();
+}
+
+void BoundingVolumeHierarchy::MoveProxy(uint32_t proxy, const BoundingBox& bounds)
+{
+    m_proxies[proxy].bounds = bounds;
+    const uint32_t leaf = m_proxies[proxy].node;
+    m_nodes[leaf].bounds = bounds;
+    Refit(m_nodes[leaf].parent);
+    SetFlatBounds(proxy, bounds);
+
+    m_changesSinceCheck++;
+    if (m_pendingBuild.valid())
+        m_movedDuringBuild.push_back(proxy);
+}
+
+void BoundingVolumeHierarchy::BeginBatch()
+{
+    m_batching = true;
+}
+
+void BoundingVolumeHierarchy::EndBatch()
+{
+    m_batching = false;
+    if (m_batchLeaves.empty())
+        return;
+
+    if (m_batchLeaves.size() >= std::max(MinRebuildProxyCount, m_proxyCount / 4))
+    {
+        // Reads every proxy, the pending leaves included
+        Rebuild();
+    }
+    else
+    {
+        for (uint32_t leaf : m_batchLeaves)
+            InsertLeaf(leaf);
+    }
+    m_batchLeaves.clear();
+}
+
+void BoundingVolumeHierarchy::Maintain()
+{
+    if (m_pendingBuild.valid())
+    {
+        if (m_pendingBuild.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return;
+
+        BuildResult result = m_pendingBuild.get();
+        if (!m_changedDuringBuild)
+        {
+            Install(std::move(result));
+            for (uint32_t proxy : m_movedDuringBuild)
+                MoveProxy(proxy, m_proxies[proxy].bounds);
+        }
+        m_movedDuringBuild.clear();
+        m_changedDuringBuild = false;
+        return;
+    }
+
+    // The cost check walks the whole tree, only done once enough leaves changed
+    if (m_proxyCount < MinRebuildProxyCount || m_changesSinceCheck < std::max<size_t>(64, m_proxyCount / 16))
+        return;
+    m_changesSinceCheck = 0;
+    if (ComputeCost() <= m_builtCost * RebuildThreshold)
+        return;
+
+#ifdef MULTI_THREAD
+    if (ThreadPool::GetThreadCount() > 0)
+    {
+        m_pendingBuild = ThreadPool::Enqueue([input = GetBuildInput()]() mutable
+        {
+            return Build(std::move(input));
+        });
+        return;
+    }
+#endif
+    Rebuild();
+}
+
+void BoundingVolumeHierarchy::Rebuild()
+{
+    Install(Build(GetBuildInput()));
+}
+
+void BoundingVolumeHierarchy::Cull(const Frustum& frustum, std::vector<uint32_t>& proxies)
+{
+    const size_t begin = proxies.size();
+    if (m_proxyCount >= FlatCullMinProxyCount && m_lastVisibleCount >= m_proxyCount * FlatCullVisibleRatio)
+        CullFlat(frustum, proxies);
+    else
+        CullTree(frustum, proxies);
+    m_lastVisibleCount = proxies.size() - begin;
+}
+
+void BoundingVolumeHierarchy::CullTree(const Frustum& frustum, std::vector<uint32_t>& proxies) const
+{
+    if (m_root == InvalidIndex)
+        return;
+
+    // One bit per plane the node may still cross, cleared once a parent is fully in front of it
+    struct Entry
+    {
+        uint32_t node;
+        uint32_t planeMask;
+    };
+    std::vector<Entry> stack;
+    stack.reserve(64);
+    stack.push_back({ m_root, 0x3F });
+
+    while (!stack.empty())
+    {
+        const Entry entry = stack.back();
+        stack.pop_back();
+        const Node& node = m_nodes[entry.node];
+
+        uint32_t planeMask = entry.planeMask;
+        bool outside = false;
+        if (planeMask != 0)
+        {
+            const Vec3f center = node.bounds.GetCenter();
+            const Vec3f extents = node.bounds.GetExtents();
+            for (uint32_t i = 0; i < 6; i++)
+            {
+                if (!(planeMask & (1u << i)))
+                    continue;
+
+                const Plane& plane = frustum.planes[i];
+                const float r = extents.x * std::abs(plane.normal.x) + extents.y * std::abs(plane.normal.y) + extents.z * std::abs(plane.normal.z);
+                const float distance = plane.GetDistanceToPlane(center);
+                if (distance < -r)
+                {
+                    outside = true;
+                    break;
+                }
+                if (distance >= r)
+                    planeMask &= ~(1u << i);
+            }
+        }
+        if (outside)
+            continue;
+
+        if (node.IsLeaf())
+        {
+            proxies.push_back(node.proxy);
+            continue;
+        }
+        stack.push_back({ node.right, planeMask });
+        stack.push_back({ node.left, planeMask });
+    }
+}
+
+void BoundingVolumeHierarchy::CullFlat(const Frustum& frustum, std::vector<uint32_t>& proxies)
+{
+    const size_t blockCount = m_flat.lastPlanes.size();
+    if (blockCount == 0)
+        return;
+
+    const BatchMath::CullingBounds bounds = {
+        m_flat.centerX.data(), m_flat.centerY.data(), m_flat.centerZ.data(),
+        m_flat.extentX.data(), m_flat.extentY.data(), m_flat.extentZ.data(),
+        m_flat.radius.data(), m_flat.lastPlanes.data()
+    };
+    m_flat.visible.resize(blockCount * BatchMath::CullBlockSize);
+    uint8_t* visible = m_flat.visible.data();
+    ThreadPool::ParallelFor(blockCount, [&](size_t begin, size_t end)
+    {
+        BatchMath::CullBounds(bounds, frustum, visible, begin, end);
+    }, 1024);
+
+    // Free and padding slots have NaN centers and are never visible, blocks with nothing visible are skipped whole
+    for (size_t block = 0; block < blockCount; block++)
+    {
+        const uint8_t* blockVisible = visible + block * BatchMath::CullBlockSize;
+        uint64_t anyVisible;
+        std::memcpy(&anyVisible, blockVisible, sizeof(anyVisible));
+        if (anyVisible == 0)
+            continue;
+
+        for (size_t lane = 0; lane < BatchMath::CullBlockSize; lane++)
+        {
+            if (blockVisible[lane])
+                proxies.push_back(static_cast<uint32_t>(block * BatchMath::CullBlockSize + lane));
+        }
+    }
+}
+
+float BoundingVolumeHierarchy::ComputeCost() const
+{
+    if (m_root == InvalidIndex || m_nodes[m_root].IsLeaf())
+        return 0.0f;
+
+    float internalArea = 0.0f;
+    std::vector<uint32_t> stack = { m_root };
+    while (!stack.empty())
+    {
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+        if (node.IsLeaf())
+            continue;
+
+        internalArea += Area(node.bounds);
+        stack.push_back(node.left);
+        stack.push_back(node.right);
+    }
+
+    const float rootArea = Area(m_nodes[m_root].bounds);
+    return rootArea > 0.0f ? internalArea / rootArea : 0.0f;
+}
+
+uint32_t BoundingVolumeHierarchy::AllocateNode()
+{
+    if (!m_freeNodes.empty())
+    {
+        const uint32_t index = m_freeNodes.back();
+        m_freeNodes.pop_back();
+        m_nodes[index] = Node();
+        return index;
+    }
+    m_nodes.emplace_back();
+    return static_cast<uint32_t>(m_nodes.size() - 1);
+}
+
+void BoundingVolumeHierarchy::FreeNode(uint32_t index)
+{
+    m_freeNodes.push_back(index);
+}
+
+// Walks down to the sibling that grows the tree surface the least, like Box2D
+void BoundingVolumeHierarchy::InsertLeaf(uint32_t leaf)
+{
+    if (m_root == InvalidIndex)
+    {
+        m_root = leaf;
+        m_nodes[leaf].parent = InvalidIndex;
+        return;
+    }
+
+    const BoundingBox bounds = m_nodes[leaf].bounds;
+    uint32_t index = m_root;
+    while (!m_nodes[index].IsLeaf())
+    {
+        const Node& node = m_nodes[index];
+        const float area = Area(node.bounds);
+        const float combinedArea = Area(Union(node.bounds, bounds));
+
+        // Cost of a new parent here, and the cost pushed down to the children
+        const float cost = 2.0f * combinedArea;
+        const float inheritance = 2.0f * (combinedArea - area);
+
+        auto childCost = [&](uint32_t child)
+        {
+            const Node& childNode = m_nodes[child];
+            const float childArea = Area(Union(bounds, childNode.bounds));
+            return childNode.IsLeaf() ? childArea + inheritance : childArea - Area(childNode.bounds) + inheritance;
+        };
+        const float leftCost = childCost(node.left);
+        const float rightCost = childCost(node.right);
+
+        if (cost < leftCost && cost < rightCost)
+            break;
+        index = leftCost < rightCost ? node.left : node.right;
+    }
+
+    const uint32_t sibling = index;
+    const uint32_t oldParent = m_nodes[sibling].parent;
+    const uint32_t newParent = AllocateNode();
+    m_nodes[newParent].parent = oldParent;
+    m_nodes[newParent].bounds = Union(bounds, m_nodes[sibling].bounds);
+    m_nodes[newParent].left = sibling;
+    m_nodes[newParent].right = leaf;
+    m_nodes[sibling].parent = newParent;
+    m_nodes[leaf].parent = newParent;
+
+    if (oldParent == InvalidIndex)
+    {
+        m_root = newParent;
+        return;
+    }
+
+    if (m_nodes[oldParent].left == sibling)
+        m_nodes[oldParent].left = newParent;
+    else
+        m_nodes[oldParent].right = newParent;
+    Refit(oldParent);
+}
+
+void BoundingVolumeHierarchy::RemoveLeaf(uint32_t leaf)
+{
+    if (leaf == m_root)
+    {
+        m_root = InvalidIndex;
+        return;
+    }
+
+    const uint32_t parent = m_nodes[leaf].parent;
+    const uint32_t grandParent = m_nodes[parent].parent;
+    const uint32_t sibling = m_nodes[parent].left == leaf ? m_nodes[parent].right : m_nodes[parent].left;
+
+    // The sibling takes the place of the parent
+    m_nodes[sibling].parent = grandParent;
+    FreeNode(parent);
+    if (grandParent == InvalidIndex)
+    {
+        m_root = sibling;
+        return;
+    }
+
+    if (m_nodes[grandParent].left == parent)
+        m_nodes[grandParent].left = sibling;
+    else
+        m_nodes[grandParent].right = sibling;
+    Refit(grandParent);
+}
+
+void BoundingVolumeHierarchy::Refit(uint32_t index)
+{
+    while (index != InvalidIndex)
+    {
+        Node& node = m_nodes[index];
+        node.bounds = Union(m_nodes[node.left].bounds, m_nodes[node.right].bounds);
+        index = node.parent;
+    }
+}
+
+void BoundingVolumeHierarchy::SetFlatBounds(uint32_t proxy, const BoundingBox& bounds)
+{
+    if (proxy >= m_flat.centerX.size())
+    {
+        const size_t blockCount = proxy / BatchMath::CullBlockSize + 1;
+        const size_t size = blockCount * BatchMath::CullBlockSize;
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        for (std::vector<float>* values : { &m_flat.centerX, &m_flat.centerY, &m_flat.centerZ })
+            values->resize(size, nan);
+        for (std::vector<float>* values : { &m_flat.extentX, &m_flat.extentY, &m_flat.extentZ, &m_flat.radius })
+            values->resize(size, 0.0f);
+        m_flat.lastPlanes.resize(blockCount, 0);
+    }
+
+    const Vec3f center = bounds.GetCenter();
+    const Vec3f extents = bounds.GetExtents();
+    m_flat.centerX[proxy] = center.x;
+    m_flat.centerY[proxy] = center.y;
+    m_flat.centerZ[proxy] = center.z;
+    m_flat.extentX[proxy] = extents.x;
+    m_flat.extentY[proxy] = extents.y;
+    m_flat.extentZ[proxy] = extents.z;
+    m_flat.radius[proxy] = std::sqrt(extents.x * extents.x + extents.y * extents.y + extents.z * extents.z);
+}
+
+void BoundingVolumeHierarchy::ClearFlatBounds(uint32_t proxy)
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    m_flat.centerX[proxy] = nan;
+    m_flat.centerY[proxy] = nan;
+    m_flat.centerZ[proxy] = nan;
+}
+
+std::vector<BoundingVolumeHierarchy::BuildInput> BoundingVolumeHierarchy::GetBuildInput() const
+{
+    std::vector<BuildInput> input;
+    input.reserve(m_proxyCount);
+    for (uint32_t proxy = 0; proxy < m_proxies.size(); proxy++)
+    {
+        const Proxy& entry = m_proxies[proxy];
+        if (entry.userData)
+            input.push_back({ entry.bounds, proxy });
+    }
+    return input;
+}
+
+void BoundingVolumeHierarchy::Install(BuildResult&& result)
+{
+    m_nodes = std::move(result.nodes);
+    m_freeNodes.clear();
+    m_root = result.root;
+    for (uint32_t i = 0; i < m_nodes.size(); i++)
+    {
+        if (m_nodes[i].IsLeaf())
+            m_proxies[m_nodes[i].proxy].node = i;
+    }
+
+    m_builtCost = ComputeCost();
+    m_changesSinceCheck = 0;
+}
+
+BoundingVolumeHierarchy::BuildResult BoundingVolumeHierarchy::Build(std::vector<BuildInput> input)
+{
+    BuildResult result;
+    if (input.empty())
+        return result;
+
+    result.nodes.reserve(2 * input.size() - 1);
+    result.root = BuildRange(result, input.data(), input.data() + input.size(), InvalidIndex);
+    return result;
+}
+
+// Top down, split at the median of the centers along the longest axis of the centers
+uint32_t BoundingVolumeHierarchy::BuildRange(BuildResult& result, BuildInput* begin, BuildInput* end, uint32_t parent)
+{
+    const uint32_t index = static_cast<uint32_t>(result.nodes.size());
+    result.nodes.emplace_back();
+    result.nodes[index].parent = parent;
+
+    if (end - begin == 1)
+    {
+        result.nodes[index].bounds = begin->bounds;
+        result.nodes[index].proxy = begin->proxy;
+        return index;
+    }
+
+    BoundingBox centers;
+    for (const BuildInput* it = begin; it != end; it++)
+    {
+        const Vec3f center = it->bounds.GetCenter();
+        centers = Union(centers, BoundingBox(center, center));
+    }
+    const Vec3f size = centers.max - centers.min;
+    const int axis = size.x >= size.y && size.x >= size.z ? 0 : (size.y >= size.z ? 1 : 2);
+
+    BuildInput* middle = begin + (end - begin) / 2;
+    std::nth_element(begin, middle, end, [axis](const BuildInput& a, const BuildInput& b)
+    {
+        return a.bounds.min[axis] + a.bounds.max[axis] < b.bounds.min[axis] + b.bounds.max[axis];
+    });
+
+    const uint32_t left = BuildRange(result, begin, middle, index);
+    const uint32_t right = BuildRange(result, middle, end, index);
+    Node& node = result.nodes[index];
+    node.left = left;
+    node.right = right;
+    node.bounds = Union(result.nodes[left].bounds, result.nodes[right].bounds);
+    return index;
+}
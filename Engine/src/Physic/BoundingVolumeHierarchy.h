@@ -0,0 +1,137 @@
+#pragma once
+#include <cstdint>
+#include <future>
+#include <vector>
+
+#include "BoundingBox.h"
+
+// Dynamic AABB tree over world boxes. A proxy is one leaf: its box is refit in place when it moves, and the
+// whole tree is rebuilt on the thread pool once the refits made it clearly worse than a fresh build.
+// Not thread safe, used from the main thread.
+class BoundingVolumeHierarchy
+{
+public:
+    static constexpr uint32_t InvalidIndex = UINT32_MAX;
+    // Rebuilt when the cost grows past this factor of the cost of the last build
+    static constexpr float RebuildThreshold = 1.5f;
+    // Above this share of visible proxies, testing every box beats walking the tree
+    static constexpr float FlatCullVisibleRatio = 0.25f;
+    static constexpr size_t FlatCullMinProxyCount = 1024;
+
+    BoundingVolumeHierarchy() = default;
+    BoundingVolumeHierarchy(const BoundingVolumeHierarchy&) = delete;
+    BoundingVolumeHierarchy& operator=(const BoundingVolumeHierarchy&) = delete;
+    ~BoundingVolumeHierarchy();
+
+    // userData must not be null
+    uint32_t CreateProxy(const BoundingBox& bounds, void* userData);
+    void DestroyProxy(uint32_t proxy);
+    // Refits the leaf and its ancestors
+    void MoveProxy(uint32_t proxy, const BoundingBox& bounds);
+
+    // Proxies created until EndBatch are inserted together, by a full rebuild when they are many.
+    // One by one insertion of many equal boxes, like fresh instances, builds a chain.
+    void BeginBatch();
+    void EndBatch();
+
+    void* GetUserData(uint32_t proxy) const { return m_proxies[proxy].userData; }
+    const BoundingBox& GetBounds(uint32_t proxy) const { return m_proxies[proxy].bounds; }
+    size_t GetProxyCount() const { return m_proxyCount; }
+
+    // Once per frame: installs a finished rebuild, starts one when the quality dropped
+    void Maintain();
+    // Builds a fresh tree now, on the calling thread
+    void Rebuild();
+
+    // Appends every proxy whose box touches the frustum, with the tree or the flat pass depending on
+    // how much of the scene was visible last time
+    void Cull(const Frustum& frustum, std::vector<uint32_t>& proxies);
+    // Walks the tree, subtrees fully inside are added without more tests
+    void CullTree(const Frustum& frustum, std::vector<uint32_t>& proxies) const;
+    // Tests every box with the SIMD kernel, split over the thread pool
+    void CullFlat(const Frustum& frustum, std::vector<uint32_t>& proxies);
+
+    // Surface area of the internal nodes relative to the root, lower is better
+    float ComputeCost() const;
+
+private:
+    struct Node
+    {
+        BoundingBox bounds;
+        uint32_t parent = InvalidIndex;
+        uint32_t left = InvalidIndex;
+        uint32_t right = InvalidIndex;
+        // Leaves only
+        uint32_t proxy = InvalidIndex;
+
+        bool IsLeaf() const { return left == InvalidIndex; }
+    };
+
+    struct Proxy
+    {
+        BoundingBox bounds;
+        void* userData = nullptr;
+        // Next free proxy when unused
+        uint32_t node = InvalidIndex;
+    };
+
+    struct BuildInput
+    {
+        BoundingBox bounds;
+        uint32_t proxy;
+    };
+
+    struct BuildResult
+    {
+        std::vector<Node> nodes;
+        uint32_t root = InvalidIndex;
+    };
+
+    // Boxes by proxy index for the flat pass, padded to whole blocks with NaN centers
+    struct FlatBounds
+    {
+        std::vector<float> centerX, centerY, centerZ;
+        std::vector<float> extentX, extentY, extentZ;
+        std::vector<float> radius;
+        std::vector<uint8_t> lastPlanes;
+        std::vector<uint8_t> visible;
+    };
+
+    uint32_t AllocateNode();
+    void FreeNode(uint32_t index);
+    void InsertLeaf(uint32_t leaf);
+    void RemoveLeaf(uint32_t leaf);
+    void Refit(uint32_t index);
+    void SetFlatBounds(uint32_t proxy, const BoundingBox& bounds);
+    void ClearFlatBounds(uint32_t proxy);
+
+    std::vector<BuildInput> GetBuildInput() const;
+    void Install(BuildResult&& result);
+    static BuildResult Build(std::vector<BuildInput> input);
+    static uint32_t BuildRange(BuildResult& result, BuildInput* begin, BuildInput* end, uint32_t parent);
+
+private:
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_freeNodes;
+    uint32_t m_root = InvalidIndex;
+
+    std::vector<Proxy> m_proxies;
+    uint32_t m_freeProxy = InvalidIndex;
+    size_t m_proxyCount = 0;
+
+    FlatBounds m_flat;
+    size_t m_lastVisibleCount = 0;
+
+    float m_builtCost = 0.0f;
+    size_t m_changesSinceCheck = 0;
+
+    // Background rebuild from a copy of the leaves. Moves made meanwhile are replayed on the result,
+    // which is dropped if proxies were created or destroyed.
+    std::future<BuildResult> m_pendingBuild;
+    std::vector<uint32_t> m_movedDuringBuild;
+    bool m_changedDuringBuild = false;
+
+    bool m_batching = false;
+    // Leaves created during the batch, not in the tree yet
+    std::vector<uint32_t> m_batchLeaves;
+};
@@ -0,0 +1,160 @@
+#include "IRenderer.h"
+
+#include <optional>
+#include <ranges>
+#include <spirv_reflect.h>
+#include <shaderc/shaderc.hpp>
+
+#include "Debug/Log.h"
+
+#include "Render/NullRenderer.h"
+#include "Render/Vulkan/VulkanRenderer.h"
+
+#include "Resource/ComputeShader.h"
+#include "Resource/FragmentShader.h"
+#include "Resource/Shader.h"
+#include "Resource/VertexShader.h"
+
+#include "Utils/SPVReflection.h"
+
+std::unique_ptr<IRenderer> IRenderer::Create(RenderAPI renderAPI)
+{
+    switch (renderAPI)
+    {
+    case RenderAPI::Vulkan:
+        return std::make_unique<VulkanRenderer>();
+    case RenderAPI::Null:
+        return std::make_unique<NullRenderer>();
+    default:
+        return nullptr;
+    }
+}
+
+std::string IRenderer::CompileShader(ShaderType type, const std::string& code)
+{
+    shaderc_shader_kind kind;
+    switch (type)
+    {
+    case ShaderType::Vertex:
+        kind = shaderc_vertex_shader;
+        break;
+    case ShaderType::Fragment:
+        kind = shaderc_fragment_shader;
+        break;
+    case ShaderType::Compute:
+        kind = shaderc_compute_shader;
+        break;
+    default:
+        PrintError("Invalid shader type");
+        return "";
+    }
+
+    shaderc::Compiler compiler;
+    shaderc::CompileOptions options;
+
+    shaderc::SpvCompilationResult module =
+        compiler.CompileGlslToSpv(code, kind, "shader.glsl", options);
+
+    if (module.GetCompilationStatus() != shaderc_compilation_status_success)
+    {
+        PrintError("Shader compilation failed: %s", module.GetErrorMessage().c_str());;
+        return {};
+    }
+
+    std::vector<uint32_t> spirv(module.begin(), module.end());
+
+    const char* begin = reinterpret_cast<const char*>(spirv.data());
+    const char* end = begin + spirv.size() * sizeof(uint32_t);
+    return std::string(begin, end);
+}
+
+Uniforms IRenderer::GetUniforms(Shader* shader)
+{
+    VertexShader* vertex = shader->GetVertexShader();
+    FragmentShader* frag = shader->GetFragmentShader();
+    ComputeShader* comp = shader->GetComputeShader();
+
+    Uniforms uniforms;
+
+    Uniforms result = {};
+
+    if (vertex)
+    {
+        result = SPV::SpirvReflectUniforms(vertex->GetContent());
+        uniforms.reserve(result.size());
+        for (auto& uniform : result | std::views::values)
+        {
+            uniform.shaderType = ShaderType::Vertex;
+            uniforms[uniform.name] = uniform;
+        }
+    }
+
+    if (frag)
+    {
+        result = SPV::SpirvReflectUniforms(frag->GetContent());
+        uniforms.reserve(uniforms.size() + result.size());
+        for (auto& uniform : result | std::views::values)
+        {
+            uniform.shaderType = ShaderType::Fragment;
+            uniforms[uniform.name] = uniform;
+        }
+    }
+
+    if (comp)
+    {
+        result = SPV::SpirvReflectUniforms(comp->GetContent());
+        uniforms.reserve(uniforms.size() + result.size());
+        for (auto& uniform : result | std::views::values)
+        {
+            uniform.shaderType = ShaderType::Compute;
+            uniforms[uniform.name] = uniform;
+        }
+    }
+
+    return uniforms;
+}
+
+PushConstants IRenderer::GetPushConstants(Shader* shader)
+{
+    VertexShader* vertex = shader->GetVertexShader();
+    FragmentShader* frag = shader->GetFragmentShader();
+    ComputeShader* comp = shader->GetComputeShader();
+
+    PushConstants pushConstants;
+    std::optional<PushConstant> pushConstant;
+    if (vertex)
+    {
+        pushConstant = SPV::SpirvReflectPushConstants(vertex->GetContent());
+        if (pushConstant.has_value())
+        {
+            pushConstant.value().shaderType = ShaderType::Vertex;
+            pushConstants[ShaderType::Vertex] = pushConstant.value();
+        }
+    }
+
+    if (frag)
+    {
+        pushConstant = SPV::SpirvReflectPushConstants(frag->GetContent());
+        if (pushConstant.has_value())
+        {
+            pushConstant.value().shaderType = ShaderType::Fragment;
+            pushConstants[ShaderType::Fragment] = pushConstant.value();
+        }
+    }
+
+    if (comp)
+    {
+        pushConstant = SPV::SpirvReflectPushConstants(comp->GetContent());
+        if (pushConstant.has_value())
+        {
+            pushConstant.value().shaderType = ShaderType::Compute;
+            pushConstants[ShaderType::Compute] = pushConstant.value();
+        }
+    }
+    return pushConstants;
+}
+
+void IRenderer::AddLine(const Vec3f& start, const Vec3f& end, const Vec4f& color, float thickness)
+{
+    p_lineRenderer.AddLine(start, end, color, thickness);
+}
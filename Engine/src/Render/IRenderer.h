@@ -0,0 +1,105 @@
+#pragma once
+#include "EngineAPI.h"
+#include <array>
+#include <memory>
+#include <string>
+
+#include <galaxymath/Maths.h>
+
+#include "Render/LineRenderer.h"
+#include "Render/RenderQueue.h"
+#include "Resource/Loader/ImageLoader.h"
+#include "Resource/Mesh.h"
+#include "Resource/Shader.h"
+#include "Utils/Type.h"
+
+class Window;
+class Material;
+class Texture;
+class ComputeDispatch;
+class VulkanBuffer;
+class VulkanTexture;
+class VulkanVertexBuffer;
+class VulkanIndexBuffer;
+class VulkanShaderBuffer;
+class VulkanPipeline;
+class VulkanMaterial;
+
+enum class ENGINE_API RenderAPI
+{
+    Vulkan,
+    // Accepts uploads and draws, counts and discards them, for machines without display or GPU
+    Null,
+};
+
+// What the engine, the resources, the components and the editor render through, one implementation per RenderAPI.
+// GPU objects keep the Vulkan types, a backend without device creates them empty.
+class ENGINE_API IRenderer
+{
+public:
+    IRenderer() = default;
+    IRenderer(const IRenderer&) = delete;
+    IRenderer& operator=(const IRenderer&) = delete;
+    IRenderer(IRenderer&&) = delete;
+    virtual ~IRenderer() = default;
+
+    static std::unique_ptr<IRenderer> Create(RenderAPI renderAPI);
+    virtual RenderAPI GetRenderAPI() const = 0;
+
+    // window can be null for the null renderer
+    virtual bool Initialize(Window* window) = 0;
+    bool IsInitialized() const { return p_initialized; }
+    virtual void WaitForGPU() = 0;
+    virtual void Cleanup() = 0;
+
+    virtual void WaitUntilFrameFinished() = 0;
+    virtual bool BeginFrame() = 0;
+    virtual void EndFrame() = 0;
+    virtual void ClearColor() const = 0;
+
+    virtual void SendPushConstants(void* data, uint32_t size, Shader* shader, PushConstant pushConstant) const = 0;
+    virtual void BindVertexBuffers(VulkanVertexBuffer* vertexBuffer, VulkanIndexBuffer* indexBuffer) const = 0;
+    virtual void DrawVertex(VulkanVertexBuffer* vertexBuffer, const VulkanIndexBuffer* indexBuffer) = 0;
+    // lod only counts the triangles in the stats of that level
+    virtual void DrawVertexSubMesh(VulkanIndexBuffer* _indexBuffer, uint32_t startIndex, uint32_t indexCount, uint32_t lod = 0) = 0;
+    virtual void DrawInstanced(VulkanIndexBuffer* indexBuffer, VulkanVertexBuffer* vertexShader, VulkanBuffer* instanceBuffer, uint32_t instanceCount) = 0;
+
+    virtual bool MultiThreadSendToGPU() = 0;
+
+    // Compiled and reflected on the CPU, the same for every backend
+    std::string CompileShader(ShaderType type, const std::string& code);
+    Uniforms GetUniforms(Shader* shader);
+    PushConstants GetPushConstants(Shader* shader);
+
+    virtual void SendTexture(UBOBinding binding, Texture* texture, Shader* shader) = 0;
+    virtual void SendValue(UBOBinding binding, void* value, uint32_t size, Shader* shader) = 0;
+    virtual bool BindShader(Shader* shader) = 0;
+    virtual bool BindMaterial(Material* material) = 0;
+
+    virtual std::unique_ptr<VulkanTexture> CreateTexture(const ImageLoader::Image& image) = 0;
+    virtual std::unique_ptr<VulkanVertexBuffer> CreateVertexBuffer(const float* data, uint32_t size, uint32_t floatPerVertex) = 0;
+    virtual std::unique_ptr<VulkanIndexBuffer> CreateIndexBuffer(const uint32_t* data, uint32_t size) = 0;
+    virtual std::unique_ptr<VulkanShaderBuffer> CreateShaderBuffer(const std::string& code) = 0;
+    virtual std::unique_ptr<VulkanPipeline> CreatePipeline(const Shader* shader) = 0;
+    virtual std::unique_ptr<VulkanMaterial> CreateMaterial(Shader* shader) = 0;
+    virtual std::unique_ptr<ComputeDispatch> CreateDispatch(Shader* shader) = 0;
+
+    virtual void SetDefaultTexture(const SafePtr<Texture>& texture) = 0;
+
+    RenderQueueManager* GetRenderQueueManager() const { return p_renderQueueManager.get(); }
+    uint64_t GetTriangleCount() const { return p_triangleCount; }
+    uint64_t GetVertexCount() const { return p_vertexCount; }
+    // Triangles drawn this frame through meshes at this LOD
+    uint64_t GetLodTriangleCount(uint32_t lod) const { return p_lodTriangleCounts[lod]; }
+
+    LineRenderer* GetLineRenderer() { return &p_lineRenderer; }
+    void AddLine(const Vec3f& start, const Vec3f& end, const Vec4f& color, float thickness = 1.f);
+
+protected:
+    bool p_initialized = false;
+    std::unique_ptr<RenderQueueManager> p_renderQueueManager;
+    uint64_t p_triangleCount = 0;
+    uint64_t p_vertexCount = 0;
+    std::array<uint64_t, Mesh::MaxLodCount> p_lodTriangleCounts = {};
+    LineRenderer p_lineRenderer;
+};
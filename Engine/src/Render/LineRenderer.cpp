@@ -1,7 +1,7 @@
 #include "LineRenderer.h"
 
 #include "Core/Engine.h"
-#include "Render/Vulkan/VulkanRenderer.h"
+#include "Render/IRenderer.h"
 #include "Render/Vulkan/VulkanVertexBuffer.h"
 #include "Render/Vulkan/VulkanIndexBuffer.h"
 #include "Render/Vulkan/VulkanMaterial.h"
@@ -12,7 +12,7 @@ LineRenderer::~LineRenderer()
     Cleanup();
 }
 
-bool LineRenderer::Initialize(VulkanRenderer* renderer)
+bool LineRenderer::Initialize(IRenderer* renderer)
 {
     if (!renderer)
         return false;
@@ -119,12 +119,12 @@ void LineRenderer::RebuildBuffers()
 }
 
 
-void LineRenderer::UpdateCameraBuffer(VulkanRenderer* renderer, const Mat4& viewProj)
+void LineRenderer::UpdateCameraBuffer(IRenderer* renderer, const Mat4& viewProj)
 {
     m_material->SetAttribute("viewProj", viewProj);
 }
 
-void LineRenderer::Render(VulkanRenderer* renderer, const Mat4& viewProj)
+void LineRenderer::Render(IRenderer* renderer, const Mat4& viewProj)
 {
     if (!m_initialized || m_lines.empty() || !m_material)
     {
@@ -8,7 +8,7 @@
 #include <galaxymath/Maths.h>
 
 class Material;
-class VulkanRenderer;
+class IRenderer;
 class VulkanVertexBuffer;
 class VulkanIndexBuffer;
 class VulkanMaterial;
@@ -34,20 +34,20 @@ class ENGINE_API LineRenderer
     LineRenderer() = default;
     ~LineRenderer();
 
-    bool Initialize(VulkanRenderer* renderer);
+    bool Initialize(IRenderer* renderer);
     void Cleanup();
 
     void AddLine(const Vec3f& start, const Vec3f& end, const Vec4f& color, float thickness = 1.0f);
     void Clear();
 
-    void Render(VulkanRenderer* renderer, const Mat4& viewProj);
+    void Render(IRenderer* renderer, const Mat4& viewProj);
 
 private:
     void RebuildBuffers();
-    void UpdateCameraBuffer(VulkanRenderer* renderer, const Mat4& viewProj);
+    void UpdateCameraBuffer(IRenderer* renderer, const Mat4& viewProj);
 
 private:
-    VulkanRenderer* m_renderer = nullptr;
+    IRenderer* m_renderer = nullptr;
     
     std::vector<Line> m_lines;
     std::vector<LineVertex> m_vertices;
@@ -0,0 +1,136 @@
+#include "NullRenderer.h"
+
+#include "Debug/Log.h"
+
+#include "Render/Vulkan/VulkanIndexBuffer.h"
+#include "Render/Vulkan/VulkanMaterial.h"
+#include "Render/Vulkan/VulkanPipeline.h"
+#include "Render/Vulkan/VulkanShaderBuffer.h"
+#include "Render/Vulkan/VulkanTexture.h"
+#include "Render/Vulkan/VulkanVertexBuffer.h"
+
+#include "Resource/ComputeShader.h"
+#include "Resource/Material.h"
+#include "Resource/Shader.h"
+
+bool NullRenderer::Initialize(Window* window)
+{
+    UNUSED(window);
+    p_renderQueueManager = std::make_unique<RenderQueueManager>();
+    m_stats = NullRendererStats();
+    p_initialized = true;
+    PrintLog("Null renderer initialized");
+    return true;
+}
+
+void NullRenderer::Cleanup()
+{
+    p_lineRenderer.Cleanup();
+    p_initialized = false;
+    PrintLog("Null renderer cleaned up");
+}
+
+bool NullRenderer::BeginFrame()
+{
+    p_triangleCount = 0;
+    p_vertexCount = 0;
+    p_lodTriangleCounts.fill(0);
+    return true;
+}
+
+void NullRenderer::EndFrame()
+{
+    m_stats.frames++;
+}
+
+void NullRenderer::DrawVertex(VulkanVertexBuffer* vertexBuffer, const VulkanIndexBuffer* indexBuffer)
+{
+    UNUSED(vertexBuffer);
+    m_stats.drawCalls++;
+    p_vertexCount += indexBuffer->GetIndexCount();
+}
+
+void NullRenderer::DrawVertexSubMesh(VulkanIndexBuffer* _indexBuffer, uint32_t startIndex, uint32_t indexCount, uint32_t lod)
+{
+    UNUSED(_indexBuffer);
+    UNUSED(startIndex);
+    m_stats.drawCalls++;
+    p_vertexCount += indexCount;
+    p_triangleCount += indexCount / 3;
+    p_lodTriangleCounts[lod] += indexCount / 3;
+}
+
+void NullRenderer::DrawInstanced(VulkanIndexBuffer* indexBuffer, VulkanVertexBuffer* vertexShader, VulkanBuffer* instanceBuffer, uint32_t instanceCount)
+{
+    UNUSED(vertexShader);
+    UNUSED(instanceBuffer);
+    m_stats.drawCalls++;
+    p_triangleCount += (indexBuffer->GetIndexCount() / 3) * instanceCount;
+}
+
+bool NullRenderer::BindShader(Shader* shader)
+{
+    if (!shader || !shader->GetPipeline())
+        return false;
+    m_stats.shaderBinds++;
+    return true;
+}
+
+bool NullRenderer::BindMaterial(Material* material)
+{
+    if (!material)
+        return false;
+    m_stats.materialBinds++;
+    return true;
+}
+
+std::unique_ptr<VulkanTexture> NullRenderer::CreateTexture(const ImageLoader::Image& image)
+{
+    m_stats.textures++;
+    m_stats.uploadedBytes += static_cast<uint64_t>(image.size.x) * image.size.y * 4;
+    return std::make_unique<VulkanTexture>();
+}
+
+std::unique_ptr<VulkanVertexBuffer> NullRenderer::CreateVertexBuffer(const float* data, uint32_t size, uint32_t floatPerVertex)
+{
+    m_stats.vertexBuffers++;
+    m_stats.uploadedBytes += sizeof(data[0]) * size;
+    std::unique_ptr<VulkanVertexBuffer> vertexBuffer = std::make_unique<VulkanVertexBuffer>();
+    vertexBuffer->SetVertexCount(size / floatPerVertex);
+    return vertexBuffer;
+}
+
+std::unique_ptr<VulkanIndexBuffer> NullRenderer::CreateIndexBuffer(const uint32_t* data, uint32_t size)
+{
+    m_stats.indexBuffers++;
+    m_stats.uploadedBytes += sizeof(data[0]) * size;
+    std::unique_ptr<VulkanIndexBuffer> indexBuffer = std::make_unique<VulkanIndexBuffer>();
+    indexBuffer->SetIndexCount(size);
+    return indexBuffer;
+}
+
+std::unique_ptr<VulkanShaderBuffer> NullRenderer::CreateShaderBuffer(const std::string& code)
+{
+    m_stats.shaderBuffers++;
+    m_stats.uploadedBytes += code.size();
+    return std::make_unique<VulkanShaderBuffer>();
+}
+
+std::unique_ptr<VulkanPipeline> NullRenderer::CreatePipeline(const Shader* shader)
+{
+    UNUSED(shader);
+    m_stats.pipelines++;
+    return std::make_unique<VulkanPipeline>();
+}
+
+std::unique_ptr<VulkanMaterial> NullRenderer::CreateMaterial(Shader* shader)
+{
+    UNUSED(shader);
+    return nullptr;
+}
+
+std::unique_ptr<ComputeDispatch> NullRenderer::CreateDispatch(Shader* shader)
+{
+    UNUSED(shader);
+    return nullptr;
+}
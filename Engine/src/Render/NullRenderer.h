@@ -0,0 +1,66 @@
+#pragma once
+#include "EngineAPI.h"
+
+#include "Render/IRenderer.h"
+
+// What the null renderer received since its initialization
+struct ENGINE_API NullRendererStats
+{
+    uint64_t frames = 0;
+    uint64_t textures = 0;
+    uint64_t vertexBuffers = 0;
+    uint64_t indexBuffers = 0;
+    uint64_t shaderBuffers = 0;
+    uint64_t pipelines = 0;
+    uint64_t uploadedBytes = 0;
+    uint64_t shaderBinds = 0;
+    uint64_t materialBinds = 0;
+    uint64_t drawCalls = 0;
+};
+
+// Backend without device: uploads return empty GPU objects, draws only update the counters.
+// Shaders are still compiled and reflected on the CPU, so materials get their uniforms.
+class ENGINE_API NullRenderer final : public IRenderer
+{
+public:
+    NullRenderer() = default;
+
+    RenderAPI GetRenderAPI() const override { return RenderAPI::Null; }
+
+    bool Initialize(Window* window) override;
+    void WaitForGPU() override {}
+    void Cleanup() override;
+
+    void WaitUntilFrameFinished() override {}
+    bool BeginFrame() override;
+    void EndFrame() override;
+    void ClearColor() const override {}
+
+    void SendPushConstants(void*, uint32_t, Shader*, PushConstant) const override {}
+    void BindVertexBuffers(VulkanVertexBuffer*, VulkanIndexBuffer*) const override {}
+    void DrawVertex(VulkanVertexBuffer* vertexBuffer, const VulkanIndexBuffer* indexBuffer) override;
+    void DrawVertexSubMesh(VulkanIndexBuffer* _indexBuffer, uint32_t startIndex, uint32_t indexCount, uint32_t lod = 0) override;
+    void DrawInstanced(VulkanIndexBuffer* indexBuffer, VulkanVertexBuffer* vertexShader, VulkanBuffer* instanceBuffer, uint32_t instanceCount) override;
+
+    bool MultiThreadSendToGPU() override { return false; }
+
+    void SendTexture(UBOBinding, Texture*, Shader*) override {}
+    void SendValue(UBOBinding, void*, uint32_t, Shader*) override {}
+    bool BindShader(Shader* shader) override;
+    bool BindMaterial(Material* material) override;
+
+    std::unique_ptr<VulkanTexture> CreateTexture(const ImageLoader::Image& image) override;
+    std::unique_ptr<VulkanVertexBuffer> CreateVertexBuffer(const float* data, uint32_t size, uint32_t floatPerVertex) override;
+    std::unique_ptr<VulkanIndexBuffer> CreateIndexBuffer(const uint32_t* data, uint32_t size) override;
+    std::unique_ptr<VulkanShaderBuffer> CreateShaderBuffer(const std::string& code) override;
+    std::unique_ptr<VulkanPipeline> CreatePipeline(const Shader* shader) override;
+    // No descriptor sets to write, materials keep their values on the CPU
+    std::unique_ptr<VulkanMaterial> CreateMaterial(Shader* shader) override;
+    std::unique_ptr<ComputeDispatch> CreateDispatch(Shader* shader) override;
+
+    void SetDefaultTexture(const SafePtr<Texture>&) override {}
+
+    const NullRendererStats& GetStats() const { return m_stats; }
+private:
+    NullRendererStats m_stats;
+};
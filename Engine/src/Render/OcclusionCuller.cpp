@@ -0,0 +1,286 @@
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "Core/ThreadPool.h"
+#include "Utils/BatchMath.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define OCCLUSION_SSE
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // Points nearer than this in clip space w are behind the camera or too close to project
+    constexpr float MinW = 1e-5f;
+
+    struct ClipPoint
+    {
+        float x, y, z, w;
+    };
+
+    // Column order matrix, like the BatchMath kernels
+    ClipPoint ToClip(const float* m, float x, float y, float z)
+    {
+        return {
+            m[0] * x + m[4] * y + m[8] * z + m[12],
+            m[1] * x + m[5] * y + m[9] * z + m[13],
+            m[2] * x + m[6] * y + m[10] * z + m[14],
+            m[3] * x + m[7] * y + m[11] * z + m[15],
+        };
+    }
+}
+
+OcclusionCuller::OcclusionCuller(int width, int height)
+{
+    m_tilesX = std::max(1, (width + TileSize - 1) / TileSize);
+    m_tilesY = std::max(1, (height + TileSize - 1) / TileSize);
+    m_width = m_tilesX * TileSize;
+    m_height = m_tilesY * TileSize;
+    m_depth.assign(static_cast<size_t>(m_width) * m_height, FLT_MAX);
+    m_tileDepth.assign(static_cast<size_t>(m_tilesX) * m_tilesY, FLT_MAX);
+}
+
+void OcclusionCuller::Begin(const Mat4& viewProjection)
+{
+    m_viewProjection = viewProjection;
+    m_triangles.clear();
+    std::fill(m_depth.begin(), m_depth.end(), FLT_MAX);
+    std::fill(m_tileDepth.begin(), m_tileDepth.end(), FLT_MAX);
+}
+
+void OcclusionCuller::AddOccluder(const float* vertices, size_t vertexCount, size_t floatsPerVertex, const Mat4& model)
+{
+    Mat4 modelViewProjection;
+    BatchMath::MultiplyMatrices(&m_viewProjection, &model, &modelViewProjection, 1);
+    const float* m = reinterpret_cast<const float*>(&modelViewProjection);
+
+    const float halfWidth = 0.5f * static_cast<float>(m_width);
+    const float halfHeight = 0.5f * static_cast<float>(m_height);
+    for (size_t first = 0; first + 3 <= vertexCount; first += 3)
+    {
+        Triangle triangle;
+        bool behind = false;
+        for (int i = 0; i < 3; i++)
+        {
+            const float* position = vertices + (first + i) * floatsPerVertex;
+            const ClipPoint clip = ToClip(m, position[0], position[1], position[2]);
+            if (clip.w < MinW)
+            {
+                behind = true;
+                break;
+            }
+            const float inverseW = 1.0f / clip.w;
+            triangle.x[i] = (clip.x * inverseW + 1.0f) * halfWidth;
+            triangle.y[i] = (clip.y * inverseW + 1.0f) * halfHeight;
+            triangle.z[i] = clip.z * inverseW;
+        }
+        // Missing an occluder only lets more objects through
+        if (behind)
+            continue;
+
+        // Counter clockwise so the edge functions are positive inside, both faces occlude
+        const float area = (triangle.x[1] - triangle.x[0]) * (triangle.y[2] - triangle.y[0])
+            - (triangle.x[2] - triangle.x[0]) * (triangle.y[1] - triangle.y[0]);
+        if (!(std::fabs(area) > 0.0f))
+            continue;
+        if (area < 0.0f)
+        {
+            std::swap(triangle.x[1], triangle.x[2]);
+            std::swap(triangle.y[1], triangle.y[2]);
+            std::swap(triangle.z[1], triangle.z[2]);
+        }
+
+        // Pixels whose center is inside the bounds of the triangle
+        const float minX = std::min({ triangle.x[0], triangle.x[1], triangle.x[2] });
+        const float maxX = std::max({ triangle.x[0], triangle.x[1], triangle.x[2] });
+        const float minY = std::min({ triangle.y[0], triangle.y[1], triangle.y[2] });
+        const float maxY = std::max({ triangle.y[0], triangle.y[1], triangle.y[2] });
+        triangle.minX = static_cast<int>(std::max(0.0f, std::ceil(minX - 0.5f)));
+        triangle.minY = static_cast<int>(std::max(0.0f, std::ceil(minY - 0.5f)));
+        triangle.maxX = static_cast<int>(std::min(static_cast<float>(m_width - 1), std::floor(maxX - 0.5f)));
+        triangle.maxY = static_cast<int>(std::min(static_cast<float>(m_height - 1), std::floor(maxY - 0.5f)));
+        if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+            continue;
+
+        m_triangles.push_back(triangle);
+    }
+}
+
+void OcclusionCuller::Rasterize()
+{
+    // Each band owns its rows and tiles, no two threads write the same pixel
+    ThreadPool::ParallelFor(static_cast<size_t>(m_tilesY), [this](size_t begin, size_t end)
+    {
+        const int beginRow = static_cast<int>(begin) * TileSize;
+        const int endRow = static_cast<int>(end) * TileSize;
+        RasterizeBand(beginRow, endRow);
+        BuildTiles(beginRow, endRow);
+    });
+}
+
+void OcclusionCuller::RasterizeBand(int beginRow, int endRow)
+{
+    for (const Triangle& triangle : m_triangles)
+    {
+        if (triangle.maxY < beginRow || triangle.minY >= endRow)
+            continue;
+        RasterizeTriangle(triangle, std::max(beginRow, triangle.minY), std::min(endRow, triangle.maxY + 1));
+    }
+}
+
+// Edge functions at the pixel centers, the depth keeps the nearest value
+void OcclusionCuller::RasterizeTriangle(const Triangle& t, int beginRow, int endRow)
+{
+    // Edge i is opposite to vertex i: w(x, y) = a * x + b * y + c, positive inside
+    float a[3], b[3], c[3];
+    for (int i = 0; i < 3; i++)
+    {
+        const int from = (i + 1) % 3;
+        const int to = (i + 2) % 3;
+        a[i] = t.y[from] - t.y[to];
+        b[i] = t.x[to] - t.x[from];
+        c[i] = t.x[from] * t.y[to] - t.y[from] * t.x[to];
+    }
+    const float area = c[0] + c[1] + c[2];
+    // Depth is affine in screen space once divided by w
+    const float inverseArea = 1.0f / area;
+    const float za = (a[0] * t.z[0] + a[1] * t.z[1] + a[2] * t.z[2]) * inverseArea;
+    const float zb = (b[0] * t.z[0] + b[1] * t.z[1] + b[2] * t.z[2]) * inverseArea;
+    const float zc = (c[0] * t.z[0] + c[1] * t.z[1] + c[2] * t.z[2]) * inverseArea;
+
+#ifdef OCCLUSION_SSE
+    // Four pixels per step from a multiple of 4, the buffer width is a multiple of the tile size
+    const int beginX = t.minX & ~3;
+    const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+    __m128 stepW[3], edgeA[3];
+    for (int i = 0; i < 3; i++)
+    {
+        edgeA[i] = _mm_set1_ps(a[i]);
+        stepW[i] = _mm_set1_ps(4.0f * a[i]);
+    }
+    const __m128 stepZ = _mm_set1_ps(4.0f * za);
+
+    for (int y = beginRow; y < endRow; y++)
+    {
+        const float py = static_cast<float>(y) + 0.5f;
+        const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(beginX)), offsets);
+        __m128 w[3];
+        for (int i = 0; i < 3; i++)
+            w[i] = _mm_add_ps(_mm_mul_ps(edgeA[i], px), _mm_set1_ps(b[i] * py + c[i]));
+        __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(za), px), _mm_set1_ps(zb * py + zc));
+
+        float* row = m_depth.data() + static_cast<size_t>(y) * m_width;
+        for (int x = beginX; x <= t.maxX; x += 4)
+        {
+            const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w[0], zero), _mm_cmpge_ps(w[1], zero)), _mm_cmpge_ps(w[2], zero));
+            if (_mm_movemask_ps(inside) != 0)
+            {
+                const __m128 depth = _mm_loadu_ps(row + x);
+                const __m128 nearest = _mm_min_ps(depth, z);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, depth)));
+            }
+            for (int i = 0; i < 3; i++)
+                w[i] = _mm_add_ps(w[i], stepW[i]);
+            z = _mm_add_ps(z, stepZ);
+        }
+    }
+#else
+    for (int y = beginRow; y < endRow; y++)
+    {
+        const float py = static_cast<float>(y) + 0.5f;
+        float* row = m_depth.data() + static_cast<size_t>(y) * m_width;
+        for (int x = t.minX; x <= t.maxX; x++)
+        {
+            const float px = static_cast<float>(x) + 0.5f;
+            if (a[0] * px + b[0] * py + c[0] < 0.0f || a[1] * px + b[1] * py + c[1] < 0.0f || a[2] * px + b[2] * py + c[2] < 0.0f)
+                continue;
+            row[x] = std::min(row[x], za * px + zb * py + zc);
+        }
+    }
+#endif
+}
+
+void OcclusionCuller::BuildTiles(int beginRow, int endRow)
+{
+    for (int tileY = beginRow / TileSize; tileY < endRow / TileSize; tileY++)
+    {
+        for (int tileX = 0; tileX < m_tilesX; tileX++)
+        {
+            float farthest = 0.0f;
+            for (int y = tileY * TileSize; y < (tileY + 1) * TileSize; y++)
+            {
+                const float* row = m_depth.data() + static_cast<size_t>(y) * m_width + tileX * TileSize;
+                for (int x = 0; x < TileSize; x++)
+                    farthest = std::max(farthest, row[x]);
+            }
+            m_tileDepth[static_cast<size_t>(tileY) * m_tilesX + tileX] = farthest;
+        }
+    }
+}
+
+bool OcclusionCuller::IsVisible(const BoundingBox& worldBounds) const
+{
+    const float* m = reinterpret_cast<const float*>(&m_viewProjection);
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    float nearest = FLT_MAX;
+    for (int i = 0; i < 8; i++)
+    {
+        const float x = (i & 0x1) ? worldBounds.max.x : worldBounds.min.x;
+        const float y = (i & 0x2) ? worldBounds.max.y : worldBounds.min.y;
+        const float z = (i & 0x4) ? worldBounds.max.z : worldBounds.min.z;
+        const ClipPoint clip = ToClip(m, x, y, z);
+        // Crossing the near plane, the box is around the camera
+        if (clip.w < MinW)
+            return true;
+
+        const float inverseW = 1.0f / clip.w;
+        const float screenX = (clip.x * inverseW + 1.0f) * 0.5f * static_cast<float>(m_width);
+        const float screenY = (clip.y * inverseW + 1.0f) * 0.5f * static_cast<float>(m_height);
+        minX = std::min(minX, screenX);
+        maxX = std::max(maxX, screenX);
+        minY = std::min(minY, screenY);
+        maxY = std::max(maxY, screenY);
+        nearest = std::min(nearest, clip.z * inverseW);
+    }
+
+    // A rectangle that is not finite cannot be tested, frustum culling decides for it
+    if (!std::isfinite(minX) || !std::isfinite(minY) || !std::isfinite(maxX) || !std::isfinite(maxY) || !std::isfinite(nearest))
+        return true;
+
+    // Every pixel the screen rectangle touches
+    const int beginX = static_cast<int>(std::max(0.0f, std::floor(minX)));
+    const int beginY = static_cast<int>(std::max(0.0f, std::floor(minY)));
+    const int endX = static_cast<int>(std::min(static_cast<float>(m_width), std::ceil(maxX)));
+    const int endY = static_cast<int>(std::min(static_cast<float>(m_height), std::ceil(maxY)));
+    // Offscreen or without area, no pixel says the box is hidden
+    if (beginX >= endX || beginY >= endY)
+        return true;
+
+    for (int tileY = beginY / TileSize; tileY <= (endY - 1) / TileSize; tileY++)
+    {
+        for (int tileX = beginX / TileSize; tileX <= (endX - 1) / TileSize; tileX++)
+        {
+            // The whole tile is nearer than the box
+            if (m_tileDepth[static_cast<size_t>(tileY) * m_tilesX + tileX] < nearest)
+                continue;
+
+            const int rowBegin = std::max(beginY, tileY * TileSize), rowEnd = std::min(endY, (tileY + 1) * TileSize);
+            const int columnBegin = std::max(beginX, tileX * TileSize), columnEnd = std::min(endX, (tileX + 1) * TileSize);
+            for (int y = rowBegin; y < rowEnd; y++)
+            {
+                const float* row = m_depth.data() + static_cast<size_t>(y) * m_width;
+                for (int x = columnBegin; x < columnEnd; x++)
+                {
+                    if (row[x] >= nearest)
+                        return true;
+                }
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <galaxymath/Maths.h>
+
+#include "Physic/BoundingBox.h"
+
+// Software occlusion culling on the CPU. Occluder triangles are rasterized into a small depth buffer,
+// then the screen rectangle of each occludee box is tested against it, through a coarser level that keeps
+// the farthest depth of each tile. Depth is the clip space z / w: larger is farther, the empty buffer is FLT_MAX.
+class OcclusionCuller
+{
+public:
+    static constexpr int TileSize = 8;
+
+    // width and height are rounded up to whole tiles
+    OcclusionCuller(int width = 256, int height = 128);
+
+    // Clears the buffer and starts a frame seen through viewProjection
+    void Begin(const Mat4& viewProjection);
+    // Triangle list, positions are the first 3 floats of each vertex. Triangles crossing the near plane are skipped.
+    void AddOccluder(const float* vertices, size_t vertexCount, size_t floatsPerVertex, const Mat4& model);
+    // Rasterizes every occluder, in bands of rows over the thread pool, and builds the tile level
+    void Rasterize();
+
+    // False when every pixel under the box is nearer than the box. A box that cannot be tested (crossing the near plane,
+    // offscreen or without area on screen) is visible. Thread safe after Rasterize.
+    bool IsVisible(const BoundingBox& worldBounds) const;
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    size_t GetTriangleCount() const { return m_triangles.size(); }
+    // Depth at a pixel, for tests and debug views
+    float GetDepth(int x, int y) const { return m_depth[static_cast<size_t>(y) * m_width + x]; }
+
+private:
+    // Screen space triangle, counter clockwise, with its pixel bounds
+    struct Triangle
+    {
+        float x[3];
+        float y[3];
+        float z[3];
+        int minX, minY, maxX, maxY;
+    };
+
+    void RasterizeBand(int beginRow, int endRow);
+    void RasterizeTriangle(const Triangle& triangle, int beginRow, int endRow);
+    void BuildTiles(int beginRow, int endRow);
+
+private:
+    int m_width;
+    int m_height;
+    int m_tilesX;
+    int m_tilesY;
+
+    Mat4 m_viewProjection;
+    std::vector<Triangle> m_triangles;
+    std::vector<float> m_depth;
+    // Farthest depth of each tile
+    std::vector<float> m_tileDepth;
+};
@@ -5,11 +5,14 @@
 
 #include "Component/TransformComponent.h"
 
+#include "Resource/Material.h"
 #include "Resource/Mesh.h"
+#include "Resource/ResourceManager.h"
 
-#include "Vulkan/VulkanRenderer.h"
+#include "IRenderer.h"
 
 #include "Scene/GameObject.h"
+#include "Scene/Scene.h"
 
 void RenderCommand::GenerateSortKey()
 {
@@ -35,31 +38,39 @@ void RenderQueue::Submit(const RenderCommand& command)
 }
 
 void RenderQueue::SubmitMeshRenderer(GameObject* gameObject, Mesh* mesh,
-                                     const std::vector<SafePtr<Material>>& materials)
+                                     const std::vector<Material*>& materials, uint32_t lod)
 {
     if (!mesh || !mesh->IsLoaded() || !mesh->SentToGPU() || 
-        !mesh->GetVertexBuffer() || !mesh->GetIndexBuffer())
+        !mesh->GetVertexBuffer() || !mesh->GetIndexBuffer() || materials.empty())
+        return;
+    // The resources of the scene, like MeshComponent::OnRender, a scene may render without engine
+    const ResourceManager* resourceManager = gameObject->GetScene()->GetResourceManager();
+    if (!resourceManager)
         return;
         
-    auto transformComponent = gameObject->GetComponent<TransformComponent>();
-    auto model = transformComponent->GetWorldMatrix();
+    const Mat4 model = gameObject->ResolveTransform()->GetRenderMatrix();
         
     size_t materialCount = materials.size();
-    auto subMeshes = mesh->GetSubMeshes();
+    const auto& subMeshes = mesh->GetSubMeshes(lod);
         
     for (size_t i = 0; i < subMeshes.size(); ++i)
     {
         size_t materialIndex = i % materialCount;
-        auto& material = materials[materialIndex];
+        Material* material = materials[materialIndex];
+        if (!material)
+            continue;
             
         RenderCommand cmd;
         cmd.mesh = mesh;
         cmd.subMeshIndex = i;
         cmd.startIndex = subMeshes[i].startIndex;
         cmd.indexCount = subMeshes[i].count;
-        cmd.material = material.getPtr();
-        cmd.shader = material->GetShader().getPtr();
+        cmd.material = material;
+        cmd.shader = resourceManager->Resolve(material->GetShaderHandle());
+        if (!cmd.shader)
+            continue;
         cmd.modelMatrix = model;
+        cmd.lod = lod;
         cmd.GenerateSortKey();
             
         Submit(cmd);
@@ -91,7 +102,7 @@ void RenderQueue::Sort()
     }
 }
 
-void RenderQueue::Execute(VulkanRenderer* renderer)
+void RenderQueue::Execute(IRenderer* renderer)
 {
     Material* lastMaterial = nullptr;
     Shader* lastShader = nullptr;
@@ -127,7 +138,8 @@ void RenderQueue::Execute(VulkanRenderer* renderer)
         
         renderer->DrawVertexSubMesh(cmd.mesh->GetIndexBuffer(), 
                                     cmd.startIndex, 
-                                    cmd.indexCount);
+                                    cmd.indexCount,
+                                    cmd.lod);
     }
 }
 
@@ -150,7 +162,7 @@ void RenderQueueManager::SortAll() const
     m_uiQueue->Sort();
 }
 
-void RenderQueueManager::ExecuteAll(VulkanRenderer* renderer) const
+void RenderQueueManager::ExecuteAll(IRenderer* renderer) const
 {
     m_opaqueQueue->Execute(renderer);
     m_transparentQueue->Execute(renderer);
@@ -8,7 +8,7 @@
 #include "Resource/Shader.h"
 #include "Utils/Type.h"
 
-class VulkanRenderer;
+class IRenderer;
 class GameObject;
 class Mesh;
 class Material;
@@ -27,6 +27,7 @@ struct RenderCommand
     
     Mat4 modelMatrix;
     
+    uint32_t lod = 0;
     uint64_t sortKey;
     
     void GenerateSortKey();
@@ -48,12 +49,13 @@ class RenderQueue
     
     void Submit(const RenderCommand& command);
 
-    void SubmitMeshRenderer(GameObject* gameObject, Mesh* mesh, const std::vector<SafePtr<Material>>& materials);
+    // One command per submesh, materials resolved by the caller and used in turn, a null one skips its submeshes
+    void SubmitMeshRenderer(GameObject* gameObject, Mesh* mesh, const std::vector<Material*>& materials, uint32_t lod = 0);
     void SubmitInstancing(Mesh* mesh, Material* material, size_t instanceCount);
 
     void Sort();
 
-    void Execute(VulkanRenderer* renderer);
+    void Execute(IRenderer* renderer);
 
     void Clear();
 
@@ -75,7 +77,7 @@ class RenderQueueManager
     
     void SortAll() const;
 
-    void ExecuteAll(VulkanRenderer* renderer) const;
+    void ExecuteAll(IRenderer* renderer) const;
 
     void ClearAll() const;
 
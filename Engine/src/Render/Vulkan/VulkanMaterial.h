@@ -10,6 +10,7 @@
 
 class VulkanPipeline;
 class VulkanDevice;
+class VulkanRenderer;
 class Texture;
 
 class VulkanMaterial
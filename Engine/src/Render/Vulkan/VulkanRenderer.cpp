@@ -16,8 +16,6 @@
 #include <stdexcept>
 #include <chrono>
 #include <ranges>
-#include <spirv_reflect.h>
-#include <shaderc/shaderc.hpp>
 
 #include "VulkanDepthBuffer.h"
 #include "VulkanDescriptorSetLayout.h"
@@ -40,7 +38,6 @@
 
 #include "Core/Window/WindowGLFW.h"
 #include "Resource/ComputeShader.h"
-#include "Utils/SPVReflection.h"
 
 VulkanRenderer::~VulkanRenderer() = default;
 
@@ -53,7 +50,7 @@ bool VulkanRenderer::Initialize(Window* window)
     }
 
     m_window = window;
-    m_renderQueueManager = std::make_unique<RenderQueueManager>();
+    p_renderQueueManager = std::make_unique<RenderQueueManager>();
 
     try
     {
@@ -107,7 +104,7 @@ bool VulkanRenderer::Initialize(Window* window)
         }
         m_syncObjects->ResizeRenderFinishedSemaphores(m_swapChain->GetImageCount());
 
-        m_initialized = true;
+        p_initialized = true;
 
         window->EResizeEvent.Bind([this](Vec2i)
         {
@@ -135,7 +132,7 @@ void VulkanRenderer::WaitForGPU()
 
 void VulkanRenderer::Cleanup()
 {
-    m_lineRenderer.Cleanup();
+    p_lineRenderer.Cleanup();
     
     m_syncObjects.reset();
     m_commandPool.reset();
@@ -145,7 +142,7 @@ void VulkanRenderer::Cleanup()
     m_device.reset();
     m_context.reset();
 
-    m_initialized = false;
+    p_initialized = false;
     PrintLog("Vulkan renderer cleaned up");
 }
 
@@ -162,6 +159,7 @@ bool VulkanRenderer::BeginFrame()
 {
     p_triangleCount = 0;
     p_vertexCount = 0;
+    p_lodTriangleCounts.fill(0);
     m_imageIndex = 0;
     
     VkResult result = m_swapChain->AcquireNextImage(
@@ -316,13 +314,14 @@ void VulkanRenderer::DrawVertex(VulkanVertexBuffer* vertexBuffer, const VulkanIn
     p_vertexCount += indexCount;
 }
 
-void VulkanRenderer::DrawVertexSubMesh(VulkanIndexBuffer* _indexBuffer, uint32_t startIndex, uint32_t indexCount)
+void VulkanRenderer::DrawVertexSubMesh(VulkanIndexBuffer* _indexBuffer, uint32_t startIndex, uint32_t indexCount, uint32_t lod)
 {
     VkCommandBuffer commandBuffer = m_commandPool->GetCommandBuffer(m_currentFrame);
 
     vkCmdDrawIndexed(commandBuffer, indexCount, 1, startIndex, 0, 0);
     p_vertexCount += indexCount;
     p_triangleCount += indexCount / 3;
+    p_lodTriangleCounts[lod] += indexCount / 3;
 }
 
 void VulkanRenderer::DrawInstanced(VulkanIndexBuffer* indexBuffer, VulkanVertexBuffer* vertexShader, VulkanBuffer* instanceBuffer, uint32_t instanceCount)
@@ -339,130 +338,6 @@ void VulkanRenderer::DrawInstanced(VulkanIndexBuffer* indexBuffer, VulkanVertexB
     p_triangleCount += (indexBuffer->GetIndexCount() / 3) * instanceCount;
 }
 
-std::string VulkanRenderer::CompileShader(ShaderType type, const std::string& code)
-{
-    shaderc_shader_kind kind;
-    switch (type)
-    {
-    case ShaderType::Vertex:
-        kind = shaderc_vertex_shader;
-        break;
-    case ShaderType::Fragment:
-        kind = shaderc_fragment_shader;
-        break;
-    case ShaderType::Compute:
-        kind = shaderc_compute_shader;
-        break;
-    default:
-        PrintError("Invalid shader type");
-        return "";
-    }
-
-    shaderc::Compiler compiler;
-    shaderc::CompileOptions options;
-
-    shaderc::SpvCompilationResult module =
-        compiler.CompileGlslToSpv(code, kind, "shader.glsl", options);
-
-    if (module.GetCompilationStatus() != shaderc_compilation_status_success)
-    {
-        PrintError("Shader compilation failed: %s", module.GetErrorMessage().c_str());;
-        return {};
-    }
-
-    std::vector<uint32_t> spirv(module.begin(), module.end());
-
-    const char* begin = reinterpret_cast<const char*>(spirv.data());
-    const char* end = begin + spirv.size() * sizeof(uint32_t);
-    return std::string(begin, end);
-}
-
-Uniforms VulkanRenderer::GetUniforms(Shader* shader)
-{
-    VertexShader* vertex = shader->GetVertexShader();
-    FragmentShader* frag = shader->GetFragmentShader();
-    ComputeShader* comp = shader->GetComputeShader();
-
-    Uniforms uniforms;
-
-    Uniforms result = {};
-
-    if (vertex)
-    {
-        result = SPV::SpirvReflectUniforms(vertex->GetContent());
-        uniforms.reserve(result.size());
-        for (auto& uniform : result | std::views::values)
-        {
-            uniform.shaderType = ShaderType::Vertex;
-            uniforms[uniform.name] = uniform;
-        }
-    }
-
-    if (frag)
-    {
-        result = SPV::SpirvReflectUniforms(frag->GetContent());
-        uniforms.reserve(uniforms.size() + result.size());
-        for (auto& uniform : result | std::views::values)
-        {
-            uniform.shaderType = ShaderType::Fragment;
-            uniforms[uniform.name] = uniform;
-        }
-    }
-
-    if (comp)
-    {
-        result = SPV::SpirvReflectUniforms(comp->GetContent());
-        uniforms.reserve(uniforms.size() + result.size());
-        for (auto& uniform : result | std::views::values)
-        {
-            uniform.shaderType = ShaderType::Compute;
-            uniforms[uniform.name] = uniform;
-        }
-    }
-
-    return uniforms;
-}
-
-PushConstants VulkanRenderer::GetPushConstants(Shader* shader)
-{
-    VertexShader* vertex = shader->GetVertexShader();
-    FragmentShader* frag = shader->GetFragmentShader();
-    ComputeShader* comp = shader->GetComputeShader();
-
-    PushConstants pushConstants;
-    std::optional<PushConstant> pushConstant;
-    if (vertex)
-    {
-        pushConstant = SPV::SpirvReflectPushConstants(vertex->GetContent());
-        if (pushConstant.has_value())
-        {
-            pushConstant.value().shaderType = ShaderType::Vertex;
-            pushConstants[ShaderType::Vertex] = pushConstant.value();
-        }
-    }
-
-    if (frag)
-    {
-        pushConstant = SPV::SpirvReflectPushConstants(frag->GetContent());
-        if (pushConstant.has_value())
-        {
-            pushConstant.value().shaderType = ShaderType::Fragment;
-            pushConstants[ShaderType::Fragment] = pushConstant.value();
-        }
-    }
-
-    if (comp)
-    {
-        pushConstant = SPV::SpirvReflectPushConstants(comp->GetContent());
-        if (pushConstant.has_value())
-        {
-            pushConstant.value().shaderType = ShaderType::Compute;
-            pushConstants[ShaderType::Compute] = pushConstant.value();
-        }
-    }
-    return pushConstants;
-}
-
 void VulkanRenderer::SendTexture(UBOBinding binding, Texture* texture, Shader* shader)
 {
 }
@@ -632,11 +507,6 @@ void VulkanRenderer::ClearColor() const
                        clearValues);
 }
 
-void VulkanRenderer::AddLine(const Vec3f& start, const Vec3f& end, const Vec4f& color, float thickness)
-{
-    m_lineRenderer.AddLine(start, end, color, thickness);
-}
-
 void VulkanRenderer::RecreateSwapChain()
 {
     Vec2i windowSize = m_window->GetSize();
@@ -22,10 +22,8 @@
 #include "VulkanSwapChain.h"
 #include "VulkanSyncObjects.h"
 #include "VulkanVertexBuffer.h"
-#include "Render/LineRenderer.h"
-#include "Render/RenderQueue.h"
+#include "Render/IRenderer.h"
 
-enum class ShaderType;
 class Window;
 
 struct UniformBufferObject
@@ -35,54 +33,48 @@ struct UniformBufferObject
     Mat4 Projection;
 };
 
-class ENGINE_API VulkanRenderer
+class ENGINE_API VulkanRenderer : public IRenderer
 {
 public:
     VulkanRenderer() = default;
-    VulkanRenderer(const VulkanRenderer&) = delete;
-    VulkanRenderer& operator=(const VulkanRenderer&) = delete;
-    VulkanRenderer(VulkanRenderer&&) = delete;
-    ~VulkanRenderer();
+    ~VulkanRenderer() override;
 
-    bool Initialize(Window* window);
-    bool IsInitialized() const { return m_initialized; }
-    void WaitForGPU();
-    void Cleanup();
+    RenderAPI GetRenderAPI() const override { return RenderAPI::Vulkan; }
+
+    bool Initialize(Window* window) override;
+    void WaitForGPU() override;
+    void Cleanup() override;
     
-    void WaitUntilFrameFinished();
-    bool BeginFrame();
+    void WaitUntilFrameFinished() override;
+    bool BeginFrame() override;
     void Update();
-    void EndFrame();
+    void EndFrame() override;
+    void ClearColor() const override;
     
-    void SendPushConstants(void* data, uint32_t size, Shader* shader, PushConstant pushConstant) const;
-    void BindVertexBuffers(VulkanVertexBuffer* vertexBuffer, VulkanIndexBuffer* indexBuffer) const;
-    void DrawVertex(VulkanVertexBuffer* vertexBuffer, const VulkanIndexBuffer* indexBuffer);
-    void DrawVertexSubMesh(VulkanIndexBuffer* _indexBuffer, uint32_t startIndex, uint32_t indexCount);
-    void DrawInstanced(VulkanIndexBuffer* indexBuffer, VulkanVertexBuffer* vertexShader, VulkanBuffer* instanceBuffer, uint32_t instanceCount);
+    void SendPushConstants(void* data, uint32_t size, Shader* shader, PushConstant pushConstant) const override;
+    void BindVertexBuffers(VulkanVertexBuffer* vertexBuffer, VulkanIndexBuffer* indexBuffer) const override;
+    void DrawVertex(VulkanVertexBuffer* vertexBuffer, const VulkanIndexBuffer* indexBuffer) override;
+    void DrawVertexSubMesh(VulkanIndexBuffer* _indexBuffer, uint32_t startIndex, uint32_t indexCount, uint32_t lod = 0) override;
+    void DrawInstanced(VulkanIndexBuffer* indexBuffer, VulkanVertexBuffer* vertexShader, VulkanBuffer* instanceBuffer, uint32_t instanceCount) override;
     
     void DrawFrame();
     
-    bool MultiThreadSendToGPU();
-
-    std::string CompileShader(ShaderType type, const std::string& code);
-    Uniforms GetUniforms(Shader* shader);
-    PushConstants GetPushConstants(Shader* shader);
+    bool MultiThreadSendToGPU() override;
     
-    void SendTexture(UBOBinding binding, Texture* texture, Shader* shader);
-    void SendValue(UBOBinding binding, void* value, uint32_t size, Shader* shader);
-    bool BindShader(Shader* shader);
-    bool BindMaterial(Material* material);
+    void SendTexture(UBOBinding binding, Texture* texture, Shader* shader) override;
+    void SendValue(UBOBinding binding, void* value, uint32_t size, Shader* shader) override;
+    bool BindShader(Shader* shader) override;
+    bool BindMaterial(Material* material) override;
     
-    std::unique_ptr<VulkanTexture> CreateTexture(const ImageLoader::Image& image);
-    std::unique_ptr<VulkanVertexBuffer> CreateVertexBuffer(const float* data, uint32_t size, uint32_t floatPerVertex);
-    std::unique_ptr<VulkanIndexBuffer> CreateIndexBuffer(const uint32_t* data, uint32_t size);
-    std::unique_ptr<VulkanShaderBuffer> CreateShaderBuffer(const std::string& code);
-    std::unique_ptr<VulkanPipeline> CreatePipeline(const Shader* shader);
-    std::unique_ptr<VulkanMaterial> CreateMaterial(Shader* shader);
-    std::unique_ptr<ComputeDispatch> CreateDispatch(Shader* shader);
+    std::unique_ptr<VulkanTexture> CreateTexture(const ImageLoader::Image& image) override;
+    std::unique_ptr<VulkanVertexBuffer> CreateVertexBuffer(const float* data, uint32_t size, uint32_t floatPerVertex) override;
+    std::unique_ptr<VulkanIndexBuffer> CreateIndexBuffer(const uint32_t* data, uint32_t size) override;
+    std::unique_ptr<VulkanShaderBuffer> CreateShaderBuffer(const std::string& code) override;
+    std::unique_ptr<VulkanPipeline> CreatePipeline(const Shader* shader) override;
+    std::unique_ptr<VulkanMaterial> CreateMaterial(Shader* shader) override;
+    std::unique_ptr<ComputeDispatch> CreateDispatch(Shader* shader) override;
     
-    void SetDefaultTexture(const SafePtr<Texture>& texture);
-    void ClearColor() const;
+    void SetDefaultTexture(const SafePtr<Texture>& texture) override;
     
     uint32_t GetFrameIndex() const { return m_currentFrame; }
     VkCommandBuffer GetCommandBuffer() const { return m_commandPool->GetCommandBuffer(m_currentFrame); }
@@ -96,22 +88,11 @@ class ENGINE_API VulkanRenderer
     
     uint32_t GetMaxFramesInFlight() const { return MAX_FRAMES_IN_FLIGHT; }
     
-    RenderQueueManager* GetRenderQueueManager() const { return m_renderQueueManager.get(); }
-    uint64_t GetTriangleCount() const { return p_triangleCount; }
-    uint64_t GetVertexCount() const { return p_vertexCount; }
-
-    LineRenderer* GetLineRenderer() { return &m_lineRenderer; }
-    void AddLine(const Vec3f& start, const Vec3f& end, const Vec4f& color, float thickness = 1.f);
 private:
     void RecreateSwapChain();
     void TransitionImageForPresent() const;
 
 private:
-    bool m_initialized = false;
-    std::unique_ptr<RenderQueueManager> m_renderQueueManager;
-    uint64_t p_triangleCount = 0;
-    uint64_t p_vertexCount = 0;
-    
     Window* m_window = nullptr;
     bool m_framebufferResized = false;
 
@@ -130,6 +111,4 @@ class ENGINE_API VulkanRenderer
 
     static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 2;
     uint32_t m_currentFrame = 0;
-    
-    LineRenderer m_lineRenderer;
 };
\ No newline at end of file
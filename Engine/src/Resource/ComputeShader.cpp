@@ -9,7 +9,7 @@ ComputeDispatch::~ComputeDispatch()
     }
 }
 
-bool ComputeShader::SendToGPU(VulkanRenderer* renderer)
+bool ComputeShader::SendToGPU(IRenderer* renderer)
 {
     if (!BaseShader::SendToGPU(renderer))
         return false;
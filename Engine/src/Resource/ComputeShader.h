@@ -31,5 +31,5 @@ class ComputeShader : public BaseShader
     
     ShaderType GetShaderType() const override { return ShaderType::Compute; }
     
-    bool SendToGPU(VulkanRenderer* renderer) override;
+    bool SendToGPU(IRenderer* renderer) override;
 };
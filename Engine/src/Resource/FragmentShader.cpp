@@ -5,7 +5,7 @@ bool FragmentShader::Load(ResourceManager* resourceManager)
     return BaseShader::Load(resourceManager);
 }
 
-bool FragmentShader::SendToGPU(VulkanRenderer* renderer)
+bool FragmentShader::SendToGPU(IRenderer* renderer)
 {
     return BaseShader::SendToGPU(renderer);
 }
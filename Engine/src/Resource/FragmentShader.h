@@ -11,7 +11,7 @@ class FragmentShader : public BaseShader
     virtual ~FragmentShader() override = default;
     
     bool Load(ResourceManager* resourceManager) override;
-    bool SendToGPU(VulkanRenderer* renderer) override;
+    bool SendToGPU(IRenderer* renderer) override;
     void Unload() override;
     
     ResourceType GetResourceType() const override { return ResourceType::VertexShader; }
@@ -8,9 +8,10 @@
 #include "Scene/ClassDescriptor.h"
 
 #include "Utils/Event.h"
+#include "Utils/Handle.h"
 
 class ResourceManager;
-class VulkanRenderer;
+class IRenderer;
 
 enum class ResourceType
 {
@@ -81,7 +82,7 @@ class IResource
     virtual ~IResource() = default;
 
     virtual bool Load(ResourceManager* resourceManager) = 0;
-    virtual bool SendToGPU(VulkanRenderer* renderer) = 0;
+    virtual bool SendToGPU(IRenderer* renderer) = 0;
     virtual void Unload() = 0;
     
     virtual void Describe(ClassDescriptor& descriptor) {}
@@ -89,6 +90,8 @@ class IResource
     virtual ResourceType GetResourceType() const = 0;
 
     Core::UUID GetUUID() const { return p_uuid; }
+    // Resolved through ResourceManager::Resolve, valid while the resource is registered
+    Handle<IResource> GetResourceHandle() const { return p_handle; }
     std::filesystem::path GetPath() const { return p_path; }
 
     virtual std::string GetName(bool extension = false) const;
@@ -116,6 +119,7 @@ class IResource
     
     std::filesystem::path p_path;
     Core::UUID p_uuid;
+    Handle<IResource> p_handle;
 
     std::atomic_bool p_isLoading;
     std::atomic_bool p_isLoaded;
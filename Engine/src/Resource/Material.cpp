@@ -15,7 +15,7 @@ bool Material::Load(ResourceManager* resourceManager)
     return true;
 }
 
-bool Material::SendToGPU(VulkanRenderer* renderer)
+bool Material::SendToGPU(IRenderer* renderer)
 {
     return true;
 }
@@ -67,6 +67,7 @@ void Material::SetShader(const SafePtr<Shader>& shader)
     }
 
     m_shader = shader;
+    m_shaderHandle = m_shader->GetResourceHandle().Cast<Shader>();
     m_shaderChangeEvent = m_shader->EOnSentToGPU.Bind([this]()
     {
         OnShaderChanged();
@@ -167,10 +168,12 @@ void Material::SetAttribute(const std::string& name, const Mat4& attribute)
     }
 }
 
-void Material::SendAllValues(VulkanRenderer* renderer) const
+void Material::SendAllValues(IRenderer* renderer) const
 {
-    if (!m_shader->IsLoaded() || !m_shader->SentToGPU())
+    // No handle with the null renderer, a handle comes from the Vulkan one
+    if (!m_handle || !m_shader->IsLoaded() || !m_shader->SentToGPU())
         return;
+    VulkanRenderer* vulkanRenderer = static_cast<VulkanRenderer*>(renderer);
 
     struct UniformBuffer
     {
@@ -248,7 +251,7 @@ void Material::SendAllValues(VulkanRenderer* renderer) const
             binding.second,
             buffer.data.data(),
             buffer.data.size(),
-            renderer);
+            vulkanRenderer);
     }
 }
 
@@ -386,8 +389,9 @@ void Material::OnShaderChanged()
 
 void Material::SendTexture(Texture* texture, const Uniform& uniform) const
 {
-    VulkanRenderer* renderer = Engine::Get()->GetRenderer();
     VulkanMaterial* rhiMat = m_handle.get();
-    rhiMat->SetTexture(uniform.set, uniform.binding, texture, renderer);
+    if (!rhiMat)
+        return;
+    rhiMat->SetTexture(uniform.set, uniform.binding, texture, static_cast<VulkanRenderer*>(Engine::Get()->GetRenderer()));
     PrintLog("Send Texture %s to material %s", texture->GetPath().filename().generic_string().c_str(), GetPath().generic_string().c_str());
 }
@@ -9,6 +9,7 @@
 
 class Shader;
 class Texture;
+class VulkanRenderer;
 
 struct CustomAttributes
 {
@@ -56,13 +57,14 @@ class Material : public IResource
     DECLARE_RESOURCE_TYPE(Material)
     
     bool Load(ResourceManager* resourceManager) override;
-    bool SendToGPU(VulkanRenderer* renderer) override;
+    bool SendToGPU(IRenderer* renderer) override;
     void Unload() override;
     
     void Describe(ClassDescriptor& descriptor) override;
     
     void SetShader(const SafePtr<Shader>& shader);
     SafePtr<Shader> GetShader() const { return m_shader; }
+    Handle<Shader> GetShaderHandle() const { return m_shaderHandle; }
 
     void SetAttribute(const std::string& name, float attribute);
     void SetAttribute(const std::string& name, int attribute);
@@ -72,7 +74,7 @@ class Material : public IResource
     void SetAttribute(const std::string& name, const SafePtr<Texture>& texture);
     void SetAttribute(const std::string& name, const Mat4& attribute);
 
-    void SendAllValues(VulkanRenderer* renderer) const;
+    void SendAllValues(IRenderer* renderer) const;
 
     bool Bind(VulkanRenderer* renderer);
 
@@ -85,6 +87,7 @@ class Material : public IResource
 private:
     std::unique_ptr<VulkanMaterial> m_handle;
     SafePtr<Shader> m_shader;
+    Handle<Shader> m_shaderHandle;
     
     MaterialAttributes m_attributes;
     MaterialAttributes m_temporaryAttributes;
@@ -1,10 +1,15 @@
 ﻿#include "Mesh.h"
 
+#include <algorithm>
+#include <cmath>
+
+#include "MeshSimplifier.h"
+#include "Model.h"
 #include "ResourceManager.h"
 #include "Debug/Log.h"
-#include "Render/Vulkan/VulkanRenderer.h"
+#include "Render/IRenderer.h"
 
-class VulkanRenderer;
+class IRenderer;
 
 VkVertexInputBindingDescription Vertex::GetBindingDescription()
 {
@@ -52,10 +57,10 @@ bool Mesh::Load(ResourceManager* resourceManager)
     return false; // To not send twice
 }
 
-bool Mesh::SendToGPU(VulkanRenderer* renderer)
+bool Mesh::SendToGPU(IRenderer* renderer)
 {
     ASSERT(!m_vertices.empty());
-    uint32_t floatsPerVertex = 11;
+    uint32_t floatsPerVertex = FloatsPerVertex;
     m_vertexBuffer = renderer->CreateVertexBuffer(
         m_vertices.data(),
         static_cast<uint32_t>(m_vertices.size()),
@@ -73,6 +78,8 @@ bool Mesh::SendToGPU(VulkanRenderer* renderer)
     {
         sequentialIndices[i] = i;
     }
+    // The LOD ranges start after the full detail ones
+    sequentialIndices.insert(sequentialIndices.end(), m_lodIndices.begin(), m_lodIndices.end());
     m_indexBuffer = renderer->CreateIndexBuffer(
         sequentialIndices.data(),
         static_cast<uint32_t>(sequentialIndices.size())
@@ -92,6 +99,95 @@ void Mesh::Unload()
 {
 }
 
+uint32_t Mesh::GetLodTriangleCount(uint32_t lod) const
+{
+    if (lod > 0)
+        return m_lods[lod - 1].triangleCount;
+    uint32_t count = 0;
+    for (const SubMesh& subMesh : m_subMeshes)
+        count += subMesh.count / 3;
+    return count;
+}
+
+uint32_t Mesh::SelectLod(float screenSize, uint32_t currentLod) const
+{
+    uint32_t lod = 0;
+    for (uint32_t i = 1; i < GetLodCount(); i++)
+    {
+        // Easier to stay on a coarse level than to enter it
+        const float threshold = m_lods[i - 1].screenSize;
+        const float limit = currentLod >= i ? threshold * (1.0f + LodHysteresis) : threshold * (1.0f - LodHysteresis);
+        if (screenSize >= limit)
+            break;
+        lod = i;
+    }
+    return lod;
+}
+
+void Mesh::GenerateLods()
+{
+    m_lods.clear();
+    m_lodIndices.clear();
+    if (!m_boundingBox.IsValid())
+        return;
+
+    // Triangles kept by each simplified level, relative to the full detail, and the screen size it is used below
+    constexpr float triangleRatios[MaxLodCount - 1] = { 0.5f, 0.25f, 0.125f };
+    constexpr float screenSizes[MaxLodCount - 1] = { 0.4f, 0.2f, 0.1f };
+    constexpr int maxAttempts = 8;
+
+    const uint32_t vertexCount = static_cast<uint32_t>(m_vertices.size() / FloatsPerVertex);
+    std::vector<uint32_t> sequentialIndices(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; i++)
+        sequentialIndices[i] = i;
+
+    std::vector<MeshSimplifier::Range> ranges;
+    ranges.reserve(m_subMeshes.size());
+    for (const SubMesh& subMesh : m_subMeshes)
+        ranges.push_back({ subMesh.startIndex, subMesh.count });
+
+    const uint32_t fullTriangleCount = GetLodTriangleCount(0);
+    uint32_t previousTriangleCount = fullTriangleCount;
+    // A surface in a grid of n cells per axis has in the order of n^2 triangles
+    float cellsPerAxis = std::sqrt(static_cast<float>(fullTriangleCount));
+    std::vector<uint32_t> indices;
+    std::vector<MeshSimplifier::Range> lodRanges;
+    for (uint32_t level = 0; level < MaxLodCount - 1; level++)
+    {
+        const float target = static_cast<float>(fullTriangleCount) * triangleRatios[level];
+        if (target < 1.0f)
+            break;
+
+        // Coarser grid until the count is close enough to the target
+        uint32_t triangleCount = 0;
+        for (int attempt = 0; attempt < maxAttempts && cellsPerAxis >= 1.0f; attempt++)
+        {
+            indices.clear();
+            MeshSimplifier::Cluster(m_vertices.data(), FloatsPerVertex, sequentialIndices.data(), ranges,
+                                    m_boundingBox.min, m_boundingBox.max, static_cast<uint32_t>(cellsPerAxis), indices, lodRanges);
+            triangleCount = static_cast<uint32_t>(indices.size() / 3);
+            if (static_cast<float>(triangleCount) <= target * 1.25f)
+                break;
+            cellsPerAxis *= std::clamp(target / static_cast<float>(triangleCount), 0.25f, 0.9f);
+        }
+        // Not worth a level when most triangles are still there
+        if (triangleCount == 0 || static_cast<float>(triangleCount) > static_cast<float>(previousTriangleCount) * 0.75f)
+            break;
+
+        // Ranges are offset past the full detail indices and the previous levels
+        const uint32_t offset = vertexCount + static_cast<uint32_t>(m_lodIndices.size());
+        MeshLod lod;
+        lod.triangleCount = triangleCount;
+        lod.screenSize = screenSizes[level];
+        lod.subMeshes.reserve(lodRanges.size());
+        for (const MeshSimplifier::Range& range : lodRanges)
+            lod.subMeshes.push_back(SubMesh(offset + range.startIndex, range.count));
+        m_lodIndices.insert(m_lodIndices.end(), indices.begin(), indices.end());
+        m_lods.push_back(std::move(lod));
+        previousTriangleCount = triangleCount;
+    }
+}
+
 void Mesh::ComputeBoundingBox(const std::vector<Vec3f>& positionVertices)
 {
     for (const auto& vertex : positionVertices)
@@ -31,30 +31,59 @@ struct SubMesh
     uint32_t count;
 };
 
+// Simplified copy of the mesh: index ranges after the full detail ones, in the same index buffer
+struct MeshLod
+{
+    std::vector<SubMesh> subMeshes;
+    uint32_t triangleCount = 0;
+    // Used once the projected height of the bounds, as a fraction of the screen, gets below this
+    float screenSize = 0.0f;
+};
+
 class Mesh : public IResource
 {
 public:
     DECLARE_RESOURCE_TYPE(Mesh)
 
+    // position, texCoord, normal and tangent, no index buffer
+    static constexpr uint32_t FloatsPerVertex = 11;
+    // Full detail included
+    static constexpr uint32_t MaxLodCount = 4;
+    // A LOD changes once the screen size is past its threshold by this fraction, to not flicker at the limit
+    static constexpr float LodHysteresis = 0.1f;
+
     bool Load(ResourceManager* resourceManager) override;
-    bool SendToGPU(VulkanRenderer* renderer) override;
+    bool SendToGPU(IRenderer* renderer) override;
     void Unload() override;
 
     VulkanVertexBuffer* GetVertexBuffer() const { return m_vertexBuffer.get(); }
     VulkanIndexBuffer* GetIndexBuffer() const { return m_indexBuffer.get(); }
     
     const std::vector<SubMesh>& GetSubMeshes() const { return m_subMeshes; }
+    // Level 0 is the full detail mesh
+    const std::vector<SubMesh>& GetSubMeshes(uint32_t lod) const { return lod == 0 ? m_subMeshes : m_lods[lod - 1].subMeshes; }
+    uint32_t GetLodCount() const { return static_cast<uint32_t>(m_lods.size()) + 1; }
+    uint32_t GetLodTriangleCount(uint32_t lod) const;
+    // LOD for a screen size, staying on currentLod while within the hysteresis of its thresholds
+    uint32_t SelectLod(float screenSize, uint32_t currentLod) const;
     
     const BoundingBox& GetBoundingBox() const { return m_boundingBox; }
+    // Kept on the CPU after the upload, triangle list
+    const std::vector<float>& GetVertices() const { return m_vertices; }
 
 private:
     void ComputeBoundingBox(const std::vector<Vec3f>& positionVertices);
+    // Builds the simplified levels from m_vertices and m_subMeshes, at import
+    void GenerateLods();
 private:
     friend class Model;
     
     std::vector<float> m_vertices;
     std::vector<uint32_t> m_indices;
     std::vector<SubMesh> m_subMeshes;
+    std::vector<MeshLod> m_lods;
+    // Indices of m_lods, uploaded after the full detail ones
+    std::vector<uint32_t> m_lodIndices;
 
     std::unique_ptr<VulkanVertexBuffer> m_vertexBuffer;
     std::unique_ptr<VulkanIndexBuffer> m_indexBuffer;
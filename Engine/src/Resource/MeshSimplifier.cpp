@@ -0,0 +1,107 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+    constexpr uint64_t CellBits = 21;
+    constexpr uint64_t CellMask = (1ull << CellBits) - 1;
+
+    struct Cell
+    {
+        float sumX = 0.0f, sumY = 0.0f, sumZ = 0.0f;
+        uint32_t count = 0;
+        uint32_t vertex = UINT32_MAX;
+        float distance = FLT_MAX;
+    };
+
+    struct TriangleHash
+    {
+        size_t operator()(const std::array<uint32_t, 3>& t) const
+        {
+            return (static_cast<size_t>(t[0]) * 73856093u) ^ (static_cast<size_t>(t[1]) * 19349663u) ^ (static_cast<size_t>(t[2]) * 83492791u);
+        }
+    };
+}
+
+namespace MeshSimplifier
+{
+    void Cluster(const float* vertices, size_t floatsPerVertex, const uint32_t* indices, const std::vector<Range>& ranges,
+                 const Vec3f& boundsMin, const Vec3f& boundsMax, uint32_t cellsPerAxis,
+                 std::vector<uint32_t>& outIndices, std::vector<Range>& outRanges)
+    {
+        const Vec3f size = boundsMax - boundsMin;
+        const float longest = std::max({ size.x, size.y, size.z, FLT_MIN });
+        const float inverseCellSize = static_cast<float>(std::clamp<uint32_t>(cellsPerAxis, 1, CellMask)) / longest;
+        const float maxCell = static_cast<float>(CellMask);
+
+        auto position = [&](uint32_t vertex) { return vertices + static_cast<size_t>(vertex) * floatsPerVertex; };
+        auto cellOf = [&](uint32_t vertex)
+        {
+            const float* p = position(vertex);
+            const uint64_t x = static_cast<uint64_t>(std::clamp((p[0] - boundsMin.x) * inverseCellSize, 0.0f, maxCell));
+            const uint64_t y = static_cast<uint64_t>(std::clamp((p[1] - boundsMin.y) * inverseCellSize, 0.0f, maxCell));
+            const uint64_t z = static_cast<uint64_t>(std::clamp((p[2] - boundsMin.z) * inverseCellSize, 0.0f, maxCell));
+            return x | (y << CellBits) | (z << (2 * CellBits));
+        };
+
+        std::unordered_map<uint64_t, Cell> cells;
+        std::unordered_set<std::array<uint32_t, 3>, TriangleHash> emitted;
+        outRanges.clear();
+        outRanges.reserve(ranges.size());
+        for (const Range& range : ranges)
+        {
+            cells.clear();
+            emitted.clear();
+            const uint32_t* begin = indices + range.startIndex;
+            const uint32_t* end = begin + range.count;
+
+            // Mean of each cell, then the vertex nearest to it
+            for (const uint32_t* it = begin; it != end; it++)
+            {
+                const float* p = position(*it);
+                Cell& cell = cells[cellOf(*it)];
+                cell.sumX += p[0];
+                cell.sumY += p[1];
+                cell.sumZ += p[2];
+                cell.count++;
+            }
+            for (const uint32_t* it = begin; it != end; it++)
+            {
+                const float* p = position(*it);
+                Cell& cell = cells[cellOf(*it)];
+                const float inverseCount = 1.0f / static_cast<float>(cell.count);
+                const float dx = p[0] - cell.sumX * inverseCount, dy = p[1] - cell.sumY * inverseCount, dz = p[2] - cell.sumZ * inverseCount;
+                const float distance = dx * dx + dy * dy + dz * dz;
+                if (distance < cell.distance)
+                {
+                    cell.distance = distance;
+                    cell.vertex = *it;
+                }
+            }
+
+            Range output = { static_cast<uint32_t>(outIndices.size()), 0 };
+            for (const uint32_t* it = begin; it + 3 <= end; it += 3)
+            {
+                const uint64_t a = cellOf(it[0]), b = cellOf(it[1]), c = cellOf(it[2]);
+                if (a == b || b == c || a == c)
+                    continue;
+
+                const std::array<uint32_t, 3> triangle = { cells[a].vertex, cells[b].vertex, cells[c].vertex };
+                // The same cells seen from another triangle, in any rotation
+                std::array<uint32_t, 3> key = triangle;
+                std::rotate(key.begin(), std::min_element(key.begin(), key.end()), key.end());
+                if (!emitted.insert(key).second)
+                    continue;
+
+                outIndices.insert(outIndices.end(), triangle.begin(), triangle.end());
+            }
+            output.count = static_cast<uint32_t>(outIndices.size()) - output.startIndex;
+            outRanges.push_back(output);
+        }
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <galaxymath/Maths.h>
+
+// Import time simplification by vertex clustering: vertices are snapped to a grid over the mesh bounds,
+// each cell keeps the existing vertex nearest to the mean of the cell, and the triangles that collapse are dropped.
+// The result only references vertices of the input, so a LOD is an index range in the same buffers.
+namespace MeshSimplifier
+{
+    // Triangle list range of the input, in indices
+    struct Range
+    {
+        uint32_t startIndex;
+        uint32_t count;
+    };
+
+    // Simplifies each range of indices on its own, so materials keep their triangles.
+    // cellsPerAxis cells along the longest side of boundsMin / boundsMax. Appends to outIndices and
+    // writes the output range of each input range to outRanges.
+    void Cluster(const float* vertices, size_t floatsPerVertex, const uint32_t* indices, const std::vector<Range>& ranges,
+                 const Vec3f& boundsMin, const Vec3f& boundsMax, uint32_t cellsPerAxis,
+                 std::vector<uint32_t>& outIndices, std::vector<Range>& outRanges);
+}
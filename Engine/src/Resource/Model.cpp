@@ -1,10 +1,10 @@
 ﻿#include "Model.h"
 
+#include "Material.h"
 #include "Mesh.h"
 #include "ResourceManager.h"
 
 #include "Component/MeshComponent.h"
-#include "Core/Engine.h"
 
 #include "Loader/OBJLoader.h"
 
@@ -94,6 +94,7 @@ bool Model::Load(ResourceManager* resourceManager)
                 meshResource->m_indices.push_back(idx.y);
                 meshResource->m_indices.push_back(idx.z);
             }
+            meshResource->GenerateLods();
             meshResource->SetLoaded();
             ASSERT(!meshResource->m_vertices.empty())
             resourceManager->AddResourceToSend(meshResource.getPtr());
@@ -107,7 +108,7 @@ bool Model::Load(ResourceManager* resourceManager)
     }
 }
 
-bool Model::SendToGPU(VulkanRenderer* renderer)
+bool Model::SendToGPU(IRenderer* renderer)
 {
     UNUSED(renderer);
     return true;
@@ -119,28 +120,74 @@ void Model::Unload()
 
 SafePtr<GameObject> Model::CreateGameObject(Model* model, Scene* scene)
 {
-    auto resourceManager = Engine::Get()->GetResourceManager();
-    SafePtr<GameObject> go = scene->CreateGameObject();
-    go->SetName(model->GetName());
-	size_t materialIndex = 0;
+    std::vector<SafePtr<GameObject>> instances = Instantiate(model, scene, 1);
+    return instances.empty() ? SafePtr<GameObject>() : instances.front();
+}
+
+std::vector<SafePtr<GameObject>> Model::Instantiate(Model* model, Scene* scene, size_t count, GameObject* parent)
+{
+    std::vector<SafePtr<GameObject>> instances;
+    if (count == 0)
+        return instances;
+    // The objects would only exist after the next flush, there would be nothing to name nor to return
+    if (ComponentScheduler::IsUpdating())
+    {
+        PrintError("Cannot instantiate model %s during a component update", model->GetName().c_str());
+        return instances;
+    }
+
+    // Same for every instance, resolved once
+    struct MeshData
+    {
+        std::string name;
+        SafePtr<Mesh> mesh;
+        std::vector<SafePtr<Material>> materials;
+    };
+
+    const std::string name = model->GetName();
+    const ResourceManager* resourceManager = scene->GetResourceManager();
+    const SafePtr<Material> defaultMaterial = resourceManager ? resourceManager->GetDefaultMaterial() : SafePtr<Material>();
+    std::vector<MeshData> meshes(model->m_meshes.size());
+    size_t materialIndex = 0;
     for (size_t i = 0; i < model->m_meshes.size(); i++)
     {
-        SafePtr<GameObject> child = scene->CreateGameObject(go.getPtr());
-        child->SetName(model->m_meshes[i]->GetName());
-        SafePtr<MeshComponent> meshComp = child->AddComponent<MeshComponent>();
-        auto subMeshes = model->m_meshes[i]->GetSubMeshes();
-        for (size_t j = 0; j < subMeshes.size(); j++)
+        MeshData& meshData = meshes[i];
+        meshData.name = model->m_meshes[i]->GetName();
+        meshData.mesh = model->m_meshes[i];
+        const size_t subMeshCount = model->m_meshes[i]->GetSubMeshes().size();
+        for (size_t j = 0; j < subMeshCount; j++)
         {
             if (materialIndex >= model->m_materials.size())
             {
-                meshComp->AddMaterial(resourceManager->GetDefaultMaterial());
+                meshData.materials.push_back(defaultMaterial);
                 continue;
             }
-            meshComp->AddMaterial(model->m_materials[materialIndex++].get());
+            meshData.materials.push_back(model->m_materials[materialIndex++]);
         }
-        meshComp->SetMesh(model->m_meshes[i]);
     }
-    return go;
+
+    instances.reserve(count);
+    scene->ReserveGameObjects(count * (meshes.size() + 1));
+    scene->ReserveComponents<MeshComponent>(count * meshes.size());
+    scene->Batch([&]()
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            SafePtr<GameObject> instance = scene->CreateGameObject(parent);
+            GameObject* go = instance.getPtr();
+            go->SetName(name);
+            for (const MeshData& meshData : meshes)
+            {
+                GameObject* child = scene->CreateGameObject(go).getPtr();
+                child->SetName(meshData.name);
+                MeshComponent* meshComp = child->AddComponent<MeshComponent>().getPtr();
+                meshComp->SetMaterials(meshData.materials);
+                meshComp->SetMesh(meshData.mesh);
+            }
+            instances.push_back(std::move(instance));
+        }
+    });
+    return instances;
 }
 
 void Model::ComputeBoundingBox(const std::vector<std::vector<Vec3f>>& positionVertices)
@@ -16,12 +16,14 @@ class Model : public IResource
     DECLARE_RESOURCE_TYPE(Model)
 
     bool Load(ResourceManager* resourceManager) override;
-    bool SendToGPU(VulkanRenderer* renderer) override;
+    bool SendToGPU(IRenderer* renderer) override;
     void Unload() override;
     
     const std::vector<SafePtr<Mesh>>& GetMeshes() const { return m_meshes; }
     
     static SafePtr<GameObject> CreateGameObject(Model* model, Scene* scene);
+    // count copies under parent (the root by default), created in one batch. Not from a component update, returns nothing.
+    static std::vector<SafePtr<GameObject>> Instantiate(Model* model, Scene* scene, size_t count, GameObject* parent = nullptr);
 
 private:
     void ComputeBoundingBox(const std::vector<std::vector<Vec3f>>& positionVertices);
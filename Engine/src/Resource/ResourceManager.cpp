@@ -12,13 +12,13 @@
 #include "Mesh.h"
 #include "VertexShader.h"
 
-#include "Render/Vulkan/VulkanRenderer.h"
+#include "Render/IRenderer.h"
 
 #include "Utils/File.h"
 
 class Shader;
 
-void ResourceManager::Initialize(VulkanRenderer* renderer)
+void ResourceManager::Initialize(IRenderer* renderer)
 {
     m_renderer = renderer;
     CreateCacheDir();
@@ -43,6 +43,19 @@ bool ResourceManager::Contains(const Core::UUID& uuid) const
 
 void ResourceManager::AddResource(const Core::UUID& uuid, const std::shared_ptr<IResource>& resource, Hash hash)
 {
+    {
+        std::scoped_lock lock(m_mutex);
+        // First, a full pool throws before anything is replaced
+        if (resource && !resource->p_handle)
+            resource->p_handle = m_resourceHandles.Add(resource.get());
+        // A replaced resource must not stay resolvable
+        auto it = m_resources.find(uuid);
+        if (it != m_resources.end() && it->second && it->second != resource)
+        {
+            m_resourceHandles.Remove(it->second->p_handle);
+            it->second->p_handle = {};
+        }
+    }
     m_resources[uuid] = resource;
     m_hashToUUID[hash] = uuid;
 }
@@ -52,6 +65,12 @@ void ResourceManager::RemoveResource(Core::UUID uuid)
     auto it = m_resources.find(uuid);
     if (it != m_resources.end())
     {
+        if (it->second)
+        {
+            std::scoped_lock lock(m_mutex);
+            m_resourceHandles.Remove(it->second->p_handle);
+            it->second->p_handle = {};
+        }
         m_resources.erase(it);
     }
 }
@@ -156,6 +175,10 @@ void ResourceManager::Clear()
         if (!resource)
             continue;
         resource->Unload();
+
+        std::scoped_lock lock(m_mutex);
+        m_resourceHandles.Remove(resource->p_handle);
+        resource->p_handle = {};
     }
     m_resources.clear();
     m_hashToUUID.clear();
@@ -17,14 +17,14 @@
 class Material;
 class Shader;
 class Texture;
-class VulkanRenderer;
+class IRenderer;
 
 class ResourceManager
 {
 public:
     ResourceManager() = default;
 
-    void Initialize(VulkanRenderer* renderer);
+    void Initialize(IRenderer* renderer);
 
     Core::UUID GetUUID(const std::filesystem::path& resourcePath) const;
 
@@ -40,6 +40,10 @@ class ResourceManager
     
     bool Contains(const Core::UUID& uuid) const;
 
+    // Non-owning and lock free, for per-frame code
+    template<typename T>
+    T* Resolve(Handle<T> handle) const;
+
     template<typename T>
     SafePtr<T> AddResource(std::shared_ptr<T> resource);
 
@@ -90,8 +94,10 @@ class ResourceManager
     static void CreateCacheDir();
 
 private:
-    VulkanRenderer* m_renderer;
+    IRenderer* m_renderer;
     std::unordered_map<Core::UUID, std::shared_ptr<IResource>> m_resources;
+    // Written under m_mutex
+    HandlePool<IResource> m_resourceHandles;
     std::unordered_map<Hash, Core::UUID> m_hashToUUID;
     std::queue<Core::UUID> m_resourceToSend;
     std::mutex m_mutex;
@@ -140,6 +146,13 @@ std::vector<std::shared_ptr<T>> ResourceManager::GetAll() const
     return resources;
 }
 
+template<typename T>
+T* ResourceManager::Resolve(Handle<T> handle) const
+{
+    static_assert(std::is_base_of_v<IResource, T>, "T must inherit from IResource");
+    return static_cast<T*>(m_resourceHandles.Get(handle));
+}
+
 template<typename T>
 SafePtr<T> ResourceManager::AddResource(std::shared_ptr<T> resource)
 {
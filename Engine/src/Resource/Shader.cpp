@@ -7,7 +7,7 @@
 
 #include "Debug/Log.h"
 
-#include "Render/Vulkan/VulkanRenderer.h"
+#include "Render/IRenderer.h"
 
 #include "Utils/File.h"
 
@@ -54,7 +54,7 @@ bool BaseShader::Load(ResourceManager* resourceManager)
     return true;
 }
 
-bool BaseShader::SendToGPU(VulkanRenderer* renderer)
+bool BaseShader::SendToGPU(IRenderer* renderer)
 {
     if (!p_buffer)
     {
@@ -181,7 +181,7 @@ bool Shader::Load(ResourceManager* resourceManager)
     return true;
 }
 
-bool Shader::SendToGPU(VulkanRenderer* renderer)
+bool Shader::SendToGPU(IRenderer* renderer)
 {
     if (m_graphic && (!m_vertexShader->SentToGPU() || !m_fragmentShader->SentToGPU()) 
         || !m_graphic && (!m_computeShader->SentToGPU()))
@@ -199,17 +199,17 @@ void Shader::Unload()
 {
 }
 
-void Shader::SendTexture(UBOBinding binding, Texture* texture, VulkanRenderer* renderer)
+void Shader::SendTexture(UBOBinding binding, Texture* texture, IRenderer* renderer)
 {
     renderer->SendTexture(binding, texture, this);
 }
 
-void Shader::SendValue(UBOBinding binding, void* value, uint32_t size, VulkanRenderer* renderer)
+void Shader::SendValue(UBOBinding binding, void* value, uint32_t size, IRenderer* renderer)
 {
     renderer->SendValue(binding, value, size, this);
 }
 
-std::unique_ptr<ComputeDispatch> Shader::CreateDispatch(VulkanRenderer* renderer)
+std::unique_ptr<ComputeDispatch> Shader::CreateDispatch(IRenderer* renderer)
 {
     return std::move(renderer->CreateDispatch(this));
 }
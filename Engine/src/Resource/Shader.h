@@ -29,7 +29,7 @@ class BaseShader : public IResource
     virtual ~BaseShader() override;
     
     virtual bool Load(ResourceManager* resourceManager) override;
-    virtual bool SendToGPU(VulkanRenderer* renderer) override;
+    virtual bool SendToGPU(IRenderer* renderer) override;
     virtual void Unload() override {}
     
     virtual ResourceType GetResourceType() const override = 0;
@@ -135,7 +135,7 @@ class Shader : public IResource
     DECLARE_RESOURCE_TYPE(Shader)
     
     bool Load(ResourceManager* resourceManager) override;
-    bool SendToGPU(VulkanRenderer* renderer) override;
+    bool SendToGPU(IRenderer* renderer) override;
     void Unload() override;
 
     PushConstants GetPushConstants() const {return m_pushConstants;}
@@ -146,8 +146,8 @@ class Shader : public IResource
     FragmentShader* GetFragmentShader() const { return m_fragmentShader.getPtr(); }
     ComputeShader* GetComputeShader() const { return m_computeShader.getPtr(); }
     
-    void SendTexture(UBOBinding binding, Texture* texture, VulkanRenderer* renderer);
-    void SendValue(UBOBinding binding, void* value, uint32_t size, VulkanRenderer* renderer);
+    void SendTexture(UBOBinding binding, Texture* texture, IRenderer* renderer);
+    void SendValue(UBOBinding binding, void* value, uint32_t size, IRenderer* renderer);
     
     VulkanPipeline* GetPipeline() const { return m_pipeline.get(); }
     
@@ -155,7 +155,7 @@ class Shader : public IResource
     
     Topology GetTopology() const { return m_topology; }
     
-    std::unique_ptr<ComputeDispatch> CreateDispatch(VulkanRenderer* renderer);
+    std::unique_ptr<ComputeDispatch> CreateDispatch(IRenderer* renderer);
     
 private:
     SafePtr<VertexShader> m_vertexShader;
@@ -9,7 +9,7 @@ class Texture : public IResource
     DECLARE_RESOURCE_TYPE(Texture)
 
     bool Load(ResourceManager* resourceManager) override;
-    bool SendToGPU(VulkanRenderer* renderer) override;
+    bool SendToGPU(IRenderer* renderer) override;
     void Unload() override;
     
     VulkanTexture* GetBuffer() const { return m_buffer.get(); }
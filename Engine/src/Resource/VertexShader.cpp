@@ -7,7 +7,7 @@ bool VertexShader::Load(ResourceManager* resourceManager)
     return BaseShader::Load(resourceManager);
 }
 
-bool VertexShader::SendToGPU(VulkanRenderer* renderer)
+bool VertexShader::SendToGPU(IRenderer* renderer)
 {
     return BaseShader::SendToGPU(renderer);
 }
@@ -13,7 +13,7 @@ class VertexShader : public BaseShader
     virtual ~VertexShader() override = default;
     
     bool Load(ResourceManager* resourceManager) override;
-    bool SendToGPU(VulkanRenderer* renderer) override;
+    bool SendToGPU(IRenderer* renderer) override;
     void Unload() override;
     
     ResourceType GetResourceType() const override { return ResourceType::VertexShader; }
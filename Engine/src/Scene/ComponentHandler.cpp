@@ -1 +1,53 @@
 ﻿#include "ComponentHandler.h"
+
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    // Shared by every register, a function static so that IDs can be given during static initialization
+    struct TypeTable
+    {
+        std::mutex mutex;
+        std::array<ComponentTypeHash, MaxComponentTypes> hashes = {};
+        std::array<const char*, MaxComponentTypes> names = {};
+        size_t count = 0;
+    };
+
+    TypeTable& GetTypeTable()
+    {
+        static TypeTable table;
+        return table;
+    }
+}
+
+size_t ComponentRegister::GetTypeCount()
+{
+    TypeTable& table = GetTypeTable();
+    std::scoped_lock lock(table.mutex);
+    return table.count;
+}
+
+ComponentID ComponentRegister::AssignID(ComponentTypeHash hash, const char* name)
+{
+    TypeTable& table = GetTypeTable();
+    std::scoped_lock lock(table.mutex);
+    for (size_t i = 0; i < table.count; i++)
+    {
+        if (table.hashes[i] != hash)
+            continue;
+        // Sharing the ID would store one type as the other
+        if (std::strcmp(table.names[i], name) != 0)
+            throw std::runtime_error(std::string("Component types ") + table.names[i] + " and " + name + " have the same hash");
+        return i;
+    }
+
+    // Every ID is a bit of ComponentMask
+    if (table.count >= MaxComponentTypes)
+        throw std::runtime_error(std::string("Too many component types to add ") + name);
+    table.hashes[table.count] = hash;
+    table.names[table.count] = name;
+    return table.count++;
+}
@@ -1,18 +1,45 @@
 ﻿#pragma once
+#include <array>
+#include <bitset>
 #include <memory>
-#include <unordered_map>
 #include <type_traits>
+#include <string_view>
 #include <cstdint>
 
 #include "Component/IComponent.h"
 
+// Dense index of a component type in the running program, given on registration or first use
+using ComponentID = uint64_t;
+// Same in every run and build, hashed from the type name
+using ComponentTypeHash = uint64_t;
+
+// FNV-1a
+constexpr ComponentTypeHash HashComponentName(std::string_view name)
+{
+    ComponentTypeHash hash = 14695981039346656037ull;
+    for (const char c : name)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
 struct ComponentTypeInfo
 {
+    ComponentID id;
+    ComponentTypeHash hash;
+    const char* name;
     std::unique_ptr<IComponent> (*Create)();
     void (*Describe)(IComponent*, ClassDescriptor&);
+    // Adds a component of this type to the GameObject through its scene
+    IComponent* (*AddTo)(GameObject*);
 };
 
-using ComponentID = uint64_t;
+// One bit per component type, indexed by ComponentID
+constexpr size_t MaxComponentTypes = 64;
+using ComponentMask = std::bitset<MaxComponentTypes>;
+
 class ComponentRegister
 {
 public:
@@ -24,30 +51,115 @@ class ComponentRegister
         ComponentID id = GetComponentID<T>();
 
         m_types[id] = {
+            id,
+            GetTypeHash<T>(),
+            T::StaticTypeName(),
             []() -> std::unique_ptr<IComponent> {
                 return std::make_unique<T>();
             },
             [](IComponent* c, ClassDescriptor& d) {
                 static_cast<T*>(c)->Describe(d);
-            }
+            },
+            &AddComponentTo<T>
         };
+        m_registered.set(id);
     }
 
     const ComponentTypeInfo* Get(ComponentID id) const
     {
-        auto it = m_types.find(id);
-        return it != m_types.end() ? &it->second : nullptr;
+        return id < MaxComponentTypes && m_registered.test(id) ? &m_types[id] : nullptr;
     }
 
+    // Lookup by GetTypeHash, for data that refers to types across runs
+    const ComponentTypeInfo* Find(ComponentTypeHash hash) const
+    {
+        for (ComponentID id = 0; id < MaxComponentTypes; id++)
+        {
+            if (m_registered.test(id) && m_types[id].hash == hash)
+                return &m_types[id];
+        }
+        return nullptr;
+    }
+
+    // Lookup by GetTypeName
+    const ComponentTypeInfo* Find(std::string_view name) const { return Find(HashComponentName(name)); }
+
+    template<typename T>
+    static constexpr ComponentTypeHash GetTypeHash()
+    {
+        return HashComponentName(T::StaticTypeName());
+    }
+
+    // Registering the types at startup keeps their IDs the same between runs
     template<typename T>
     static ComponentID GetComponentID()
     {
-        static ComponentID id = s_nextID++;
+        static const ComponentID id = AssignID(GetTypeHash<T>(), T::StaticTypeName());
         return id;
     }
 
+    // Types that received an ID, registered or not
+    static size_t GetTypeCount();
+
+private:
+    // Defined in GameObject.h, which must be included where components are registered
+    template<typename T>
+    static IComponent* AddComponentTo(GameObject* gameObject);
+
+    // Thread safe, the next free index for a new hash. Throws on a hash of another name or past MaxComponentTypes.
+    static ComponentID AssignID(ComponentTypeHash hash, const char* name);
+
 private:
-    std::unordered_map<ComponentID, ComponentTypeInfo> m_types;
-    inline static ComponentID s_nextID = 0;
+    // Indexed by ComponentID, set for the registered types
+    std::array<ComponentTypeInfo, MaxComponentTypes> m_types = {};
+    ComponentMask m_registered;
 };
 
+// Declared by a component type through its static DescribeUpdate.
+// Types that don't declare anything run alone on the main thread.
+struct ComponentUpdateInfo
+{
+    ComponentMask reads;
+    ComponentMask writes;
+    // OnUpdate of different instances may run concurrently
+    bool parallel = false;
+    // Seconds wanted between two OnUpdate of one instance, 0 for every frame
+    float interval = 0.0f;
+    // Instances scale their update rate by IComponent::GetSignificance
+    bool significance = false;
+
+    template<typename T>
+    ComponentUpdateInfo& Read()
+    {
+        reads.set(ComponentRegister::GetComponentID<T>());
+        return *this;
+    }
+
+    template<typename T>
+    ComponentUpdateInfo& Write()
+    {
+        writes.set(ComponentRegister::GetComponentID<T>());
+        return *this;
+    }
+
+    ComponentUpdateInfo& Parallel()
+    {
+        parallel = true;
+        return *this;
+    }
+
+    ComponentUpdateInfo& Interval(float seconds)
+    {
+        interval = seconds;
+        return *this;
+    }
+
+    ComponentUpdateInfo& Significance()
+    {
+        significance = true;
+        return *this;
+    }
+
+    // Updated at their own rate, spread across frames and limited by the scheduler budget
+    bool IsBudgeted() const { return interval > 0.0f || significance; }
+};
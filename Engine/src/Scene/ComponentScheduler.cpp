@@ -0,0 +1,273 @@
+#include "ComponentScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+
+#include "Core/ThreadPool.h"
+
+namespace
+{
+    // Weight of the last frame in the cost estimate of a budgeted type
+    constexpr double CostSmoothing = 0.1;
+}
+
+void ComponentScheduler::Run(std::vector<ComponentArray>& components, float deltaTime)
+{
+    if (m_dirty)
+        Build(components);
+
+    s_updating = true;
+    Select(components, deltaTime);
+
+    for (const Stage& stage : m_stages)
+    {
+        // Sizes change between frames, the blocks are recomputed per stage
+        m_workItems.clear();
+        for (ComponentID id : stage.types)
+        {
+            if (components[id].traits.update.IsBudgeted())
+            {
+                const std::vector<IComponent*>& selected = m_budgetStates[id].selected;
+                AddWorkItems(id, selected.data(), selected.size(), true);
+            }
+            else
+            {
+                AddWorkItems(id, components[id].components.data(), components[id].Size(), false);
+            }
+        }
+
+        if (!stage.parallel)
+        {
+            for (WorkItem& item : m_workItems)
+            {
+                RunWorkItem(item, deltaTime);
+            }
+        }
+        else
+        {
+            ThreadPool::ParallelFor(m_workItems.size(), [this, deltaTime](size_t begin, size_t end)
+            {
+                // The calling thread runs a block too and is already flagged
+                const bool wasUpdating = s_updating;
+                s_updating = true;
+                for (size_t i = begin; i < end; i++)
+                {
+                    RunWorkItem(m_workItems[i], deltaTime);
+                }
+                s_updating = wasUpdating;
+            });
+        }
+
+        for (const WorkItem& item : m_workItems)
+        {
+            if (item.budgeted)
+                m_budgetStates[item.id].nanoseconds += item.nanoseconds;
+        }
+    }
+    s_updating = false;
+
+    Measure();
+}
+
+void ComponentScheduler::Build(const std::vector<ComponentArray>& components)
+{
+    m_stages.clear();
+    m_budgetedTypes.clear();
+    // Keeps the measured costs of the known types
+    m_budgetStates.resize(components.size());
+    m_dirty = false;
+
+    // Stage index of every scheduled type, in ComponentID order to keep the serial update order
+    std::vector<std::pair<ComponentID, size_t>> scheduled;
+    for (ComponentID id = 0; id < components.size(); id++)
+    {
+        const ComponentArray& array = components[id];
+        if (!array.initialized || !array.traits.hasUpdate)
+            continue;
+
+        const ComponentUpdateInfo& info = array.traits.update;
+        if (info.IsBudgeted())
+            m_budgetedTypes.push_back(id);
+
+        // Goes right after the last stage it conflicts with.
+        // Exclusive types conflict with everything, they always end up in a stage of their own.
+        size_t stageIndex = 0;
+        for (const auto& [otherId, otherStage] : scheduled)
+        {
+            if (Conflicts(id, info, otherId, components[otherId].traits.update))
+                stageIndex = std::max(stageIndex, otherStage + 1);
+        }
+
+        if (stageIndex >= m_stages.size())
+            m_stages.resize(stageIndex + 1);
+
+        m_stages[stageIndex].types.push_back(id);
+        m_stages[stageIndex].parallel = info.parallel;
+        scheduled.emplace_back(id, stageIndex);
+    }
+}
+
+void ComponentScheduler::Select(std::vector<ComponentArray>& components, float deltaTime)
+{
+    m_stats = BudgetStats();
+    m_candidates.clear();
+
+    for (ComponentID id : m_budgetedTypes)
+    {
+        ComponentArray& array = components[id];
+        const ComponentUpdateInfo& info = array.traits.update;
+        BudgetState& state = m_budgetStates[id];
+        state.selected.clear();
+        state.nanoseconds = 0;
+
+        // An interval shorter than the frame is one frame
+        const float interval = std::max(info.interval, deltaTime);
+        if (interval <= 0.0f)
+            continue;
+
+        // GetSignificance is user code, run like the updates. A negative priority marks a disabled instance.
+        m_priorities.resize(array.Size());
+        ThreadPool::ParallelFor(array.Size(), [&](size_t begin, size_t end)
+        {
+            const bool wasUpdating = s_updating;
+            s_updating = true;
+            for (size_t i = begin; i < end; i++)
+            {
+                IComponent* component = array.components[i];
+                if (!component->IsEnable())
+                {
+                    m_priorities[i] = -1.0f;
+                    continue;
+                }
+                // New instances wait a part of the interval spread by the golden ratio before counting time,
+                // the ones created together do not all update on the same frame. The wait is never passed to OnUpdate.
+                if (component->m_updateDelay < 0.0f)
+                    component->m_updateDelay = interval * static_cast<float>(std::fmod(static_cast<double>(i) * 0.6180339887, 1.0));
+                if (component->m_updateDelay > 0.0f)
+                {
+                    component->m_updateDelay = std::max(component->m_updateDelay - deltaTime, 0.0f);
+                    m_priorities[i] = 0.0f;
+                    continue;
+                }
+                component->m_updateElapsed += deltaTime;
+
+                const float significance = info.significance ? std::clamp(component->GetSignificance(m_viewPosition), MinSignificance, 1.0f) : 1.0f;
+                m_priorities[i] = component->m_updateElapsed * significance / interval;
+            }
+            s_updating = wasUpdating;
+        }, BlockSize);
+
+        for (size_t i = 0; i < array.Size(); i++)
+        {
+            if (m_priorities[i] < 0.0f)
+                continue;
+            m_stats.instances++;
+            if (m_priorities[i] >= 1.0f)
+                m_candidates.push_back({ array.components[i], id, m_priorities[i] });
+        }
+    }
+    m_stats.due = m_candidates.size();
+
+    if (m_budget <= 0.0)
+    {
+        for (const Candidate& candidate : m_candidates)
+        {
+            m_budgetStates[candidate.id].selected.push_back(candidate.component);
+            m_stats.estimate += m_budgetStates[candidate.id].cost;
+        }
+        m_stats.updated = m_candidates.size();
+        return;
+    }
+
+    // Most overdue first, the ones left keep their elapsed time and come first next frame.
+    // The first one always runs, so that a budget smaller than one update does not stall everything.
+    std::ranges::sort(m_candidates, std::greater(), &Candidate::priority);
+    for (const Candidate& candidate : m_candidates)
+    {
+        BudgetState& state = m_budgetStates[candidate.id];
+        if (m_stats.updated > 0 && m_stats.estimate + state.cost > m_budget)
+            continue;
+        state.selected.push_back(candidate.component);
+        m_stats.estimate += state.cost;
+        m_stats.updated++;
+    }
+    // Back in memory order for the updates
+    for (ComponentID id : m_budgetedTypes)
+    {
+        std::ranges::sort(m_budgetStates[id].selected, std::less(), &IComponent::m_storageIndex);
+    }
+}
+
+void ComponentScheduler::Measure()
+{
+    for (ComponentID id : m_budgetedTypes)
+    {
+        BudgetState& state = m_budgetStates[id];
+        if (state.selected.empty())
+            continue;
+
+        const double time = static_cast<double>(state.nanoseconds) / 1000000.0;
+        const double cost = time / static_cast<double>(state.selected.size());
+        state.cost = state.cost > 0.0 ? state.cost + (cost - state.cost) * CostSmoothing : cost;
+        m_stats.time += time;
+    }
+}
+
+void ComponentScheduler::AddWorkItems(ComponentID id, IComponent* const* components, size_t count, bool budgeted)
+{
+    for (size_t begin = 0; begin < count; begin += BlockSize)
+    {
+        m_workItems.push_back({ components + begin, std::min(BlockSize, count - begin), id, budgeted, 0 });
+    }
+}
+
+void ComponentScheduler::RunWorkItem(WorkItem& item, float deltaTime)
+{
+    if (!item.budgeted)
+    {
+        UpdateRange(item.components, item.count, deltaTime, false);
+        return;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    UpdateRange(item.components, item.count, deltaTime, true);
+    item.nanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+bool ComponentScheduler::Conflicts(ComponentID a, const ComponentUpdateInfo& infoA, ComponentID b, const ComponentUpdateInfo& infoB)
+{
+    if (!infoA.parallel || !infoB.parallel)
+        return true;
+
+    // A type always writes to itself
+    ComponentMask writesA = infoA.writes;
+    ComponentMask writesB = infoB.writes;
+    writesA.set(a);
+    writesB.set(b);
+
+    return (writesA & (infoB.reads | writesB)).any() || (writesB & infoA.reads).any();
+}
+
+void ComponentScheduler::UpdateRange(IComponent* const* components, size_t count, float deltaTime, bool budgeted)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        IComponent* component = components[i];
+        if (!component->IsEnable())
+            continue;
+
+        // Budgeted instances get the time since their last update
+        if (budgeted)
+        {
+            component->OnUpdate(component->m_updateElapsed);
+            component->m_updateElapsed = 0.0f;
+        }
+        else
+        {
+            component->OnUpdate(deltaTime);
+        }
+    }
+}
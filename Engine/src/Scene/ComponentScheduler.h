@@ -0,0 +1,107 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include <galaxymath/Maths.h>
+
+#include "ComponentHandler.h"
+#include "ComponentStorage.h"
+
+// Budgeted updates of the last frame
+struct BudgetStats
+{
+    // Enabled instances of the budgeted types, the ones due this frame and the ones updated
+    size_t instances = 0;
+    size_t due = 0;
+    size_t updated = 0;
+    // Measured and estimated update time, in milliseconds summed over the threads
+    double time = 0.0;
+    double estimate = 0.0;
+};
+
+// Runs OnUpdate of every component type, grouped in stages from the declared reads and writes.
+// Types in one stage touch disjoint data and run together on the thread pool,
+// a stage starts once the previous one is done.
+// Types declaring an interval or a significance are budgeted: each instance updates when its own time is due,
+// the most overdue first, until the estimated cost of the frame reaches the budget.
+class ComponentScheduler
+{
+public:
+    // Components are split in blocks of this size when dispatched
+    static constexpr size_t BlockSize = 256;
+    // Lowest significance used, so that far instances still update now and then
+    static constexpr float MinSignificance = 0.01f;
+
+    // Must be rebuilt when a new component type appears in the scene
+    void Invalidate() { m_dirty = true; }
+    void Run(std::vector<ComponentArray>& components, float deltaTime);
+
+    // Update time of the budgeted types per frame, in milliseconds summed over the threads. 0 for no limit.
+    void SetBudget(double milliseconds) { m_budget = milliseconds; }
+    double GetBudget() const { return m_budget; }
+    // Passed to IComponent::GetSignificance
+    void SetViewPosition(const Vec3f& position) { m_viewPosition = position; }
+    const BudgetStats& GetBudgetStats() const { return m_stats; }
+
+    // True on the threads running component updates, structural changes from them are deferred to a SceneCommandBuffer
+    static bool IsUpdating() { return s_updating; }
+
+private:
+    struct Stage
+    {
+        std::vector<ComponentID> types;
+        bool parallel = true;
+    };
+
+    struct WorkItem
+    {
+        IComponent* const* components;
+        size_t count;
+        ComponentID id;
+        bool budgeted;
+        // Written by the one thread running the item, budgeted types only
+        uint64_t nanoseconds;
+    };
+
+    // Per budgeted type
+    struct BudgetState
+    {
+        // Instances picked for this frame
+        std::vector<IComponent*> selected;
+        // Smoothed cost of one OnUpdate, in milliseconds, 0 until measured
+        double cost = 0.0;
+        uint64_t nanoseconds = 0;
+    };
+
+    struct Candidate
+    {
+        IComponent* component;
+        ComponentID id;
+        // Elapsed time over the wanted interval, due from 1
+        float priority;
+    };
+
+    void Build(const std::vector<ComponentArray>& components);
+    void Select(std::vector<ComponentArray>& components, float deltaTime);
+    void Measure();
+    void AddWorkItems(ComponentID id, IComponent* const* components, size_t count, bool budgeted);
+    void RunWorkItem(WorkItem& item, float deltaTime);
+    static bool Conflicts(ComponentID a, const ComponentUpdateInfo& infoA, ComponentID b, const ComponentUpdateInfo& infoB);
+    static void UpdateRange(IComponent* const* components, size_t count, float deltaTime, bool budgeted);
+
+private:
+    std::vector<Stage> m_stages;
+    std::vector<WorkItem> m_workItems;
+    bool m_dirty = true;
+
+    // Indexed by ComponentID, budgeted types only are selected and measured
+    std::vector<BudgetState> m_budgetStates;
+    std::vector<ComponentID> m_budgetedTypes;
+    std::vector<Candidate> m_candidates;
+    std::vector<float> m_priorities;
+    double m_budget = 0.0;
+    Vec3f m_viewPosition;
+    BudgetStats m_stats;
+
+    inline static thread_local bool s_updating = false;
+};
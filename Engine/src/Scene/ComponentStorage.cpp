@@ -0,0 +1,137 @@
+﻿#include "ComponentStorage.h"
+
+#include <algorithm>
+#include <new>
+
+ChunkAllocator::~ChunkAllocator()
+{
+    for (std::byte* chunk : m_chunks)
+    {
+        ::operator delete(chunk, std::align_val_t(CacheLineSize));
+    }
+}
+
+void* ChunkAllocator::Allocate()
+{
+    if (!m_freeList)
+        AllocateChunk();
+
+    void* slot = m_freeList;
+    m_freeList = *static_cast<void**>(slot);
+    return slot;
+}
+
+void ChunkAllocator::Deallocate(void* ptr)
+{
+    *static_cast<void**>(ptr) = m_freeList;
+    m_freeList = ptr;
+}
+
+void ChunkAllocator::AllocateChunk()
+{
+    auto chunk = static_cast<std::byte*>(::operator new(m_slotSize * SlotsPerChunk, std::align_val_t(CacheLineSize)));
+    m_chunks.push_back(chunk);
+
+    // Thread the free list from the back so the slots are handed out in address order
+    for (size_t i = SlotsPerChunk; i-- > 0;)
+    {
+        void* slot = chunk + i * m_slotSize;
+        *static_cast<void**>(slot) = m_freeList;
+        m_freeList = slot;
+    }
+}
+
+void* ComponentArena::Allocate(ComponentID pool, size_t size, size_t alignment)
+{
+    if (alignment > ChunkAllocator::CacheLineSize)
+        return ::operator new(size, std::align_val_t(alignment));
+
+    const size_t slotSize = GetSlotSize(size, alignment);
+
+    std::scoped_lock lock(m_mutex);
+    std::unique_ptr<ChunkAllocator>& allocator = m_allocators[{ pool, slotSize }];
+    if (!allocator)
+        allocator = std::make_unique<ChunkAllocator>(slotSize);
+    return allocator->Allocate();
+}
+
+void ComponentArena::Deallocate(ComponentID pool, void* ptr, size_t size, size_t alignment)
+{
+    if (alignment > ChunkAllocator::CacheLineSize)
+    {
+        ::operator delete(ptr, std::align_val_t(alignment));
+        return;
+    }
+
+    std::scoped_lock lock(m_mutex);
+    m_allocators.at({ pool, GetSlotSize(size, alignment) })->Deallocate(ptr);
+}
+
+size_t ComponentArena::GetSlotSize(size_t size, size_t alignment)
+{
+    const size_t granularity = std::max<size_t>(alignment, 16);
+    size = std::max(size, sizeof(void*));
+    return (size + granularity - 1) / granularity * granularity;
+}
+
+void ComponentArray::Add(const std::shared_ptr<IComponent>& component)
+{
+    component->m_storageIndex = static_cast<uint32_t>(components.size());
+    components.push_back(component.get());
+    owners.push_back(component);
+}
+
+void ComponentArray::Reserve(size_t count)
+{
+    components.reserve(count);
+    owners.reserve(count);
+}
+
+void ComponentArray::RemoveAt(size_t index)
+{
+    if (index + 1 != components.size())
+    {
+        components[index] = components.back();
+        components[index]->m_storageIndex = static_cast<uint32_t>(index);
+        owners[index] = std::move(owners.back());
+    }
+    components.pop_back();
+    owners.pop_back();
+}
+
+void ComponentArray::RemoveMany(std::vector<uint32_t>& indices, std::vector<std::shared_ptr<IComponent>>& released)
+{
+    if (indices.empty())
+        return;
+    std::ranges::sort(indices);
+
+    // Swap and pop walks back to front so a moved component is never one still to remove
+    const size_t first = indices.front();
+    if (indices.size() * 4 < components.size() - first)
+    {
+        for (size_t i = indices.size(); i-- > 0;)
+        {
+            released.push_back(std::move(owners[indices[i]]));
+            RemoveAt(indices[i]);
+        }
+        return;
+    }
+
+    size_t next = 0;
+    size_t write = first;
+    for (size_t read = first; read < components.size(); read++)
+    {
+        if (next < indices.size() && indices[next] == read)
+        {
+            released.push_back(std::move(owners[read]));
+            next++;
+            continue;
+        }
+        components[write] = components[read];
+        components[write]->m_storageIndex = static_cast<uint32_t>(write);
+        owners[write] = std::move(owners[read]);
+        write++;
+    }
+    components.resize(write);
+    owners.resize(write);
+}
@@ -0,0 +1,151 @@
+﻿#pragma once
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ComponentHandler.h"
+#include "Component/IComponent.h"
+
+// Hands out fixed-size slots from contiguous, cache line aligned chunks.
+// Consecutive allocations of one slot size are laid out next to each other.
+class ChunkAllocator
+{
+public:
+    static constexpr size_t CacheLineSize = 64;
+    static constexpr size_t SlotsPerChunk = 256;
+
+    ChunkAllocator(size_t slotSize) : m_slotSize(slotSize) {}
+    ChunkAllocator(const ChunkAllocator&) = delete;
+    ChunkAllocator& operator=(const ChunkAllocator&) = delete;
+    ~ChunkAllocator();
+
+    void* Allocate();
+    void Deallocate(void* ptr);
+
+    size_t GetSlotSize() const { return m_slotSize; }
+private:
+    void AllocateChunk();
+private:
+    size_t m_slotSize;
+    std::vector<std::byte*> m_chunks;
+    void* m_freeList = nullptr;
+};
+
+// Component memory of one scene, one chunk allocator per component type (pool) and slot size,
+// so the components of one type fill their own chunks and are never interleaved with another type.
+// Deallocation may come from any thread (last SafePtr released), so access is serialized.
+class ComponentArena
+{
+public:
+    // Pool of the GameObjects, apart from every component type
+    static constexpr ComponentID GameObjectPool = ~ComponentID(0);
+
+    ComponentArena() = default;
+    ComponentArena(const ComponentArena&) = delete;
+    ComponentArena& operator=(const ComponentArena&) = delete;
+
+    void* Allocate(ComponentID pool, size_t size, size_t alignment);
+    void Deallocate(ComponentID pool, void* ptr, size_t size, size_t alignment);
+
+private:
+    static size_t GetSlotSize(size_t size, size_t alignment);
+
+private:
+    std::mutex m_mutex;
+    std::map<std::pair<ComponentID, size_t>, std::unique_ptr<ChunkAllocator>> m_allocators;
+};
+
+// Allocator used with std::allocate_shared so the component and its control block live in the arena.
+// The pool survives the rebind to the control block type. Every copy keeps the arena alive,
+// weak references can outlive the scene safely.
+template<typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    ArenaAllocator(std::shared_ptr<ComponentArena> arena, ComponentID pool) : m_arena(std::move(arena)), m_pool(pool) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : m_arena(other.m_arena), m_pool(other.m_pool) {}
+
+    T* allocate(size_t count)
+    {
+        return static_cast<T*>(m_arena->Allocate(m_pool, count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t count)
+    {
+        m_arena->Deallocate(m_pool, ptr, count * sizeof(T), alignof(T));
+    }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return m_arena == other.m_arena && m_pool == other.m_pool; }
+
+private:
+    template<typename U>
+    friend class ArenaAllocator;
+
+    std::shared_ptr<ComponentArena> m_arena;
+    ComponentID m_pool;
+};
+
+template<typename T>
+constexpr bool OverridesUpdate()
+{
+    return !std::is_same_v<decltype(&T::OnUpdate), decltype(&IComponent::OnUpdate)>;
+}
+
+template<typename T>
+constexpr bool OverridesRender()
+{
+    return !std::is_same_v<decltype(&T::OnRender), decltype(&IComponent::OnRender)>;
+}
+
+// What the scene needs to know about a component type to run it
+struct ComponentTraits
+{
+    bool hasUpdate = false;
+    bool hasRender = false;
+    ComponentUpdateInfo update;
+
+    template<typename T>
+    static ComponentTraits Of()
+    {
+        ComponentTraits traits;
+        traits.hasUpdate = OverridesUpdate<T>();
+        traits.hasRender = OverridesRender<T>();
+        T::DescribeUpdate(traits.update);
+        return traits;
+    }
+};
+
+// All components of one type.
+// Hot data (raw pointers walked every frame) is kept apart from cold data (ownership).
+struct ComponentArray
+{
+    std::vector<IComponent*> components;
+    std::vector<std::shared_ptr<IComponent>> owners;
+
+    ComponentTraits traits;
+    bool initialized = false;
+
+    size_t Size() const { return components.size(); }
+    bool Empty() const { return components.empty(); }
+
+    void Add(const std::shared_ptr<IComponent>& component);
+    void Reserve(size_t count);
+
+    // Swap and pop, the order of the components is not preserved
+    void RemoveAt(size_t index);
+    void Remove(const IComponent* component) { RemoveAt(component->m_storageIndex); }
+    // Removes every index at once and moves the owners to released, indices are sorted in place.
+    // Compacts the array in one pass when the removed components are a large part of it.
+    void RemoveMany(std::vector<uint32_t>& indices, std::vector<std::shared_ptr<IComponent>>& released);
+
+    const std::shared_ptr<IComponent>& GetOwner(const IComponent* component) const { return owners[component->m_storageIndex]; }
+};
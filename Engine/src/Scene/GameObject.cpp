@@ -2,16 +2,22 @@
 
 #include <utility>
 
-#include "Debug/Log.h"
-
 GameObject::GameObject(Scene& scene): m_scene(scene)
 {
     m_transform = AddComponent<TransformComponent>();
+    m_transformHandle = m_transform->GetHandle().Cast<TransformComponent>();
+}
+
+GameObject::~GameObject() = default;
+
+void GameObject::SetName(Name name)
+{
+    m_scene.SetGameObjectName(this, name);
 }
 
-GameObject::~GameObject()
+void GameObject::SetLayer(uint8_t layer)
 {
-    PrintLog("GameObject %s destroyed", m_name.c_str());
+    m_scene.SetGameObjectLayer(this, layer);
 }
 
 std::vector<SafePtr<IComponent>> GameObject::GetComponents() const
@@ -38,11 +44,18 @@ SafePtr<GameObject> GameObject::GetParent() const
 
 std::vector<SafePtr<GameObject>> GameObject::GetChildren() const
 {
+    std::scoped_lock lock(m_scene.m_gameObjectsMutex);
+
     std::vector<SafePtr<GameObject>> children;
-    children.reserve(m_childrenUUID.size());
-    for (auto& childUUID : m_childrenUUID)
+    for (TransformComponent* child : m_transform->GetChildTransforms())
     {
-        children.push_back(m_scene.GetGameObject(childUUID));
+        children.push_back(m_scene.GetGameObject(child->GetGameObject()->GetUUID()));
     }
     return children;
 }
+
+bool GameObject::HasChildren() const
+{
+    std::scoped_lock lock(m_scene.m_gameObjectsMutex);
+    return m_transform->HasChildren();
+}
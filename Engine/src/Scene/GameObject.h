@@ -1,6 +1,4 @@
 ﻿#pragma once
-#include <set>
-
 #include "Utils/Type.h"
 
 #include "Component/TransformComponent.h"
@@ -9,6 +7,12 @@
 
 class Scene;
 
+struct ComponentEntry
+{
+    ComponentID id;
+    IComponent* component;
+};
+
 class GameObject
 {
 public:
@@ -22,6 +26,9 @@ class GameObject
     SafePtr<T> GetComponent();
     
     SafePtr<TransformComponent> GetTransform() const { return m_transform; }
+    // Same as GetTransform without the weak_ptr lock, for per-frame code
+    TransformComponent* ResolveTransform() const { return m_scene.Resolve(m_transformHandle); }
+    Handle<TransformComponent> GetTransformHandle() const { return m_transformHandle; }
 
     template<typename T>
     SafePtr<T> AddComponent();
@@ -30,43 +37,72 @@ class GameObject
 
     template<typename T>
     bool HasComponent() const;
+    ComponentMask GetComponentMask() const { return m_componentMask; }
 
     template<typename T>
     void RemoveComponent();
     void RemoveComponent(Core::UUID compId) const;
 
     Core::UUID GetUUID() const { return m_uuid; }
+    Handle<GameObject> GetHandle() const { return m_handle; }
     
-    void SetName(const std::string& name) { m_name = name; }
-    std::string GetName() const { return m_name; }
+    void SetName(Name name);
+    const std::string& GetName() const { return m_name.GetString(); }
+    Name GetInternedName() const { return m_name; }
+
+    // Every object is in exactly one layer, the scene indexes objects by layer
+    void SetLayer(uint8_t layer);
+    uint8_t GetLayer() const { return m_layer; }
+    LayerMask GetLayerMask() const { return LayerMask(1) << m_layer; }
+
+    // Free bits for gameplay categories, not indexed: filter the objects of a layer or name with them
+    void SetTags(TagMask tags) { m_tags = tags; }
+    TagMask GetTags() const { return m_tags; }
+    void AddTag(uint8_t tag) { m_tags |= TagMask(1) << tag; }
+    void RemoveTag(uint8_t tag) { m_tags &= ~(TagMask(1) << tag); }
+    bool HasTag(uint8_t tag) const { return m_tags & (TagMask(1) << tag); }
+    // All of tags
+    bool HasTags(TagMask tags) const { return (m_tags & tags) == tags; }
     
     bool HasParent() const;
     SafePtr<GameObject> GetParent() const;
     
     std::vector<SafePtr<GameObject>> GetChildren() const;
-    std::set<Core::UUID> GetChildrenUUID() const { return m_childrenUUID; }
+    bool HasChildren() const;
     
     Scene* GetScene() const { return &m_scene; }
 private:
     friend Scene;
     
     Core::UUID m_uuid;
-    std::string m_name;
+    Handle<GameObject> m_handle;
+    Name m_name;
+    uint8_t m_layer = 0;
+    TagMask m_tags = 0;
+    // Positions in the scene name and layer indices
+    uint32_t m_nameSlot = 0;
+    uint32_t m_layerSlot = 0;
     
     Scene& m_scene;
     
+    // Children are read from the scene transform hierarchy
     Core::UUID m_parentUUID = UUID_INVALID;
-    std::set<Core::UUID> m_childrenUUID = {};
     
     SafePtr<TransformComponent> m_transform = {};
+    Handle<TransformComponent> m_transformHandle;
+    
+    // Owned by the scene, lets component lookups skip the scene-wide lists
+    std::vector<ComponentEntry> m_components;
+    ComponentMask m_componentMask;
 };
 
 template<typename T>
 SafePtr<T> GameObject::GetComponent() 
 {
-    if (std::is_same_v<T, TransformComponent>)
+    if constexpr (std::is_same_v<T, TransformComponent>)
         return m_transform;
-    return m_scene.GetComponent<T>(this);
+    else
+        return m_scene.GetComponent<T>(this);
 }
 
 template<typename T>
@@ -86,3 +122,9 @@ void GameObject::RemoveComponent()
 {
     m_scene.RemoveComponent<T>(this);
 }
+
+template<typename T>
+IComponent* ComponentRegister::AddComponentTo(GameObject* gameObject)
+{
+    return gameObject->AddComponent<T>().getPtr();
+}
@@ -1,15 +1,39 @@
 ﻿#include "Scene.h"
 
-#include <ranges>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iterator>
 
 #include "GameObject.h"
+#include "SceneCommandBuffer.h"
 #include "Component/IComponent.h"
+#include "Component/MeshComponent.h"
 #include "Component/TransformComponent.h"
 #include "Core/Engine.h"
 #include "Debug/Log.h"
 
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Milliseconds since start, which moves to now for the next stage
+    double Elapsed(Clock::time_point& start)
+    {
+        const Clock::time_point now = Clock::now();
+        const double milliseconds = std::chrono::duration<double, std::milli>(now - start).count();
+        start = now;
+        return milliseconds;
+    }
+}
+
 Scene::Scene()
 {
+    static std::atomic<uint64_t> s_nextId = 1;
+    m_id = s_nextId++;
+    if (const Engine* engine = Engine::Get())
+        m_resourceManager = engine->GetResourceManager();
+
     SafePtr<GameObject> root = CreateGameObject();
     root->SetName("Root");
     m_rootUUID = root->GetUUID();
@@ -19,9 +43,10 @@ Scene::Scene()
 
     m_editorCamera->GetTransform()->EOnUpdateModelMatrix += [this]()
     {
-        float aspect = Engine::Get()->GetWindow()->GetAspectRatio();
-        
-        m_editorCamera->SetAspectRatio(aspect);
+        // Keeps the default aspect ratio without a window, in tests and benchmarks
+        const Engine* engine = Engine::Get();
+        if (engine && engine->GetWindow())
+            m_editorCamera->SetAspectRatio(engine->GetWindow()->GetAspectRatio());
         
         m_editorCamera->UpdateFrustum();
 
@@ -30,6 +55,7 @@ Scene::Scene()
         m_editorCameraData.forward = m_editorCamera->GetTransform()->GetForward();
         m_editorCameraData.right = m_editorCamera->GetTransform()->GetRight();
         m_editorCameraData.up = m_editorCamera->GetTransform()->GetUp();
+        m_editorCameraData.version++;
     };
 }
 
@@ -39,56 +65,314 @@ Scene::~Scene()
     DestroyGameObject(root);
 }
 
-void Scene::OnRender(VulkanRenderer* renderer)
+void Scene::OnRender(IRenderer* renderer)
 {
+    Clock::time_point start = Clock::now();
+
     std::scoped_lock lock(m_componentsMutex);
     
-    for (const std::vector<std::shared_ptr<IComponent>>& componentList : m_components | std::views::values)
+    const ComponentID meshID = ComponentRegister::GetComponentID<MeshComponent>();
+    for (ComponentID id = 0; id < m_components.size(); id++)
     {
-        for (const std::shared_ptr<IComponent>& component : componentList)
+        const ComponentArray& componentArray = m_components[id];
+        if (!componentArray.traits.hasRender || id == meshID)
+            continue;
+        for (IComponent* component : componentArray.components)
         {
             if (component->IsEnable())
                 component->OnRender(renderer);
         }
     }
+
+    // Meshes are culled by the BVH, only the visible ones are submitted
+    for (GameObject* gameObject : m_visibleObjects)
+    {
+        for (const ComponentEntry& entry : gameObject->m_components)
+        {
+            if (entry.id == meshID && entry.component->IsEnable())
+                entry.component->OnRender(renderer);
+        }
+    }
+    m_updateTimings.submit = Elapsed(start);
     
     auto renderQueueManager = renderer->GetRenderQueueManager();
     renderQueueManager->SortAll();
+    m_updateTimings.sort = Elapsed(start);
     renderQueueManager->ExecuteAll(renderer);
     renderQueueManager->ClearAll();
+    m_updateTimings.execute = Elapsed(start);
 }
 
 void Scene::OnUpdate(float deltaTime)
 {
-    UpdateCamera(deltaTime);
+    Clock::time_point start = Clock::now();
+
+    FlushCommands();
+    m_updateTimings.commands = Elapsed(start);
+
+    {
+        std::scoped_lock lock(m_gameObjectsMutex);
+        m_transformHierarchy.UpdateWorldMatrices();
+    }
+    m_updateTimings.transforms = Elapsed(start);
 
     std::scoped_lock lock(m_componentsMutex);
     
-    for (const std::vector<std::shared_ptr<IComponent>>& componentList : m_components | std::views::values)
+    m_scheduler.SetViewPosition(m_editorCamera->GetTransform()->GetLocalPosition());
+    m_scheduler.Run(m_components, deltaTime);
+    m_updateTimings.components = Elapsed(start);
+
+    SyncCulling();
+    m_updateTimings.proxies = Elapsed(start);
+}
+
+void Scene::UpdateView(float deltaTime, float alpha)
+{
+    // The camera follows the frame rate, not the simulation steps, and its matrix is rebuilt right away
+    UpdateCamera(deltaTime);
+    m_editorCamera->GetTransform()->UpdateMatrix();
+    Interpolate(alpha);
+
+    Clock::time_point start = Clock::now();
+    std::scoped_lock lock(m_componentsMutex);
+    UpdateCulling();
+    m_updateTimings.culling = Elapsed(start);
+}
+
+void Scene::Interpolate(float alpha)
+{
+    std::scoped_lock lock(m_gameObjectsMutex);
+    m_transformHierarchy.Interpolate(alpha);
+}
+
+void Scene::SyncCulling()
+{
+    std::scoped_lock lock(m_gameObjectsMutex);
+
+    // Matrix changes first, then bounds set by the components this step
+    m_bvh.BeginBatch();
+    for (TransformComponent* transform : m_transformHierarchy.GetChanged())
+        SyncCullingProxy(transform);
+    for (TransformComponent* transform : m_transformHierarchy.TakeBoundsChanged())
+        SyncCullingProxy(transform);
+    m_bvh.EndBatch();
+    m_bvh.Maintain();
+}
+
+void Scene::UpdateCulling()
+{
+    std::scoped_lock lock(m_gameObjectsMutex);
+
+    m_visibleProxies.clear();
+    m_bvh.Cull(m_editorCameraData.frustum, m_visibleProxies);
+    m_visibleObjects.clear();
+    m_visibleObjects.reserve(m_visibleProxies.size());
+    for (uint32_t proxy : m_visibleProxies)
+        m_visibleObjects.push_back(static_cast<GameObject*>(m_bvh.GetUserData(proxy)));
+    for (TransformComponent* transform : m_alwaysVisibleObjects)
+        m_visibleObjects.push_back(transform->GetGameObject());
+
+    if (m_occlusionCulling)
+        CullOccluded();
+}
+
+void Scene::CullOccluded()
+{
+    // Occluders are not tested against their own depth
+    enum : uint8_t { Tested, Occluder, Hidden };
+
+    const ComponentID meshID = ComponentRegister::GetComponentID<MeshComponent>();
+    m_occlusionCuller.Begin(m_editorCameraData.VP);
+    m_occlusionStates.assign(m_visibleObjects.size(), Tested);
+    for (size_t i = 0; i < m_visibleObjects.size(); i++)
     {
-        for (const std::shared_ptr<IComponent>& component : componentList)
+        GameObject* gameObject = m_visibleObjects[i];
+        for (const ComponentEntry& entry : gameObject->m_components)
         {
-            if (component->IsEnable())
-                component->OnUpdate(deltaTime);
+            if (entry.id != meshID || !entry.component->IsEnable())
+                continue;
+            const Mesh* mesh = static_cast<const MeshComponent*>(entry.component)->GetOccluderMesh();
+            if (!mesh)
+                continue;
+
+            const std::vector<float>& vertices = mesh->GetVertices();
+            m_occlusionCuller.AddOccluder(vertices.data(), vertices.size() / Mesh::FloatsPerVertex, Mesh::FloatsPerVertex,
+                gameObject->ResolveTransform()->GetWorldMatrix());
+            m_occlusionStates[i] = Occluder;
         }
     }
+    if (m_occlusionCuller.GetTriangleCount() == 0)
+        return;
+    m_occlusionCuller.Rasterize();
+
+    ThreadPool::ParallelFor(m_visibleObjects.size(), [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            if (m_occlusionStates[i] != Tested)
+                continue;
+            // Objects without bounds are never hidden
+            const BoundingBox bounds = m_visibleObjects[i]->ResolveTransform()->GetWorldBounds();
+            if (bounds.IsValid() && !m_occlusionCuller.IsVisible(bounds))
+                m_occlusionStates[i] = Hidden;
+        }
+    }, 256);
+
+    size_t kept = 0;
+    for (size_t i = 0; i < m_visibleObjects.size(); i++)
+    {
+        if (m_occlusionStates[i] != Hidden)
+            m_visibleObjects[kept++] = m_visibleObjects[i];
+    }
+    m_visibleObjects.resize(kept);
+}
+
+void Scene::SyncCullingProxy(TransformComponent* transform)
+{
+    const BoundingBox bounds = transform->GetWorldBounds();
+    uint32_t& proxy = transform->m_cullingProxy;
+    if (bounds.IsValid())
+    {
+        if (proxy == BoundingVolumeHierarchy::InvalidIndex)
+            proxy = m_bvh.CreateProxy(bounds, transform->GetGameObject());
+        else
+            m_bvh.MoveProxy(proxy, bounds);
+    }
+    else if (proxy != BoundingVolumeHierarchy::InvalidIndex)
+    {
+        m_bvh.DestroyProxy(proxy);
+        proxy = BoundingVolumeHierarchy::InvalidIndex;
+    }
+
+    const bool alwaysVisible = transform->m_alwaysVisible && !bounds.IsValid();
+    const bool listed = transform->m_alwaysVisibleSlot != TransformHierarchy::InvalidIndex;
+    if (alwaysVisible && !listed)
+    {
+        transform->m_alwaysVisibleSlot = static_cast<uint32_t>(m_alwaysVisibleObjects.size());
+        m_alwaysVisibleObjects.push_back(transform);
+    }
+    else if (!alwaysVisible && listed)
+    {
+        RemoveAlwaysVisible(transform);
+    }
+}
+
+void Scene::RemoveAlwaysVisible(TransformComponent* transform)
+{
+    // Swap and pop
+    const uint32_t slot = transform->m_alwaysVisibleSlot;
+    m_alwaysVisibleObjects[slot] = m_alwaysVisibleObjects.back();
+    m_alwaysVisibleObjects[slot]->m_alwaysVisibleSlot = slot;
+    m_alwaysVisibleObjects.pop_back();
+    transform->m_alwaysVisibleSlot = TransformHierarchy::InvalidIndex;
+}
+
+void Scene::Defer(std::function<void(Scene&)> command)
+{
+    GetCommandBuffer().Enqueue(std::move(command));
+}
+
+SceneCommandBuffer& Scene::GetCommandBuffer()
+{
+    struct CachedBuffer
+    {
+        uint64_t sceneId = 0;
+        SceneCommandBuffer* buffer = nullptr;
+    };
+    thread_local CachedBuffer s_cache;
+    if (s_cache.sceneId == m_id)
+        return *s_cache.buffer;
+
+    std::scoped_lock lock(m_commandBuffersMutex);
+    std::unique_ptr<SceneCommandBuffer>& buffer = m_commandBuffers[std::this_thread::get_id()];
+    if (!buffer)
+    {
+        buffer = std::make_unique<SceneCommandBuffer>(m_commandSequence);
+        m_commandBufferList.push_back(buffer.get());
+    }
+    s_cache = { m_id, buffer.get() };
+    return *buffer;
+}
+
+void Scene::FlushCommands()
+{
+    if (ComponentScheduler::IsUpdating())
+        return;
+
+    std::vector<SceneCommandBuffer*> buffers;
+    {
+        std::scoped_lock lock(m_commandBuffersMutex);
+        buffers = m_commandBufferList;
+    }
+
+    // Taken from every buffer first, then merged back into the global record order
+    std::vector<SceneCommandBuffer::Entry> commands;
+    for (SceneCommandBuffer* buffer : buffers)
+    {
+        std::scoped_lock bufferLock(buffer->m_mutex);
+        std::ranges::move(buffer->m_commands, std::back_inserter(commands));
+        buffer->m_commands.clear();
+    }
+    std::ranges::sort(commands, {}, &SceneCommandBuffer::Entry::sequence);
+
+    // Both locks once for the whole batch, commands recorded while flushing wait for the next sync point
+    std::scoped_lock lock(m_gameObjectsMutex, m_componentsMutex);
+    for (SceneCommandBuffer::Entry& entry : commands)
+    {
+        entry.command(*this);
+    }
 }
 
 SafePtr<GameObject> Scene::CreateGameObject(GameObject* parent)
 {
-    std::shared_ptr object = std::make_shared<GameObject>(*this);
-    object->SetName("GameObject");
-    
+    return CreateGameObject(parent, UUID_INVALID);
+}
+
+SafePtr<GameObject> Scene::CreateGameObject(GameObject* parent, Core::UUID uuid)
+{
+    if (ComponentScheduler::IsUpdating())
     {
-        std::scoped_lock lock(m_gameObjectsMutex);
-        m_gameObjects.emplace(object->GetUUID(), object);
+        // No object to return until the flush
+        Defer([parent = parent ? parent->GetHandle() : Handle<GameObject>(), uuid](Scene& scene)
+        {
+            GameObject* parentObject = scene.Resolve(parent);
+            if (parentObject || !parent)
+                scene.CreateGameObject(parentObject, uuid);
+        });
+        return {};
     }
+
+    static const Name defaultName("GameObject");
+    std::shared_ptr object = std::allocate_shared<GameObject>(ArenaAllocator<GameObject>(m_arena, ComponentArena::GameObjectPool), *this);
+    object->m_name = defaultName;
+    
+    std::scoped_lock lock(m_gameObjectsMutex);
+    // First, a full pool throws before the object is in the scene
+    object->m_handle = m_gameObjectHandles.Add(object.get());
+    if (uuid != UUID_INVALID && !m_gameObjects.contains(uuid))
+        object->m_uuid = uuid;
+    m_gameObjects.emplace(object->GetUUID(), object);
+    AddToIndex(m_nameIndex[object->m_name], object.get(), &GameObject::m_nameSlot);
+    AddToIndex(m_layerIndex[object->m_layer], object.get(), &GameObject::m_layerSlot);
+    m_transformHierarchy.Insert(object->m_transform.getPtr(), nullptr);
     
     SetParent(object.get(), parent ? parent : (m_rootUUID != UUID_INVALID ? GetRootObject().getPtr() : nullptr));
     
     return object;
 }
 
+void Scene::ReserveGameObjects(size_t count)
+{
+    if (ComponentScheduler::IsUpdating())
+        return;
+    std::scoped_lock lock(m_gameObjectsMutex, m_componentsMutex);
+    m_gameObjects.reserve(m_gameObjects.size() + count);
+    m_transformHierarchy.Reserve(m_transformHierarchy.Size() + count);
+
+    ComponentArray& transforms = GetComponentArray(ComponentRegister::GetComponentID<TransformComponent>());
+    transforms.Reserve(transforms.Size() + count);
+}
+
 SafePtr<GameObject> Scene::GetGameObject(Core::UUID uuid) const
 {
     std::scoped_lock lock(m_gameObjectsMutex);
@@ -106,33 +390,132 @@ SafePtr<GameObject> Scene::GetRootObject() const
     return {};
 }
 
+const std::vector<GameObject*>& Scene::FindGameObjectsByName(Name name) const
+{
+    static const std::vector<GameObject*> empty;
+    auto it = m_nameIndex.find(name);
+    return it != m_nameIndex.end() ? it->second : empty;
+}
+
+GameObject* Scene::FindGameObjectByName(Name name) const
+{
+    const std::vector<GameObject*>& objects = FindGameObjectsByName(name);
+    return objects.empty() ? nullptr : objects.front();
+}
+
+const std::vector<GameObject*>& Scene::GetGameObjectsInLayer(uint8_t layer) const
+{
+    ASSERT(layer < MaxLayers)
+    return m_layerIndex[layer];
+}
+
+std::vector<GameObject*> Scene::FindGameObjects(LayerMask layers, TagMask tags) const
+{
+    std::vector<GameObject*> result;
+    for (uint8_t layer = 0; layer < MaxLayers; layer++)
+    {
+        if (!(layers & (LayerMask(1) << layer)))
+            continue;
+        for (GameObject* object : m_layerIndex[layer])
+        {
+            if (object->HasTags(tags))
+                result.push_back(object);
+        }
+    }
+    return result;
+}
+
+void Scene::SetGameObjectName(GameObject* gameObject, Name name)
+{
+    if (ComponentScheduler::IsUpdating())
+    {
+        Defer([handle = gameObject->GetHandle(), name](Scene& scene)
+        {
+            if (GameObject* object = scene.Resolve(handle))
+                scene.SetGameObjectName(object, name);
+        });
+        return;
+    }
+
+    std::scoped_lock lock(m_gameObjectsMutex);
+    if (gameObject->m_name == name)
+        return;
+
+    RemoveFromNameIndex(gameObject);
+    gameObject->m_name = name;
+    AddToIndex(m_nameIndex[name], gameObject, &GameObject::m_nameSlot);
+}
+
+void Scene::SetGameObjectLayer(GameObject* gameObject, uint8_t layer)
+{
+    if (ComponentScheduler::IsUpdating())
+    {
+        Defer([handle = gameObject->GetHandle(), layer](Scene& scene)
+        {
+            if (GameObject* object = scene.Resolve(handle))
+                scene.SetGameObjectLayer(object, layer);
+        });
+        return;
+    }
+    if (layer >= MaxLayers)
+    {
+        PrintError("Layer %u out of range, there are %u layers", layer, MaxLayers);
+        return;
+    }
+
+    std::scoped_lock lock(m_gameObjectsMutex);
+    RemoveFromIndex(m_layerIndex[gameObject->m_layer], gameObject, &GameObject::m_layerSlot);
+    gameObject->m_layer = layer;
+    AddToIndex(m_layerIndex[layer], gameObject, &GameObject::m_layerSlot);
+}
+
+void Scene::RemoveFromNameIndex(GameObject* gameObject)
+{
+    auto it = m_nameIndex.find(gameObject->m_name);
+    RemoveFromIndex(it->second, gameObject, &GameObject::m_nameSlot);
+    // Names of destroyed objects do not pile up
+    if (it->second.empty())
+        m_nameIndex.erase(it);
+}
+
+void Scene::AddToIndex(std::vector<GameObject*>& list, GameObject* gameObject, uint32_t GameObject::* slot)
+{
+    gameObject->*slot = static_cast<uint32_t>(list.size());
+    list.push_back(gameObject);
+}
+
+void Scene::RemoveFromIndex(std::vector<GameObject*>& list, GameObject* gameObject, uint32_t GameObject::* slot)
+{
+    const uint32_t index = gameObject->*slot;
+    ASSERT(index < list.size() && list[index] == gameObject)
+    list[index] = list.back();
+    list[index]->*slot = index;
+    list.pop_back();
+}
+
 void Scene::SetParent(GameObject* object, GameObject* parent)
 {
-    Core::UUID objectUuid = object->GetUUID();
-    if (object->m_parentUUID != UUID_INVALID)
+    if (ComponentScheduler::IsUpdating())
     {
-        SafePtr<GameObject> prevParent = GetGameObject(object->m_parentUUID);
-        if (prevParent)
-            RemoveChild(prevParent.getPtr(), object);
+        GetCommandBuffer().SetParent(object->GetHandle(), parent ? parent->GetHandle() : Handle<GameObject>());
+        return;
     }
 
+    std::scoped_lock lock(m_gameObjectsMutex);
+    
+    if (!m_transformHierarchy.SetParent(object->m_transform.getPtr(), parent ? parent->m_transform.getPtr() : nullptr))
+        return;
+
     if (parent)
         object->m_parentUUID = parent->GetUUID();
     else
         object->m_parentUUID = UUID_INVALID;
-
-    if (parent)
-    {
-        parent->m_childrenUUID.insert(objectUuid);
-    }
 }
 
 void Scene::RemoveChild(GameObject* object, GameObject* child)
 {
-    auto it = object->m_childrenUUID.find(child->GetUUID());
-    ASSERT(it != object->m_childrenUUID.end())
-    child->m_parentUUID = UUID_INVALID;
-    object->m_childrenUUID.erase(it);
+    ASSERT(child->m_parentUUID == object->GetUUID())
+    SetParent(child, nullptr);
 }
 
 std::vector<SafePtr<IComponent>> Scene::GetComponents(const GameObject* gameObject)
@@ -142,81 +525,355 @@ std::vector<SafePtr<IComponent>> Scene::GetComponents(const GameObject* gameObje
     if (!gameObject)
         return result;
 
-    std::scoped_lock lock(m_componentsMutex);
+    auto lock = LockComponents();
 
-    for (auto& componentList : m_components | std::views::values)
+    result.reserve(gameObject->m_components.size());
+    for (const ComponentEntry& entry : gameObject->m_components)
     {
-        for (auto& component : componentList)
-        {
-            if (component->GetGameObject() == gameObject)
-            {
-                result.emplace_back(component);
-            }
-        }
+        result.emplace_back(m_components[entry.id].GetOwner(entry.component));
     }
 
     return result;
 }
 
+bool Scene::HasComponent(const GameObject* gameObject, ComponentID id) const
+{
+    if (!gameObject || id >= MaxComponentTypes)
+        return false;
+    
+    auto lock = LockComponents();
+    return gameObject->m_componentMask.test(id);
+}
+
 void Scene::DestroyGameObject(GameObject* gameObject)
 {
+    if (ComponentScheduler::IsUpdating())
+    {
+        if (gameObject)
+            GetCommandBuffer().DestroyGameObject(gameObject->GetHandle());
+        return;
+    }
+
     std::scoped_lock lock(m_gameObjectsMutex);
     
-    auto it = m_gameObjects.find(gameObject->GetUUID());
-    if (it == m_gameObjects.end())
+    if (!gameObject || !m_gameObjects.contains(gameObject->GetUUID()))
         return;
-    
-    for (auto& childUUID : gameObject->m_childrenUUID)
+
+    // The whole subtree leaves the hierarchy at once, then objects are destroyed children first
+    std::vector<TransformComponent*> subtree = m_transformHierarchy.Remove(gameObject->m_transform.getPtr());
+    bool culled = false;
+    for (TransformComponent* transform : subtree)
     {
-        GameObject* object = GetGameObject(childUUID).getPtr();
-        DestroyGameObject(object);
+        if (transform->m_alwaysVisibleSlot != TransformHierarchy::InvalidIndex)
+        {
+            RemoveAlwaysVisible(transform);
+            culled = true;
+        }
+        if (transform->m_cullingProxy == BoundingVolumeHierarchy::InvalidIndex)
+            continue;
+        m_bvh.DestroyProxy(transform->m_cullingProxy);
+        transform->m_cullingProxy = BoundingVolumeHierarchy::InvalidIndex;
+        culled = true;
+    }
+    // The visible list is read until the next update
+    if (culled)
+        std::erase_if(m_visibleObjects, [](const GameObject* object) { return object->m_transform.getPtr()->GetHierarchyIndex() == TransformHierarchy::InvalidIndex; });
+
+    std::scoped_lock componentsLock(m_componentsMutex);
+
+    // Children first, every component of the subtree is still attached when OnDestroy runs
+    for (size_t i = subtree.size(); i-- > 0;)
+    {
+        const std::vector<ComponentEntry>& components = subtree[i]->GetGameObject()->m_components;
+        for (size_t j = components.size(); j-- > 0;)
+            components[j].component->OnDestroy();
+    }
+
+    // Queries drop their rows once per object instead of once per component
+    {
+        std::scoped_lock queriesLock(m_queriesMutex);
+        std::vector<GameObject*> matching;
+        for (const std::unique_ptr<ComponentQuery>& query : m_queries)
+        {
+            matching.clear();
+            for (TransformComponent* transform : subtree)
+            {
+                GameObject* object = transform->GetGameObject();
+                if ((object->m_componentMask & query->GetMask()) == query->GetMask())
+                    matching.push_back(object);
+            }
+            query->Remove(matching);
+        }
     }
 
-    RemoveAllComponents(gameObject);
+    // Components leave their arrays by storage index, one pass per type.
+    // The memory is released once the scene no longer points to any of them.
+    std::vector<std::vector<uint32_t>> removedIndices(m_components.size());
+    std::vector<std::shared_ptr<GameObject>> releasedObjects;
+    releasedObjects.reserve(subtree.size());
+    for (size_t i = subtree.size(); i-- > 0;)
+    {
+        GameObject* object = subtree[i]->GetGameObject();
+        for (const ComponentEntry& entry : object->m_components)
+        {
+            m_componentHandles.Remove(entry.component->m_handle);
+            removedIndices[entry.id].push_back(entry.component->m_storageIndex);
+        }
+        object->m_components.clear();
+        object->m_componentMask.reset();
+
+        m_gameObjectHandles.Remove(object->m_handle);
+        RemoveFromNameIndex(object);
+        RemoveFromIndex(m_layerIndex[object->m_layer], object, &GameObject::m_layerSlot);
 
-    m_gameObjects.erase(it);
+        auto it = m_gameObjects.find(object->GetUUID());
+        releasedObjects.push_back(std::move(it->second));
+        m_gameObjects.erase(it);
+    }
+
+    std::vector<std::shared_ptr<IComponent>> releasedComponents;
+    for (ComponentID id = 0; id < removedIndices.size(); id++)
+        m_components[id].RemoveMany(removedIndices[id], releasedComponents);
+    releasedComponents.clear();
+    releasedObjects.clear();
 }
 
 void Scene::RemoveComponent(Core::UUID compId)
 {
-    for (auto& componentList : m_components | std::views::values)
+    if (ComponentScheduler::IsUpdating())
+    {
+        Defer([compId](Scene& scene) { scene.RemoveComponent(compId); });
+        return;
+    }
+
+    std::scoped_lock lock(m_componentsMutex);
+
+    for (const ComponentArray& componentArray : m_components)
+    {
+        for (IComponent* component : componentArray.components)
+        {
+            if (component->GetUUID() == compId)
+            {
+                RemoveComponent(component);
+                return;
+            }
+        }
+    }
+}
+
+void Scene::RemoveComponent(IComponent* component)
+{
+    if (ComponentScheduler::IsUpdating())
     {
-        auto removeIt = std::ranges::remove_if(componentList,
-           [compId](const std::shared_ptr<IComponent>& component)
-           {
-               if (component->GetUUID() == compId)
-               {
-                   component->OnDestroy();
-                   return true;
-               }
-               return false;
-           }
-        ).begin();
+        GetCommandBuffer().RemoveComponent(component->GetHandle());
+        return;
     }
+
+    std::scoped_lock lock(m_componentsMutex);
+
+    GameObject* gameObject = component->GetGameObject();
+    auto it = std::ranges::find(gameObject->m_components, component, &ComponentEntry::component);
+    if (it == gameObject->m_components.end())
+        return;
+    component->OnDestroy();
+    DetachComponent(gameObject, it - gameObject->m_components.begin());
+}
+
+void Scene::RemoveComponent(GameObject* gameObject, ComponentID id)
+{
+    if (ComponentScheduler::IsUpdating())
+    {
+        Defer([handle = gameObject->GetHandle(), id](Scene& scene)
+        {
+            if (GameObject* object = scene.Resolve(handle))
+                scene.RemoveComponent(object, id);
+        });
+        return;
+    }
+
+    if (!HasComponent(gameObject, id))
+        return;
+
+    std::scoped_lock lock(m_componentsMutex);
+
+    auto it = std::ranges::find(gameObject->m_components, id, &ComponentEntry::id);
+    it->component->OnDestroy();
+    DetachComponent(gameObject, it - gameObject->m_components.begin());
 }
 
 void Scene::RemoveAllComponents(GameObject* gameObject)
 {
     if (!gameObject)
         return;
+    if (ComponentScheduler::IsUpdating())
+    {
+        Defer([handle = gameObject->GetHandle()](Scene& scene)
+        {
+            if (GameObject* object = scene.Resolve(handle))
+                scene.RemoveAllComponents(object);
+        });
+        return;
+    }
 
     std::scoped_lock lock(m_componentsMutex);
     
-    for (auto& componentList : m_components | std::views::values)
+    for (size_t i = gameObject->m_components.size(); i-- > 0;)
+    {
+        gameObject->m_components[i].component->OnDestroy();
+        DetachComponent(gameObject, i);
+    }
+}
+
+ComponentArray& Scene::GetComponentArray(ComponentID id)
+{
+    if (id >= m_components.size())
+        m_components.resize(id + 1);
+    return m_components[id];
+}
+
+ComponentArray* Scene::FindComponentArray(ComponentID id)
+{
+    return id < m_components.size() ? &m_components[id] : nullptr;
+}
+
+std::unique_lock<std::recursive_mutex> Scene::LockComponents() const
+{
+    if (ComponentScheduler::IsUpdating())
+        return {};
+    return std::unique_lock(m_componentsMutex);
+}
+
+std::shared_ptr<IComponent> Scene::FindComponent(const GameObject* gameObject, ComponentID id) const
+{
+    if (!HasComponent(gameObject, id))
+        return nullptr;
+
+    auto lock = LockComponents();
+
+    for (const ComponentEntry& entry : gameObject->m_components)
     {
-        auto removeIt = std::ranges::remove_if(componentList,
-           [gameObject](const std::shared_ptr<IComponent>& component)
-           {
-               if (component->GetGameObject() == gameObject)
-               {
-                   component->OnDestroy();
-                   return true;
-               }
-               return false;
-           }
-        ).begin();
+        if (entry.id == id)
+            return m_components[id].GetOwner(entry.component);
+    }
+    return nullptr;
+}
+
+std::vector<std::shared_ptr<IComponent>> Scene::FindComponents(const GameObject* gameObject, ComponentID id) const
+{
+    std::vector<std::shared_ptr<IComponent>> result;
+    if (!HasComponent(gameObject, id))
+        return result;
+
+    auto lock = LockComponents();
 
-        componentList.erase(removeIt, componentList.end());
+    for (const ComponentEntry& entry : gameObject->m_components)
+    {
+        if (entry.id == id)
+            result.push_back(m_components[id].GetOwner(entry.component));
+    }
+    return result;
+}
+
+bool Scene::AttachComponent(GameObject* gameObject, ComponentID id, const std::shared_ptr<IComponent>& component, const ComponentTraits& traits)
+{
+    ASSERT(id < MaxComponentTypes)
+    if (ComponentScheduler::IsUpdating())
+    {
+        // The command keeps the component alive until then
+        Defer([handle = gameObject->GetHandle(), id, component, traits](Scene& scene)
+        {
+            GameObject* object = scene.Resolve(handle);
+            if (object && scene.AttachComponent(object, id, component, traits))
+                component->OnCreate();
+        });
+        return false;
+    }
+    
+    std::scoped_lock lock(m_componentsMutex);
+
+    // First, a full pool throws before the component is in the scene
+    component->m_handle = m_componentHandles.Add(component.get());
+
+    ComponentArray& componentArray = GetComponentArray(id);
+    if (!componentArray.initialized)
+    {
+        componentArray.traits = traits;
+        componentArray.initialized = true;
+        m_scheduler.Invalidate();
+    }
+    componentArray.Add(component);
+    
+    gameObject->m_components.push_back({ id, component.get() });
+    gameObject->m_componentMask.set(id);
+    UpdateQueries(gameObject, id);
+    return true;
+}
+
+void Scene::DetachComponent(GameObject* gameObject, size_t entryIndex)
+{
+    // The public removals defer, nothing to do here
+    if (ComponentScheduler::IsUpdating())
+        return;
+
+    const ComponentEntry entry = gameObject->m_components[entryIndex];
+    gameObject->m_components.erase(gameObject->m_components.begin() + static_cast<ptrdiff_t>(entryIndex));
+
+    if (std::ranges::find(gameObject->m_components, entry.id, &ComponentEntry::id) == gameObject->m_components.end())
+        gameObject->m_componentMask.reset(entry.id);
+    UpdateQueries(gameObject, entry.id);
+
+    m_componentHandles.Remove(entry.component->m_handle);
+    
+    // Last, the array may hold the only reference to the component
+    m_components[entry.id].Remove(entry.component);
+}
+
+const ComponentQuery* Scene::GetQuery(std::vector<ComponentID> ids)
+{
+    // Same order as the attach and detach calls
+    auto componentLock = LockComponents();
+    std::scoped_lock lock(m_queriesMutex);
+    for (const std::unique_ptr<ComponentQuery>& query : m_queries)
+    {
+        if (query->GetIDs() == ids)
+            return query.get();
+    }
+
+    auto query = std::make_unique<ComponentQuery>(std::move(ids));
+
+    // Filled once from the smallest of the queried arrays, then kept up to date
+    const ComponentArray* smallest = nullptr;
+    for (ComponentID id : query->GetIDs())
+    {
+        const ComponentArray* componentArray = FindComponentArray(id);
+        if (!componentArray || componentArray->Empty())
+        {
+            smallest = nullptr;
+            break;
+        }
+        if (!smallest || componentArray->Size() < smallest->Size())
+            smallest = componentArray;
+    }
+    if (smallest)
+    {
+        for (IComponent* component : smallest->components)
+        {
+            GameObject* gameObject = component->GetGameObject();
+            query->Update(gameObject, gameObject->m_componentMask, gameObject->m_components);
+        }
+    }
+
+    m_queries.push_back(std::move(query));
+    return m_queries.back().get();
+}
+
+void Scene::UpdateQueries(GameObject* gameObject, ComponentID id)
+{
+    std::scoped_lock lock(m_queriesMutex);
+    for (const std::unique_ptr<ComponentQuery>& query : m_queries)
+    {
+        if (query->GetMask().test(id))
+            query->Update(gameObject, gameObject->m_componentMask, gameObject->m_components);
     }
 }
 
@@ -225,10 +882,12 @@ void Scene::UpdateCamera(float deltaTime) const
     static Vec2f startClickPos;
     static Vec2f prevMousePos = Vec2f::Zero();
     auto transform = m_editorCamera->GetTransform();
-    transform->OnUpdate(deltaTime);
-    
     auto position = transform->GetLocalPosition();
-    Window* window = Engine::Get()->GetWindow();
+    const Engine* engine = Engine::Get();
+    Window* window = engine ? engine->GetWindow() : nullptr;
+    // Headless, nothing drives the camera
+    if (!window)
+        return;
     Input& input = window->GetInput();
     
     static bool isLooking = false;
@@ -1,20 +1,36 @@
 ﻿#pragma once
+#include <array>
+#include <atomic>
+#include <functional>
 #include <unordered_map>
 #include <vector>
 #include <shared_mutex>
 #include <mutex>
+#include <thread>
 
 #include <galaxymath/Maths.h>
 
 #include "Render/Camera.h"
 #include "ComponentHandler.h"
+#include "ComponentStorage.h"
+#include "ComponentScheduler.h"
+#include "SceneView.h"
+#include "TransformHierarchy.h"
+#include "Physic/BoundingVolumeHierarchy.h"
+#include "Render/OcclusionCuller.h"
 
+#include "Utils/Handle.h"
+#include "Utils/Name.h"
 #include "Utils/Type.h"
 
 class TransformComponent;
-class RHIRenderer;
+class IRenderer;
 class IComponent;
 class GameObject;
+class SceneCommandBuffer;
+class SceneSerializer;
+class SceneFileReader;
+class ResourceManager;
 
 struct CameraData
 {    
@@ -23,9 +39,32 @@ struct CameraData
     Vec3f up;
     Vec3f right;
     Frustum frustum;
+    // Grows every time the fields above change
+    uint64_t version = 0;
+};
+
+// Duration of the stages of the last OnUpdate, of the culling of the last UpdateView and of the last OnRender, in milliseconds
+struct SceneUpdateTimings
+{
+    double commands = 0.0;
+    double transforms = 0.0;
+    double components = 0.0;
+    // Moved and resized bounds given to the BVH
+    double proxies = 0.0;
+    double culling = 0.0;
+    // Render callbacks of the components and of the visible meshes, then the queues
+    double submit = 0.0;
+    double sort = 0.0;
+    double execute = 0.0;
 };
 
 using GameObjectList = std::unordered_map<Core::UUID, std::shared_ptr<GameObject>>;
+// Bit per layer and per tag
+using LayerMask = uint32_t;
+using TagMask = uint64_t;
+constexpr uint8_t MaxLayers = 32;
+constexpr uint8_t MaxTags = 64;
+
 class Scene
 {
 public:
@@ -35,14 +74,43 @@ class Scene
     Scene(Scene&&) noexcept = delete;
     virtual ~Scene();
 
-    void OnRender(VulkanRenderer* renderer);
+    void OnRender(IRenderer* renderer);
+    // One fixed simulation step: commands, transforms, components and the BVH leaves of what moved
     void OnUpdate(float deltaTime);
+    // Once per frame before OnRender, however many steps ran: moves the editor camera by the frame time,
+    // interpolates the transforms and culls with the camera
+    void UpdateView(float deltaTime, float alpha);
+    // Blends the transforms moved by the last OnUpdate, alpha of the way from their previous state
+    void Interpolate(float alpha);
+
+    // Buffer of the calling thread, the only way to change the scene from component updates or worker threads
+    SceneCommandBuffer& GetCommandBuffer();
+    // Sync point, applies every recorded command in the order they were recorded, whatever the thread. Called at the start of OnUpdate.
+    void FlushCommands();
 
     const GameObjectList& GetGameObjects() const { return m_gameObjects; }
     SafePtr<GameObject> CreateGameObject(GameObject* parent = nullptr);
     SafePtr<GameObject> GetGameObject(Core::UUID UUID) const;
     SafePtr<GameObject> GetRootObject() const;
+    // Non-owning, no atomics: resolve on the main thread or inside the update
+    GameObject* Resolve(Handle<GameObject> handle) const { return m_gameObjectHandles.Get(handle); }
     void DestroyGameObject(GameObject* gameObject);
+
+    // Index lookups, no scan of the scene. Main thread, like GetGameObjects, the lists are in no particular order.
+    const std::vector<GameObject*>& FindGameObjectsByName(Name name) const;
+    GameObject* FindGameObjectByName(Name name) const;
+    const std::vector<GameObject*>& GetGameObjectsInLayer(uint8_t layer) const;
+    // Objects in one of layers having every tag of tags
+    std::vector<GameObject*> FindGameObjects(LayerMask layers, TagMask tags = 0) const;
+
+    // Room for count more GameObjects, before creating many at once. Ignored during a component update, the arrays are in use.
+    void ReserveGameObjects(size_t count);
+    template<typename T>
+    void ReserveComponents(size_t count);
+    // Runs function with both scene locks held, the scene calls it makes don't wait on them again.
+    // During a component update it runs without them, its structural changes are deferred anyway.
+    template<typename F>
+    void Batch(F&& function);
     
     void SetParent(GameObject* object, GameObject* parent);
     void RemoveChild(GameObject* object, GameObject* child);
@@ -56,7 +124,8 @@ class Scene
     std::vector<SafePtr<IComponent>> GetComponents(const GameObject* gameObject);
 
     template<typename T>
-    bool HasComponent(GameObject* gameObject);
+    bool HasComponent(const GameObject* gameObject) const;
+    bool HasComponent(const GameObject* gameObject, ComponentID id) const;
 
     template<typename T>
     SafePtr<T> AddComponent(GameObject* gameObject);
@@ -64,41 +133,134 @@ class Scene
     template<typename T>
     void RemoveComponent(GameObject* gameObject);
     void RemoveComponent(Core::UUID compId);
+    void RemoveComponent(IComponent* component);
+    void RemoveComponent(GameObject* gameObject, ComponentID id);
     
     void RemoveAllComponents(GameObject* gameObject);
+
+    template<typename T>
+    T* Resolve(Handle<T> handle) const;
+
+    // Every GameObject having all of Ts, the matching set is cached and kept up to date by the scene
+    template<typename... Ts>
+    SceneView<Ts...> View();
 #pragma endregion 
-    CameraData GetCameraData() const { return m_editorCameraData; }
+    const CameraData& GetCameraData() const { return m_editorCameraData; }
+    const SceneUpdateTimings& GetUpdateTimings() const { return m_updateTimings; }
+    // Milliseconds per frame for the updates of the types with an interval or a significance, 0 for no limit
+    void SetUpdateBudget(double milliseconds) { m_scheduler.SetBudget(milliseconds); }
+    const BudgetStats& GetBudgetStats() const { return m_scheduler.GetBudgetStats(); }
+    // Objects whose world bounds touch the camera frustum, from the last UpdateView
+    const std::vector<GameObject*>& GetVisibleObjects() const { return m_visibleObjects; }
+
+    // Off by default: drops the visible objects hidden behind the occluder meshes
+    void SetOcclusionCulling(bool enabled) { m_occlusionCulling = enabled; }
+
+    // Resolves the resources of the components, the one of the Engine by default. Null in a scene without one.
+    void SetResourceManager(const ResourceManager* resourceManager) { m_resourceManager = resourceManager; }
+    const ResourceManager* GetResourceManager() const { return m_resourceManager; }
+    bool IsOcclusionCulling() const { return m_occlusionCulling; }
+    const OcclusionCuller& GetOcclusionCuller() const { return m_occlusionCuller; }
     
 private:
     void UpdateCamera(float deltaTime) const;
+    // Moves the BVH leaves of the transforms changed by this step
+    void SyncCulling();
+    // Culls the BVH with the camera of this frame
+    void UpdateCulling();
+    void SyncCullingProxy(TransformComponent* transform);
+    void RemoveAlwaysVisible(TransformComponent* transform);
+    // Rasterizes the visible occluders and removes the objects they hide from m_visibleObjects
+    void CullOccluded();
+
+    // Keeps the generated UUID when uuid is invalid or already used in the scene
+    SafePtr<GameObject> CreateGameObject(GameObject* parent, Core::UUID uuid);
+
+    void SetGameObjectName(GameObject* gameObject, Name name);
+    void SetGameObjectLayer(GameObject* gameObject, uint8_t layer);
+    // Swap and pop, slot is the member of GameObject holding its position in the list
+    static void AddToIndex(std::vector<GameObject*>& list, GameObject* gameObject, uint32_t GameObject::* slot);
+    static void RemoveFromIndex(std::vector<GameObject*>& list, GameObject* gameObject, uint32_t GameObject::* slot);
+    void RemoveFromNameIndex(GameObject* gameObject);
+
+    // Structural calls made from a component update are recorded in the buffer of the calling thread
+    // and applied at the next flush, instead of racing with the other updates
+    void Defer(std::function<void(Scene&)> command);
+
+    ComponentArray& GetComponentArray(ComponentID id);
+    ComponentArray* FindComponentArray(ComponentID id);
+
+    // The main thread holds m_componentsMutex for the whole update, component code must not wait on it
+    std::unique_lock<std::recursive_mutex> LockComponents() const;
+
+    // Per-GameObject component index, only touches the components of the given object
+    std::shared_ptr<IComponent> FindComponent(const GameObject* gameObject, ComponentID id) const;
+    std::vector<std::shared_ptr<IComponent>> FindComponents(const GameObject* gameObject, ComponentID id) const;
+    // False when deferred to the next flush, the deferred attach runs OnCreate itself
+    bool AttachComponent(GameObject* gameObject, ComponentID id, const std::shared_ptr<IComponent>& component, const ComponentTraits& traits);
+    void DetachComponent(GameObject* gameObject, size_t entryIndex);
+
+    const ComponentQuery* GetQuery(std::vector<ComponentID> ids);
+    // After a component of type id was attached to or detached from gameObject
+    void UpdateQueries(GameObject* gameObject, ComponentID id);
 private:
     friend GameObject;
+    friend SceneSerializer;
+    friend SceneFileReader;
 
     Core::UUID m_rootUUID = UUID_INVALID;
     GameObjectList m_gameObjects;
-    std::unordered_map<ComponentID, std::vector<std::shared_ptr<IComponent>>> m_components;
+    // Guarded by m_gameObjectsMutex
+    TransformHierarchy m_transformHierarchy;
+    HandlePool<GameObject> m_gameObjectHandles;
+    // Guarded by m_gameObjectsMutex, every GameObject is in the list of its name and of its layer
+    std::unordered_map<Name, std::vector<GameObject*>> m_nameIndex;
+    std::array<std::vector<GameObject*>, MaxLayers> m_layerIndex;
+    // Indexed by ComponentID, a dense list of the components of each type. The components themselves
+    // are in m_arena chunks shared by every type of the same slot size, not grouped per type or per GameObject.
+    std::vector<ComponentArray> m_components;
+    HandlePool<IComponent> m_componentHandles;
+    // Holds the GameObjects too, one slot size per type
+    std::shared_ptr<ComponentArena> m_arena = std::make_shared<ComponentArena>();
+    ComponentScheduler m_scheduler;
+    // Content guarded by m_componentsMutex, the list by m_queriesMutex taken after it
+    std::vector<std::unique_ptr<ComponentQuery>> m_queries;
+    std::mutex m_queriesMutex;
     
     std::unique_ptr<Camera> m_editorCamera;
     CameraData m_editorCameraData;
+    SceneUpdateTimings m_updateTimings;
+
+    // World bounds of the transforms, set by the components that render something
+    BoundingVolumeHierarchy m_bvh;
+    std::vector<uint32_t> m_visibleProxies;
+    std::vector<GameObject*> m_visibleObjects;
+    // Objects rendering something without bounds, added to the visible ones every update
+    std::vector<TransformComponent*> m_alwaysVisibleObjects;
+
+    OcclusionCuller m_occlusionCuller;
+    // Per visible object: tested, occluder or hidden
+    std::vector<uint8_t> m_occlusionStates;
+    bool m_occlusionCulling = false;
+    const ResourceManager* m_resourceManager = nullptr;
     
     mutable std::recursive_mutex m_gameObjectsMutex;
     mutable std::recursive_mutex m_componentsMutex;
+
+    // One buffer per recording thread, m_id keys the per thread lookup cache
+    uint64_t m_id;
+    // Numbers the recorded commands across the buffers
+    std::atomic<uint64_t> m_commandSequence = 0;
+    std::mutex m_commandBuffersMutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<SceneCommandBuffer>> m_commandBuffers;
+    std::vector<SceneCommandBuffer*> m_commandBufferList;
 };
 
 template<typename T>
 SafePtr<T> Scene::GetComponent(GameObject* gameObject)
 {
-    std::scoped_lock lock(m_componentsMutex);
-    
-    auto it = m_components.find(ComponentRegister::GetComponentID<T>());
-    if (it == m_components.end()) return {};
-
-    for (const auto& component : it->second) {
-        if (component->GetGameObject() == gameObject) {
-            return SafePtr<T>(std::static_pointer_cast<T>(component));
-        }
-    }
-    return {};
+    static_assert(std::is_base_of_v<IComponent, T>, "T must inherit from IComponent");
+    return SafePtr<T>(std::static_pointer_cast<T>(FindComponent(gameObject, ComponentRegister::GetComponentID<T>())));
 }
 
 template<typename T>
@@ -106,61 +268,73 @@ std::vector<SafePtr<T>> Scene::GetComponents(GameObject* gameObject)
 {
     static_assert(std::is_base_of_v<IComponent, T>, "T must inherit from IComponent");
 
-    std::scoped_lock lock(m_componentsMutex);
-    
     std::vector<SafePtr<T>> out;
-    auto it = m_components.find(ComponentRegister::GetComponentID<T>());
-    if (it == m_components.end()) return out;
-
-    for (const auto& component : it->second)
+    for (const std::shared_ptr<IComponent>& component : FindComponents(gameObject, ComponentRegister::GetComponentID<T>()))
     {
-        if (component->GetGameObject() == gameObject)
-        {
-            out.push_back(SafePtr<T>(std::static_pointer_cast<T>(component)));
-        }
+        out.push_back(SafePtr<T>(std::static_pointer_cast<T>(component)));
     }
     return out;
 }
 
 template<typename T>
-bool Scene::HasComponent(GameObject* gameObject)
+bool Scene::HasComponent(const GameObject* gameObject) const
 {
     static_assert(std::is_base_of_v<IComponent, T>, "T must inherit from IComponent");
-    return GetComponent<T>(gameObject) != nullptr;
+    return HasComponent(gameObject, ComponentRegister::GetComponentID<T>());
 }
 
 template<typename T>
 SafePtr<T> Scene::AddComponent(GameObject* gameObject)
 {
     static_assert(std::is_base_of_v<IComponent, T>, "T must inherit from IComponent");
-    auto component = std::make_shared<T>(gameObject);
+    auto component = std::allocate_shared<T>(ArenaAllocator<T>(m_arena, ComponentRegister::GetComponentID<T>()), gameObject);
 
-    std::scoped_lock lock(m_componentsMutex);
-    m_components[ComponentRegister::GetComponentID<T>()].push_back(component);
-    component->OnCreate();
+    if (AttachComponent(gameObject, ComponentRegister::GetComponentID<T>(), component, ComponentTraits::Of<T>()))
+        component->OnCreate();
     
     return component;
 }
 
 template<typename T>
-void Scene::RemoveComponent(GameObject* gameObject)
+void Scene::ReserveComponents(size_t count)
 {
     static_assert(std::is_base_of_v<IComponent, T>, "T must inherit from IComponent");
+    if (ComponentScheduler::IsUpdating())
+        return;
+    auto lock = LockComponents();
+    ComponentArray& componentArray = GetComponentArray(ComponentRegister::GetComponentID<T>());
+    componentArray.Reserve(componentArray.Size() + count);
+}
 
-    std::scoped_lock lock(m_componentsMutex);
-    
-    auto it = m_components.find(ComponentRegister::GetComponentID<T>());
-    if (it == m_components.end()) return;
-    
-    auto& componentList = it->second;
-    auto removeIt = std::find_if(componentList.begin(), componentList.end(),
-        [gameObject](const std::shared_ptr<IComponent>& comp) {
-            return comp->GetGameObject() == gameObject;
-        });
-    
-    if (removeIt != componentList.end())
+template<typename F>
+void Scene::Batch(F&& function)
+{
+    if (ComponentScheduler::IsUpdating())
     {
-        (*removeIt)->OnDestroy();
-        componentList.erase(removeIt);
+        function();
+        return;
     }
-}
\ No newline at end of file
+    std::scoped_lock lock(m_gameObjectsMutex, m_componentsMutex);
+    function();
+}
+
+template<typename T>
+void Scene::RemoveComponent(GameObject* gameObject)
+{
+    static_assert(std::is_base_of_v<IComponent, T>, "T must inherit from IComponent");
+    RemoveComponent(gameObject, ComponentRegister::GetComponentID<T>());
+}
+
+template<typename T>
+T* Scene::Resolve(Handle<T> handle) const
+{
+    static_assert(std::is_base_of_v<IComponent, T>, "T must inherit from IComponent");
+    return static_cast<T*>(m_componentHandles.Get(handle));
+}
+
+template<typename... Ts>
+SceneView<Ts...> Scene::View()
+{
+    static_assert((std::is_base_of_v<IComponent, Ts> && ...), "Ts must inherit from IComponent");
+    return SceneView<Ts...>(GetQuery({ ComponentRegister::GetComponentID<Ts>()... }));
+}
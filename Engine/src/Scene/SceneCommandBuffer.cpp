@@ -0,0 +1,61 @@
+#include "SceneCommandBuffer.h"
+
+void SceneCommandBuffer::CreateGameObject(Handle<GameObject> parent, std::function<void(GameObject*)> onCreated)
+{
+    Enqueue([parent, onCreated = std::move(onCreated)](Scene& scene)
+    {
+        GameObject* parentObject = nullptr;
+        if (parent)
+        {
+            parentObject = scene.Resolve(parent);
+            if (!parentObject)
+                return;
+        }
+
+        SafePtr<GameObject> object = scene.CreateGameObject(parentObject);
+        if (onCreated)
+            onCreated(object.getPtr());
+    });
+}
+
+void SceneCommandBuffer::DestroyGameObject(Handle<GameObject> gameObject)
+{
+    Enqueue([gameObject](Scene& scene)
+    {
+        if (GameObject* object = scene.Resolve(gameObject))
+            scene.DestroyGameObject(object);
+    });
+}
+
+void SceneCommandBuffer::SetParent(Handle<GameObject> gameObject, Handle<GameObject> parent)
+{
+    Enqueue([gameObject, parent](Scene& scene)
+    {
+        GameObject* object = scene.Resolve(gameObject);
+        GameObject* parentObject = scene.Resolve(parent);
+        if (object && (parentObject || !parent))
+            scene.SetParent(object, parentObject);
+    });
+}
+
+void SceneCommandBuffer::RemoveComponent(Handle<IComponent> component)
+{
+    Enqueue([component](Scene& scene)
+    {
+        if (IComponent* componentPtr = scene.Resolve(component))
+            scene.RemoveComponent(componentPtr);
+    });
+}
+
+void SceneCommandBuffer::Enqueue(Command command)
+{
+    std::scoped_lock lock(m_mutex);
+    // Taken under the lock so the entries of one buffer stay sorted
+    m_commands.push_back({ m_sequence.fetch_add(1, std::memory_order_relaxed), std::move(command) });
+}
+
+bool SceneCommandBuffer::Empty() const
+{
+    std::scoped_lock lock(m_mutex);
+    return m_commands.empty();
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "GameObject.h"
+#include "Scene.h"
+
+#include "Utils/Handle.h"
+
+// Structural changes recorded by one thread, applied by the scene at its next sync point (Scene::FlushCommands).
+// Each command takes a number from the sequence of its scene, so the commands of every thread run in the global
+// order they were recorded, on the main thread. A command on an object destroyed in the meantime is skipped.
+class SceneCommandBuffer
+{
+public:
+    using Command = std::function<void(Scene&)>;
+
+    SceneCommandBuffer(std::atomic<uint64_t>& sequence) : m_sequence(sequence) {}
+    SceneCommandBuffer(const SceneCommandBuffer&) = delete;
+    SceneCommandBuffer& operator=(const SceneCommandBuffer&) = delete;
+
+    // No parent means the root. onCreated runs on the new object right after it is created.
+    void CreateGameObject(Handle<GameObject> parent = {}, std::function<void(GameObject*)> onCreated = nullptr);
+    void DestroyGameObject(Handle<GameObject> gameObject);
+    void SetParent(Handle<GameObject> gameObject, Handle<GameObject> parent);
+
+    template<typename T>
+    void AddComponent(Handle<GameObject> gameObject, std::function<void(T*)> onAdded = nullptr);
+    template<typename T>
+    void RemoveComponent(Handle<GameObject> gameObject);
+    void RemoveComponent(Handle<IComponent> component);
+
+    // Any other work that has to wait for the sync point
+    void Enqueue(Command command);
+
+    bool Empty() const;
+
+private:
+    friend Scene;
+
+    struct Entry
+    {
+        uint64_t sequence;
+        Command command;
+    };
+
+    // Shared by the buffers of one scene
+    std::atomic<uint64_t>& m_sequence;
+    // Recording only contends with the flush, never with other threads
+    mutable std::mutex m_mutex;
+    std::vector<Entry> m_commands;
+};
+
+template<typename T>
+void SceneCommandBuffer::AddComponent(Handle<GameObject> gameObject, std::function<void(T*)> onAdded)
+{
+    static_assert(std::is_base_of_v<IComponent, T>, "T must inherit from IComponent");
+    Enqueue([gameObject, onAdded = std::move(onAdded)](Scene& scene)
+    {
+        GameObject* object = scene.Resolve(gameObject);
+        if (!object)
+            return;
+        SafePtr<T> component = object->AddComponent<T>();
+        if (onAdded)
+            onAdded(component.getPtr());
+    });
+}
+
+template<typename T>
+void SceneCommandBuffer::RemoveComponent(Handle<GameObject> gameObject)
+{
+    static_assert(std::is_base_of_v<IComponent, T>, "T must inherit from IComponent");
+    Enqueue([gameObject](Scene& scene)
+    {
+        if (GameObject* object = scene.Resolve(gameObject))
+            object->RemoveComponent<T>();
+    });
+}
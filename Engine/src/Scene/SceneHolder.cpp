@@ -26,7 +26,15 @@ void SceneHolder::Update(float deltaTime)
     m_currentScene->OnUpdate(deltaTime);
 }
 
-void SceneHolder::Render(VulkanRenderer* renderer)
+void SceneHolder::UpdateView(float deltaTime, float alpha)
+{
+    if (!m_currentScene)
+        return;
+    
+    m_currentScene->UpdateView(deltaTime, alpha);
+}
+
+void SceneHolder::Render(IRenderer* renderer)
 {
     if (!m_currentScene)
         return;
@@ -13,7 +13,8 @@ class SceneHolder
     Scene* GetCurrentScene() const { return m_currentScene.get(); }
     
     void Update(float deltaTime);
-    void Render(VulkanRenderer* renderer);
+    void UpdateView(float deltaTime, float alpha);
+    void Render(IRenderer* renderer);
     
 private:
     std::unique_ptr<Scene> m_currentScene;
@@ -0,0 +1,815 @@
+﻿#include "SceneSerializer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "GameObject.h"
+#include "Scene.h"
+
+#include "Component/TransformComponent.h"
+#include "Core/ThreadPool.h"
+#include "Debug/Log.h"
+#include "Resource/Material.h"
+#include "Resource/Mesh.h"
+#include "Resource/ResourceManager.h"
+#include "Resource/Texture.h"
+#include "Utils/MappedFile.h"
+
+namespace
+{
+    constexpr char Magic[4] = { 'S', 'S', 'C', 'N' };
+    constexpr uint32_t InvalidIndex = UINT32_MAX;
+    // Rows encoded per task when saving, and tasks written to disk per batch
+    constexpr size_t ChunkSize = 4096;
+    constexpr size_t ChunksPerBatch = 64;
+
+    static_assert(sizeof(Vec2f) == 2 * sizeof(float) && sizeof(Vec3f) == 3 * sizeof(float));
+    static_assert(sizeof(Vec4f) == 4 * sizeof(float) && sizeof(Quat) == 4 * sizeof(float));
+
+    // Every block starts on 8 bytes so the records can be read in place from the mapping
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t fileSize;
+        uint32_t objectCount;
+        uint32_t typeCount;
+        uint32_t propertyCount;
+        uint32_t resourceCount;
+        uint64_t typesOffset;
+        uint64_t propertiesOffset;
+        uint64_t stringsOffset;
+        uint64_t stringsSize;
+        uint64_t objectsOffset;
+        uint64_t resourcesOffset;
+    };
+
+    struct StringRef
+    {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    struct ObjectRecord
+    {
+        uint64_t uuid;
+        // Index in the object block, a parent always comes first
+        uint32_t parent;
+        StringRef name;
+        float position[3];
+        float rotation[4];
+        float scale[3];
+        uint32_t layer;
+        uint64_t tags;
+    };
+
+    struct TypeRecord
+    {
+        StringRef name;
+        // Types are found by hash, the name is kept for the messages
+        ComponentTypeHash hash;
+        uint32_t count;
+        // A row is the object index followed by the property values
+        uint32_t stride;
+        uint32_t firstProperty;
+        uint32_t propertyCount;
+        uint64_t dataOffset;
+    };
+
+    struct PropertyRecord
+    {
+        StringRef name;
+        uint32_t type;
+        // In a row
+        uint32_t offset;
+    };
+
+    // Value of a Materials property, a range of the resource block
+    struct ResourceRange
+    {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    static_assert(sizeof(ObjectRecord) == 72 && sizeof(TypeRecord) == 40 && sizeof(PropertyRecord) == 16);
+
+    uint64_t Align(uint64_t offset)
+    {
+        return (offset + 7) & ~uint64_t(7);
+    }
+
+    // 0 for the types that are not stored
+    uint32_t GetValueSize(PropertyType type)
+    {
+        switch (type)
+        {
+        case PropertyType::Bool:
+        case PropertyType::Float:
+        case PropertyType::Int:
+            return 4;
+        case PropertyType::Vec2f:
+            return sizeof(Vec2f);
+        case PropertyType::Vec3f:
+        case PropertyType::Color3:
+            return sizeof(Vec3f);
+        case PropertyType::Vec4f:
+        case PropertyType::Color4:
+            return sizeof(Vec4f);
+        case PropertyType::Quat:
+            return sizeof(Quat);
+        case PropertyType::Texture:
+        case PropertyType::Mesh:
+        case PropertyType::Material:
+            return sizeof(uint64_t);
+        case PropertyType::Materials:
+            return sizeof(ResourceRange);
+        default:
+            return 0;
+        }
+    }
+
+    uint64_t GetResourceUUID(const IResource* resource)
+    {
+        return resource ? static_cast<uint64_t>(resource->GetUUID()) : UUID_INVALID;
+    }
+
+    // Materials ranges are relative to the resources of the chunk until the chunk is written
+    void EncodeValue(const Property& property, uint8_t* out, std::vector<uint64_t>& resources)
+    {
+        switch (property.type)
+        {
+        case PropertyType::Bool:
+        {
+            const uint32_t value = *static_cast<const bool*>(property.data) ? 1 : 0;
+            std::memcpy(out, &value, sizeof(value));
+            break;
+        }
+        case PropertyType::Texture:
+        {
+            const uint64_t uuid = GetResourceUUID(static_cast<const SafePtr<Texture>*>(property.data)->getPtr());
+            std::memcpy(out, &uuid, sizeof(uuid));
+            break;
+        }
+        case PropertyType::Mesh:
+        {
+            const uint64_t uuid = GetResourceUUID(static_cast<const SafePtr<Mesh>*>(property.data)->getPtr());
+            std::memcpy(out, &uuid, sizeof(uuid));
+            break;
+        }
+        case PropertyType::Material:
+        {
+            const uint64_t uuid = GetResourceUUID(static_cast<const SafePtr<Material>*>(property.data)->getPtr());
+            std::memcpy(out, &uuid, sizeof(uuid));
+            break;
+        }
+        case PropertyType::Materials:
+        {
+            const auto& materials = *static_cast<const std::vector<SafePtr<Material>>*>(property.data);
+            const ResourceRange range = { static_cast<uint32_t>(resources.size()), static_cast<uint32_t>(materials.size()) };
+            for (const SafePtr<Material>& material : materials)
+            {
+                resources.push_back(GetResourceUUID(material.getPtr()));
+            }
+            std::memcpy(out, &range, sizeof(range));
+            break;
+        }
+        default:
+            // Plain values, same layout in memory and on disk
+            std::memcpy(out, property.data, GetValueSize(property.type));
+            break;
+        }
+    }
+
+    template<typename T>
+    void ApplyValue(const Property& property, T value)
+    {
+        if (property.setter)
+            property.setter(&value);
+        else
+            *static_cast<T*>(property.data) = value;
+    }
+
+    template<typename T>
+    T ReadValue(const uint8_t* in)
+    {
+        T value;
+        std::memcpy(&value, in, sizeof(T));
+        return value;
+    }
+
+    // Resource setters take a shared_ptr like in the Inspector
+    template<typename T>
+    void ApplyResource(const Property& property, uint64_t uuid, const ResourceManager& resourceManager)
+    {
+        std::shared_ptr<T> resource = uuid != UUID_INVALID ? resourceManager.GetResource<T>(uuid) : nullptr;
+        if (property.setter)
+            property.setter(&resource);
+        else
+            *static_cast<SafePtr<T>*>(property.data) = resource;
+    }
+
+    struct LoadContext
+    {
+        const uint64_t* resources;
+        uint32_t resourceCount;
+        const ResourceManager* resourceManager;
+    };
+
+    void DecodeValue(const Property& property, const uint8_t* in, const LoadContext& context)
+    {
+        switch (property.type)
+        {
+        case PropertyType::Bool:
+            ApplyValue(property, ReadValue<uint32_t>(in) != 0);
+            break;
+        case PropertyType::Float:
+            ApplyValue(property, ReadValue<float>(in));
+            break;
+        case PropertyType::Int:
+            ApplyValue(property, ReadValue<int>(in));
+            break;
+        case PropertyType::Vec2f:
+            ApplyValue(property, ReadValue<Vec2f>(in));
+            break;
+        case PropertyType::Vec3f:
+        case PropertyType::Color3:
+            ApplyValue(property, ReadValue<Vec3f>(in));
+            break;
+        case PropertyType::Vec4f:
+        case PropertyType::Color4:
+            ApplyValue(property, ReadValue<Vec4f>(in));
+            break;
+        case PropertyType::Quat:
+            ApplyValue(property, ReadValue<Quat>(in));
+            break;
+        case PropertyType::Texture:
+            if (context.resourceManager)
+                ApplyResource<Texture>(property, ReadValue<uint64_t>(in), *context.resourceManager);
+            break;
+        case PropertyType::Mesh:
+            if (context.resourceManager)
+                ApplyResource<Mesh>(property, ReadValue<uint64_t>(in), *context.resourceManager);
+            break;
+        case PropertyType::Material:
+            if (context.resourceManager)
+                ApplyResource<Material>(property, ReadValue<uint64_t>(in), *context.resourceManager);
+            break;
+        case PropertyType::Materials:
+        {
+            const ResourceRange range = ReadValue<ResourceRange>(in);
+            if (!context.resourceManager || range.first > context.resourceCount || range.count > context.resourceCount - range.first)
+                break;
+
+            std::vector<SafePtr<Material>> materials;
+            materials.reserve(range.count);
+            for (uint32_t i = 0; i < range.count; i++)
+            {
+                const uint64_t uuid = context.resources[range.first + i];
+                materials.emplace_back(uuid != UUID_INVALID ? context.resourceManager->GetResource<Material>(uuid) : nullptr);
+            }
+            ApplyValue(property, std::move(materials));
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    class StringTable
+    {
+    public:
+        StringRef Add(std::string_view string)
+        {
+            const StringRef ref = { static_cast<uint32_t>(m_data.size()), static_cast<uint32_t>(string.size()) };
+            m_data.append(string);
+            return ref;
+        }
+
+        const std::string& GetData() const { return m_data; }
+
+    private:
+        std::string m_data;
+    };
+
+    class FileWriter
+    {
+    public:
+        FileWriter(const std::filesystem::path& path) : m_stream(path, std::ios::binary | std::ios::trunc) {}
+
+        bool IsValid() const { return m_stream.good(); }
+        uint64_t GetPosition() const { return m_position; }
+
+        void Write(const void* data, size_t size)
+        {
+            m_stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            m_position += size;
+        }
+
+        void PadTo(uint64_t position)
+        {
+            static constexpr char zeros[8] = {};
+            ASSERT(position >= m_position && position - m_position <= sizeof(zeros))
+            Write(zeros, position - m_position);
+        }
+
+        // The header is written last, once the size of the resource block is known
+        void Rewrite(uint64_t position, const void* data, size_t size)
+        {
+            m_stream.seekp(static_cast<std::streamoff>(position));
+            m_stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            m_stream.seekp(static_cast<std::streamoff>(m_position));
+        }
+
+    private:
+        std::ofstream m_stream;
+        uint64_t m_position = 0;
+    };
+
+    // Encodes count rows on the thread pool, a batch of chunks at a time, each batch is written before the next one starts.
+    // encode(row, out, resources) fills one row, resourceRanges are the offsets of the Materials values to rebase.
+    template<typename F>
+    void WriteRows(FileWriter& writer, size_t count, uint32_t stride, const std::vector<uint32_t>& resourceRanges, std::vector<uint64_t>& resources, F&& encode)
+    {
+        std::vector<uint8_t> buffer;
+        std::vector<std::vector<uint64_t>> chunkResources;
+        for (size_t batchBegin = 0; batchBegin < count; batchBegin += ChunkSize * ChunksPerBatch)
+        {
+            const size_t batchEnd = std::min(count, batchBegin + ChunkSize * ChunksPerBatch);
+            const size_t chunkCount = (batchEnd - batchBegin + ChunkSize - 1) / ChunkSize;
+
+            buffer.assign((batchEnd - batchBegin) * stride, 0);
+            chunkResources.resize(chunkCount);
+            ThreadPool::ParallelFor(chunkCount, [&](size_t begin, size_t end)
+            {
+                for (size_t chunk = begin; chunk < end; chunk++)
+                {
+                    chunkResources[chunk].clear();
+                    const size_t rowBegin = batchBegin + chunk * ChunkSize;
+                    const size_t rowEnd = std::min(batchEnd, rowBegin + ChunkSize);
+                    for (size_t row = rowBegin; row < rowEnd; row++)
+                    {
+                        encode(row, buffer.data() + (row - batchBegin) * stride, chunkResources[chunk]);
+                    }
+                }
+            });
+
+            for (size_t chunk = 0; chunk < chunkCount; chunk++)
+            {
+                if (chunkResources[chunk].empty())
+                    continue;
+
+                const uint32_t base = static_cast<uint32_t>(resources.size());
+                const size_t rowBegin = chunk * ChunkSize;
+                const size_t rowEnd = std::min(batchEnd - batchBegin, rowBegin + ChunkSize);
+                for (size_t row = rowBegin; row < rowEnd; row++)
+                {
+                    for (uint32_t offset : resourceRanges)
+                    {
+                        uint8_t* value = buffer.data() + row * stride + offset;
+                        ResourceRange range = ReadValue<ResourceRange>(value);
+                        range.first += base;
+                        std::memcpy(value, &range, sizeof(range));
+                    }
+                }
+                resources.insert(resources.end(), chunkResources[chunk].begin(), chunkResources[chunk].end());
+            }
+
+            writer.Write(buffer.data(), buffer.size());
+        }
+    }
+
+    bool IsInFile(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t fileSize)
+    {
+        return offset <= fileSize && (elementSize == 0 || count <= (fileSize - offset) / elementSize);
+    }
+}
+
+bool SceneSerializer::Save(Scene& scene, const std::filesystem::path& path)
+{
+    struct SavedProperty
+    {
+        // In the ClassDescriptor of the type
+        size_t index;
+        PropertyType type;
+        uint32_t offset;
+    };
+
+    struct SavedType
+    {
+        std::vector<IComponent*> components;
+        std::vector<SavedProperty> properties;
+        std::vector<uint32_t> resourceRanges;
+        TypeRecord record;
+    };
+
+    std::scoped_lock lock(scene.m_gameObjectsMutex, scene.m_componentsMutex);
+
+    GameObject* root = scene.GetRootObject().getPtr();
+    if (!root)
+        return false;
+
+    // The subtree of the root is already in file order
+    const TransformHierarchy& hierarchy = scene.m_transformHierarchy;
+    const uint32_t rootIndex = root->ResolveTransform()->GetHierarchyIndex();
+    const uint32_t firstIndex = rootIndex + 1;
+    const uint32_t objectCount = hierarchy.GetSubtreeSize(rootIndex) - 1;
+
+    StringTable strings;
+    std::vector<StringRef> objectNames(objectCount);
+    for (uint32_t i = 0; i < objectCount; i++)
+    {
+        objectNames[i] = strings.Add(hierarchy.GetOwner(firstIndex + i)->GetGameObject()->GetName());
+    }
+
+    // Transforms are part of the object records
+    const ComponentID transformID = ComponentRegister::GetComponentID<TransformComponent>();
+    std::vector<SavedType> types;
+    std::vector<PropertyRecord> properties;
+    for (ComponentID id = 0; id < scene.m_components.size(); id++)
+    {
+        const ComponentArray& array = scene.m_components[id];
+        if (id == transformID || array.components.empty())
+            continue;
+
+        SavedType type = {};
+        for (IComponent* component : array.components)
+        {
+            // Objects outside of the root are not saved
+            const uint32_t index = component->GetGameObject()->ResolveTransform()->GetHierarchyIndex();
+            if (index >= firstIndex && index - firstIndex < objectCount)
+                type.components.push_back(component);
+        }
+        if (type.components.empty())
+            continue;
+
+        // Every instance of a type describes the same properties
+        ClassDescriptor descriptor;
+        type.components.front()->Describe(descriptor);
+        type.record.firstProperty = static_cast<uint32_t>(properties.size());
+        uint32_t stride = sizeof(uint32_t);
+        for (size_t i = 0; i < descriptor.properties.size(); i++)
+        {
+            const Property& property = descriptor.properties[i];
+            const uint32_t size = GetValueSize(property.type);
+            if (size == 0)
+                continue;
+
+            type.properties.push_back({ i, property.type, stride });
+            if (property.type == PropertyType::Materials)
+                type.resourceRanges.push_back(stride);
+            properties.push_back({ strings.Add(property.name), static_cast<uint32_t>(property.type), stride });
+            stride += size;
+        }
+
+        type.record.name = strings.Add(type.components.front()->GetTypeName());
+        type.record.hash = HashComponentName(type.components.front()->GetTypeName());
+        type.record.count = static_cast<uint32_t>(type.components.size());
+        type.record.stride = stride;
+        type.record.propertyCount = static_cast<uint32_t>(type.properties.size());
+        types.push_back(std::move(type));
+    }
+
+    FileHeader header = {};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.objectCount = objectCount;
+    header.typeCount = static_cast<uint32_t>(types.size());
+    header.propertyCount = static_cast<uint32_t>(properties.size());
+    header.typesOffset = Align(sizeof(FileHeader));
+    header.propertiesOffset = Align(header.typesOffset + types.size() * sizeof(TypeRecord));
+    header.stringsOffset = Align(header.propertiesOffset + properties.size() * sizeof(PropertyRecord));
+    header.stringsSize = strings.GetData().size();
+    header.objectsOffset = Align(header.stringsOffset + header.stringsSize);
+    uint64_t offset = header.objectsOffset + uint64_t(objectCount) * sizeof(ObjectRecord);
+    for (SavedType& type : types)
+    {
+        type.record.dataOffset = Align(offset);
+        offset = type.record.dataOffset + uint64_t(type.record.count) * type.record.stride;
+    }
+    header.resourcesOffset = Align(offset);
+
+    FileWriter writer(path);
+    if (!writer.IsValid())
+    {
+        PrintError("Failed to open scene file %s", path.generic_string().c_str());
+        return false;
+    }
+
+    writer.Write(&header, sizeof(header));
+    writer.PadTo(header.typesOffset);
+    for (const SavedType& type : types)
+    {
+        writer.Write(&type.record, sizeof(TypeRecord));
+    }
+    writer.PadTo(header.propertiesOffset);
+    writer.Write(properties.data(), properties.size() * sizeof(PropertyRecord));
+    writer.PadTo(header.stringsOffset);
+    writer.Write(strings.GetData().data(), strings.GetData().size());
+    writer.PadTo(header.objectsOffset);
+
+    std::vector<uint64_t> resources;
+    WriteRows(writer, objectCount, sizeof(ObjectRecord), {}, resources, [&](size_t row, uint8_t* out, std::vector<uint64_t>&)
+    {
+        const uint32_t index = firstIndex + static_cast<uint32_t>(row);
+        TransformComponent* transform = hierarchy.GetOwner(index);
+        const TransformComponent* parent = hierarchy.GetParent(index);
+        const TransformLocal& local = hierarchy.GetLocal(index);
+
+        ObjectRecord record = {};
+        record.uuid = transform->GetGameObject()->GetUUID();
+        record.parent = parent && parent->GetHierarchyIndex() != rootIndex ? parent->GetHierarchyIndex() - firstIndex : InvalidIndex;
+        record.name = objectNames[row];
+        std::memcpy(record.position, &local.position, sizeof(record.position));
+        std::memcpy(record.rotation, &local.rotation, sizeof(record.rotation));
+        std::memcpy(record.scale, &local.scale, sizeof(record.scale));
+        record.layer = transform->GetGameObject()->GetLayer();
+        record.tags = transform->GetGameObject()->GetTags();
+        std::memcpy(out, &record, sizeof(record));
+    });
+
+    for (const SavedType& type : types)
+    {
+        writer.PadTo(type.record.dataOffset);
+        WriteRows(writer, type.components.size(), type.record.stride, type.resourceRanges, resources, [&](size_t row, uint8_t* out, std::vector<uint64_t>& chunkResources)
+        {
+            IComponent* component = type.components[row];
+            const uint32_t objectIndex = component->GetGameObject()->ResolveTransform()->GetHierarchyIndex() - firstIndex;
+            std::memcpy(out, &objectIndex, sizeof(objectIndex));
+
+            ClassDescriptor descriptor;
+            component->Describe(descriptor);
+            for (const SavedProperty& saved : type.properties)
+            {
+                if (saved.index < descriptor.properties.size() && descriptor.properties[saved.index].type == saved.type)
+                    EncodeValue(descriptor.properties[saved.index], out + saved.offset, chunkResources);
+            }
+        });
+    }
+
+    writer.PadTo(header.resourcesOffset);
+    writer.Write(resources.data(), resources.size() * sizeof(uint64_t));
+
+    header.resourceCount = static_cast<uint32_t>(resources.size());
+    header.fileSize = writer.GetPosition();
+    writer.Rewrite(0, &header, sizeof(header));
+
+    if (!writer.IsValid())
+    {
+        PrintError("Failed to write scene file %s", path.generic_string().c_str());
+        return false;
+    }
+    return true;
+}
+
+bool SceneSerializer::Load(Scene& scene, const std::filesystem::path& path, const ComponentRegister& componentRegister, const ResourceManager* resourceManager)
+{
+    SceneFileReader reader;
+    if (!reader.Open(path))
+        return false;
+
+    reader.Instantiate(scene, scene.GetRootObject()->GetHandle(), componentRegister, resourceManager, SIZE_MAX);
+    return true;
+}
+
+struct SceneFileReader::State
+{
+    MappedFile file;
+    FileHeader header;
+    const TypeRecord* types = nullptr;
+    const PropertyRecord* properties = nullptr;
+    const ObjectRecord* objects = nullptr;
+    const char* strings = nullptr;
+    LoadContext context = {};
+
+    std::string_view GetString(StringRef ref) const
+    {
+        if (ref.offset > header.stringsSize || ref.size > header.stringsSize - ref.offset)
+            return {};
+        return { strings + ref.offset, ref.size };
+    }
+
+    // Progress, objects first then the rows of each type
+    uint32_t nextObject = 0;
+    uint32_t nextType = 0;
+    uint32_t nextRow = 0;
+    std::vector<Handle<GameObject>> created;
+    // Of the current type, null when the register does not know it
+    const ComponentTypeInfo* typeInfo = nullptr;
+    bool typeStarted = false;
+    bool mapped = false;
+    // Saved property index, index in the descriptor
+    std::vector<std::pair<uint32_t, size_t>> propertyMap;
+    ClassDescriptor descriptor;
+};
+
+SceneFileReader::SceneFileReader() = default;
+
+SceneFileReader::~SceneFileReader() = default;
+
+bool SceneFileReader::Open(const std::filesystem::path& path)
+{
+    m_path = path;
+    m_componentCount = 0;
+    m_state = std::make_unique<State>();
+    State& state = *m_state;
+    if (!state.file.Open(path))
+    {
+        m_state.reset();
+        return false;
+    }
+
+    const uint8_t* data = state.file.GetData();
+    const uint64_t fileSize = state.file.GetSize();
+    auto fail = [&](const char* message)
+    {
+        PrintError(message, path.generic_string().c_str());
+        m_state.reset();
+        return false;
+    };
+
+    FileHeader& header = state.header;
+    if (fileSize < sizeof(FileHeader))
+        return fail("Invalid scene file %s");
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.fileSize != fileSize)
+        return fail("Invalid scene file %s");
+    if (header.version != SceneSerializer::Version)
+    {
+        PrintError("Scene file %s has version %u, expected %u", path.generic_string().c_str(), header.version, SceneSerializer::Version);
+        m_state.reset();
+        return false;
+    }
+
+    const bool aligned = header.typesOffset % 8 == 0 && header.propertiesOffset % 8 == 0 && header.objectsOffset % 8 == 0 && header.resourcesOffset % 8 == 0;
+    if (!aligned
+        || !IsInFile(header.typesOffset, header.typeCount, sizeof(TypeRecord), fileSize)
+        || !IsInFile(header.propertiesOffset, header.propertyCount, sizeof(PropertyRecord), fileSize)
+        || !IsInFile(header.stringsOffset, header.stringsSize, 1, fileSize)
+        || !IsInFile(header.objectsOffset, header.objectCount, sizeof(ObjectRecord), fileSize)
+        || !IsInFile(header.resourcesOffset, header.resourceCount, sizeof(uint64_t), fileSize))
+    {
+        return fail("Corrupted scene file %s");
+    }
+
+    // Read in place from the mapping
+    state.types = reinterpret_cast<const TypeRecord*>(data + header.typesOffset);
+    state.properties = reinterpret_cast<const PropertyRecord*>(data + header.propertiesOffset);
+    state.objects = reinterpret_cast<const ObjectRecord*>(data + header.objectsOffset);
+    state.strings = reinterpret_cast<const char*>(data + header.stringsOffset);
+    state.context = { reinterpret_cast<const uint64_t*>(data + header.resourcesOffset), header.resourceCount, nullptr };
+
+    // Every block is checked here, instantiation cannot fail halfway
+    for (uint32_t typeIndex = 0; typeIndex < header.typeCount; typeIndex++)
+    {
+        const TypeRecord& type = state.types[typeIndex];
+        if (type.stride < sizeof(uint32_t)
+            || type.dataOffset % 4 != 0
+            || !IsInFile(type.dataOffset, type.count, type.stride, fileSize)
+            || type.firstProperty > header.propertyCount || type.propertyCount > header.propertyCount - type.firstProperty)
+        {
+            return fail("Corrupted scene file %s");
+        }
+        m_componentCount += type.count;
+    }
+
+    // Faults the pages in now, on this thread, instead of during Instantiate
+    volatile uint8_t sink = 0;
+    for (uint64_t offset = 0; offset < fileSize; offset += 4096)
+        sink = sink + data[offset];
+
+    state.created.reserve(header.objectCount);
+    return true;
+}
+
+bool SceneFileReader::IsOpen() const
+{
+    return m_state != nullptr;
+}
+
+bool SceneFileReader::IsDone() const
+{
+    return m_state && m_state->nextObject == m_state->header.objectCount && m_state->nextType == m_state->header.typeCount;
+}
+
+uint32_t SceneFileReader::GetObjectCount() const
+{
+    return m_state ? m_state->header.objectCount : 0;
+}
+
+size_t SceneFileReader::GetFileSize() const
+{
+    return m_state ? m_state->file.GetSize() : 0;
+}
+
+bool SceneFileReader::Instantiate(Scene& scene, Handle<GameObject> parent, const ComponentRegister& componentRegister, const ResourceManager* resourceManager, size_t maxItems)
+{
+    ASSERT(m_state)
+    State& state = *m_state;
+    const FileHeader& header = state.header;
+    state.context.resourceManager = resourceManager;
+
+    std::scoped_lock lock(scene.m_gameObjectsMutex, scene.m_componentsMutex);
+    if (state.nextObject == 0 && header.objectCount > 0)
+        scene.ReserveGameObjects(header.objectCount);
+
+    GameObject* root = scene.Resolve(parent);
+    if (!root)
+        root = scene.GetRootObject().getPtr();
+
+    size_t items = 0;
+    for (; state.nextObject < header.objectCount && items < maxItems; state.nextObject++, items++)
+    {
+        const uint32_t i = state.nextObject;
+        const ObjectRecord& record = state.objects[i];
+        // Falls back to the root when the parent was destroyed in between
+        GameObject* objectParent = record.parent < i ? scene.Resolve(state.created[record.parent]) : root;
+        GameObject* object = scene.CreateGameObject(objectParent ? objectParent : root, record.uuid).getPtr();
+        object->SetName(Name(state.GetString(record.name)));
+        object->SetLayer(static_cast<uint8_t>(std::min<uint32_t>(record.layer, MaxLayers - 1)));
+        object->SetTags(record.tags);
+
+        Vec3f position;
+        Quat rotation;
+        Vec3f scale;
+        std::memcpy(&position, record.position, sizeof(position));
+        std::memcpy(&rotation, record.rotation, sizeof(rotation));
+        std::memcpy(&scale, record.scale, sizeof(scale));
+        TransformComponent* transform = object->ResolveTransform();
+        transform->SetLocalPosition(position);
+        transform->SetLocalRotation(rotation);
+        transform->SetLocalScale(scale);
+        state.created.push_back(object->GetHandle());
+    }
+
+    while (state.nextObject == header.objectCount && state.nextType < header.typeCount && items < maxItems)
+    {
+        const TypeRecord& type = state.types[state.nextType];
+        if (!state.typeStarted)
+        {
+            state.typeStarted = true;
+            state.mapped = false;
+            state.propertyMap.clear();
+            const std::string_view typeName = state.GetString(type.name);
+            state.typeInfo = componentRegister.Find(type.hash);
+            if (!state.typeInfo)
+                PrintWarning("Scene file %s: unknown component type %.*s", m_path.generic_string().c_str(), static_cast<int>(typeName.size()), typeName.data());
+        }
+
+        const uint8_t* rows = state.file.GetData() + type.dataOffset;
+        for (; state.typeInfo && state.nextRow < type.count && items < maxItems; state.nextRow++, items++)
+        {
+            const uint8_t* values = rows + uint64_t(state.nextRow) * type.stride;
+            const uint32_t objectIndex = ReadValue<uint32_t>(values);
+            if (objectIndex >= header.objectCount)
+                continue;
+            GameObject* object = scene.Resolve(state.created[objectIndex]);
+            if (!object)
+                continue;
+
+            IComponent* component = state.typeInfo->AddTo(object);
+            ClassDescriptor& descriptor = state.descriptor;
+            descriptor.properties.clear();
+            component->Describe(descriptor);
+
+            // Matched by name and type on the first component, properties missing from the file keep their default
+            if (!state.mapped)
+            {
+                state.mapped = true;
+                for (uint32_t i = 0; i < type.propertyCount; i++)
+                {
+                    const PropertyRecord& saved = state.properties[type.firstProperty + i];
+                    const uint32_t size = GetValueSize(static_cast<PropertyType>(saved.type));
+                    if (size == 0 || saved.offset < sizeof(uint32_t) || saved.offset > type.stride || size > type.stride - saved.offset)
+                        continue;
+
+                    const std::string_view name = state.GetString(saved.name);
+                    auto it = std::ranges::find_if(descriptor.properties, [&](const Property& property)
+                    {
+                        return property.name == name && static_cast<uint32_t>(property.type) == saved.type;
+                    });
+                    if (it != descriptor.properties.end())
+                        state.propertyMap.emplace_back(type.firstProperty + i, it - descriptor.properties.begin());
+                }
+            }
+
+            for (const auto& [savedIndex, index] : state.propertyMap)
+            {
+                if (index < descriptor.properties.size())
+                    DecodeValue(descriptor.properties[index], values + state.properties[savedIndex].offset, state.context);
+            }
+        }
+
+        if (!state.typeInfo || state.nextRow == type.count)
+        {
+            state.nextType++;
+            state.nextRow = 0;
+            state.typeStarted = false;
+        }
+    }
+    return IsDone();
+}
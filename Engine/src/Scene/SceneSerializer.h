@@ -0,0 +1,57 @@
+﻿#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+#include "Utils/Handle.h"
+
+class Scene;
+class GameObject;
+class ComponentRegister;
+class ResourceManager;
+
+// Binary scene files: GameObjects in hierarchy order, then the properties of each component type in a block of fixed size rows.
+// Loading maps the file and reads the blocks in place, saving encodes the blocks on the thread pool and streams them to disk.
+// Only the properties of a ClassDescriptor with a fixed size are stored, resources are stored by UUID.
+class SceneSerializer
+{
+public:
+    static constexpr uint32_t Version = 3;
+
+    // Saves every object under the root, not the root itself
+    static bool Save(Scene& scene, const std::filesystem::path& path);
+    // Adds the saved objects under the root of the scene. Component types are found by name hash in the register,
+    // resource properties are only restored with a resource manager.
+    static bool Load(Scene& scene, const std::filesystem::path& path, const ComponentRegister& componentRegister, const ResourceManager* resourceManager = nullptr);
+};
+
+// A scene file mapped and checked by Open, which can run on any thread, then added to a scene a few objects at a time
+// by Instantiate on the main thread, so that a large file does not stall a frame.
+class SceneFileReader
+{
+public:
+    SceneFileReader();
+    SceneFileReader(const SceneFileReader&) = delete;
+    SceneFileReader& operator=(const SceneFileReader&) = delete;
+    ~SceneFileReader();
+
+    // Also reads every page of the file, instantiating never waits on the disk
+    bool Open(const std::filesystem::path& path);
+    bool IsOpen() const;
+
+    // Adds up to maxItems objects or components under parent, the root when it was destroyed.
+    // Returns true once the whole file is in the scene.
+    bool Instantiate(Scene& scene, Handle<GameObject> parent, const ComponentRegister& componentRegister, const ResourceManager* resourceManager, size_t maxItems);
+    bool IsDone() const;
+
+    uint32_t GetObjectCount() const;
+    uint64_t GetComponentCount() const { return m_componentCount; }
+    size_t GetFileSize() const;
+
+private:
+    struct State;
+
+    std::filesystem::path m_path;
+    std::unique_ptr<State> m_state;
+    uint64_t m_componentCount = 0;
+};
@@ -0,0 +1,99 @@
+﻿#include "SceneView.h"
+
+#include <algorithm>
+
+#include "GameObject.h"
+
+ComponentQuery::ComponentQuery(std::vector<ComponentID> ids) : m_ids(std::move(ids))
+{
+    for (ComponentID id : m_ids)
+        m_mask.set(id);
+}
+
+void ComponentQuery::Update(GameObject* gameObject, const ComponentMask& mask, const std::vector<ComponentEntry>& components)
+{
+    const bool matches = (mask & m_mask) == m_mask;
+    auto it = m_indices.find(gameObject);
+    if (matches)
+    {
+        if (it != m_indices.end())
+        {
+            // A removed component may have had a sibling of the same type
+            FillRow(it->second, components);
+            return;
+        }
+
+        const size_t index = m_objects.size();
+        m_objects.push_back(gameObject);
+        m_rows.resize(m_rows.size() + m_ids.size());
+        m_indices.emplace(gameObject, index);
+        FillRow(index, components);
+        return;
+    }
+
+    if (it == m_indices.end())
+        return;
+
+    // Swap and pop, like the component arrays
+    const size_t index = it->second;
+    const size_t last = m_objects.size() - 1;
+    const size_t width = m_ids.size();
+    if (index != last)
+    {
+        m_objects[index] = m_objects[last];
+        std::copy_n(m_rows.begin() + static_cast<ptrdiff_t>(last * width), width, m_rows.begin() + static_cast<ptrdiff_t>(index * width));
+        m_indices[m_objects[index]] = index;
+    }
+    m_objects.pop_back();
+    m_rows.resize(last * width);
+    m_indices.erase(it);
+}
+
+void ComponentQuery::Remove(const std::vector<GameObject*>& gameObjects)
+{
+    if (gameObjects.size() * 4 < m_objects.size())
+    {
+        for (GameObject* gameObject : gameObjects)
+            Update(gameObject, ComponentMask(), {});
+        return;
+    }
+
+    // Most of the rows go, one pass that keeps the order of the others
+    std::vector<uint8_t> removed(m_objects.size(), false);
+    for (GameObject* gameObject : gameObjects)
+    {
+        auto it = m_indices.find(gameObject);
+        if (it == m_indices.end())
+            continue;
+        removed[it->second] = true;
+        m_indices.erase(it);
+    }
+
+    const size_t width = m_ids.size();
+    size_t write = 0;
+    for (size_t read = 0; read < m_objects.size(); read++)
+    {
+        if (removed[read])
+            continue;
+        if (write != read)
+        {
+            m_objects[write] = m_objects[read];
+            std::copy_n(m_rows.begin() + static_cast<ptrdiff_t>(read * width), width, m_rows.begin() + static_cast<ptrdiff_t>(write * width));
+            m_indices[m_objects[write]] = write;
+        }
+        write++;
+    }
+    m_objects.resize(write);
+    m_rows.resize(write * width);
+}
+
+void ComponentQuery::FillRow(size_t index, const std::vector<ComponentEntry>& components)
+{
+    IComponent** row = m_rows.data() + index * m_ids.size();
+    for (size_t i = 0; i < m_ids.size(); i++)
+    {
+        // First component of the type, like GetComponent
+        auto it = std::ranges::find(components, m_ids[i], &ComponentEntry::id);
+        row[i] = it != components.end() ? it->component : nullptr;
+    }
+}
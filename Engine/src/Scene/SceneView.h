@@ -0,0 +1,105 @@
+﻿#pragma once
+#include <cstddef>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "ComponentHandler.h"
+#include "Core/ThreadPool.h"
+
+class GameObject;
+struct ComponentEntry;
+
+// GameObjects having a component of every queried type, with one row of component pointers per object
+// in the order of the query. The scene keeps it up to date as components are attached and detached.
+class ComponentQuery
+{
+public:
+    ComponentQuery(std::vector<ComponentID> ids);
+
+    const std::vector<ComponentID>& GetIDs() const { return m_ids; }
+    const ComponentMask& GetMask() const { return m_mask; }
+
+    size_t Size() const { return m_objects.size(); }
+    GameObject* GetGameObject(size_t index) const { return m_objects[index]; }
+    IComponent* const* GetRow(size_t index) const { return m_rows.data() + index * m_ids.size(); }
+
+    // Adds, refreshes or removes the row of the object from its current components
+    void Update(GameObject* gameObject, const ComponentMask& mask, const std::vector<ComponentEntry>& components);
+    // Drops the rows of many objects at once, objects without a row are skipped
+    void Remove(const std::vector<GameObject*>& gameObjects);
+
+private:
+    void FillRow(size_t index, const std::vector<ComponentEntry>& components);
+private:
+    std::vector<ComponentID> m_ids;
+    ComponentMask m_mask;
+
+    std::vector<GameObject*> m_objects;
+    std::vector<IComponent*> m_rows;
+    std::unordered_map<const GameObject*, size_t> m_indices;
+};
+
+// Typed access to a ComponentQuery, iterates the matching components without per object lookups.
+// Valid until the next structural change of the scene, which never happens during the component update.
+template<typename... Ts>
+class SceneView
+{
+public:
+    class Iterator
+    {
+    public:
+        Iterator(const ComponentQuery* query, size_t index) : m_query(query), m_index(index) {}
+
+        std::tuple<Ts&...> operator*() const { return SceneView::Get(m_query, m_index); }
+        Iterator& operator++() { m_index++; return *this; }
+        bool operator==(const Iterator& other) const { return m_index == other.m_index; }
+        bool operator!=(const Iterator& other) const { return m_index != other.m_index; }
+    private:
+        const ComponentQuery* m_query;
+        size_t m_index;
+    };
+
+    SceneView(const ComponentQuery* query) : m_query(query) {}
+
+    size_t Size() const { return m_query->Size(); }
+    bool Empty() const { return m_query->Size() == 0; }
+    GameObject* GetGameObject(size_t index) const { return m_query->GetGameObject(index); }
+
+    Iterator begin() const { return Iterator(m_query, 0); }
+    Iterator end() const { return Iterator(m_query, m_query->Size()); }
+
+    // function(Ts&...) for every matching object
+    template<typename F>
+    void ForEach(F&& function) const
+    {
+        for (size_t i = 0; i < m_query->Size(); i++)
+            std::apply(function, Get(m_query, i));
+    }
+
+    // Same as ForEach with the objects split across the thread pool, function must only touch its own objects
+    template<typename F>
+    void ParallelForEach(F&& function, size_t minBlockSize = 64) const
+    {
+        ThreadPool::ParallelFor(m_query->Size(), [this, &function](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+                std::apply(function, Get(m_query, i));
+        }, minBlockSize);
+    }
+
+private:
+    static std::tuple<Ts&...> Get(const ComponentQuery* query, size_t index)
+    {
+        IComponent* const* row = query->GetRow(index);
+        return GetRow(row, std::index_sequence_for<Ts...>());
+    }
+
+    template<size_t... Is>
+    static std::tuple<Ts&...> GetRow(IComponent* const* row, std::index_sequence<Is...>)
+    {
+        return std::tuple<Ts&...>(*static_cast<Ts*>(row[Is])...);
+    }
+private:
+    const ComponentQuery* m_query;
+};
@@ -0,0 +1,400 @@
+#include "TransformHierarchy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "Component/TransformComponent.h"
+#include "Debug/Log.h"
+#include "Utils/BatchMath.h"
+
+void TransformHierarchy::Insert(TransformComponent* transform, TransformComponent* parent)
+{
+    ASSERT(!transform->m_hierarchy)
+
+    // Appended as a top level node, then moved under its parent
+    const uint32_t index = static_cast<uint32_t>(Size());
+    m_locals.push_back(transform->m_local);
+    m_worldMatrices.push_back(Mat4::Identity());
+    m_worlds.emplace_back();
+    m_parents.push_back(InvalidIndex);
+    m_subtreeSizes.push_back(1);
+    m_dirty.push_back(true);
+    m_versions.push_back(transform->m_version);
+    m_localBounds.emplace_back();
+    m_worldBounds.emplace_back();
+    m_owners.push_back(transform);
+    m_previousLocals.push_back(transform->m_local);
+    m_updatedLocals.push_back(transform->m_local);
+    m_renderMatrices.push_back(Mat4::Identity());
+    m_interpolated.push_back(false);
+    m_skipInterpolation.push_back(true);
+
+    transform->m_hierarchy = this;
+    transform->m_hierarchyIndex = index;
+
+    if (parent)
+        SetParent(transform, parent);
+}
+
+void TransformHierarchy::Reserve(size_t count)
+{
+    m_locals.reserve(count);
+    m_worldMatrices.reserve(count);
+    m_worlds.reserve(count);
+    m_parents.reserve(count);
+    m_subtreeSizes.reserve(count);
+    m_dirty.reserve(count);
+    m_versions.reserve(count);
+    m_localBounds.reserve(count);
+    m_worldBounds.reserve(count);
+    m_owners.reserve(count);
+    m_previousLocals.reserve(count);
+    m_updatedLocals.reserve(count);
+    m_renderMatrices.reserve(count);
+    m_interpolated.reserve(count);
+    m_skipInterpolation.reserve(count);
+}
+
+std::vector<TransformComponent*> TransformHierarchy::Remove(TransformComponent* transform)
+{
+    ASSERT(transform->m_hierarchy == this)
+
+    const uint32_t count = m_subtreeSizes[transform->m_hierarchyIndex];
+    MoveSubtree(transform->m_hierarchyIndex, static_cast<uint32_t>(Size()), InvalidIndex);
+
+    // The subtree is now at the end, the transforms keep their last values once detached
+    const size_t newSize = Size() - count;
+    for (size_t i = newSize; i < Size(); i++)
+    {
+        TransformComponent* owner = m_owners[i];
+        owner->m_local = m_locals[i];
+        owner->m_modelMatrix = m_worldMatrices[i];
+        owner->m_version = m_versions[i];
+        owner->m_hierarchy = nullptr;
+        owner->m_hierarchyIndex = InvalidIndex;
+    }
+
+    m_locals.resize(newSize);
+    m_worldMatrices.resize(newSize);
+    m_worlds.resize(newSize);
+    m_parents.resize(newSize);
+    m_subtreeSizes.resize(newSize);
+    m_dirty.resize(newSize);
+    m_versions.resize(newSize);
+    m_localBounds.resize(newSize);
+    m_worldBounds.resize(newSize);
+    m_previousLocals.resize(newSize);
+    m_updatedLocals.resize(newSize);
+    m_renderMatrices.resize(newSize);
+    m_interpolated.resize(newSize);
+    m_skipInterpolation.resize(newSize);
+    std::erase_if(m_changed, [](const TransformComponent* transform) { return !transform->m_hierarchy; });
+    {
+        std::scoped_lock lock(m_boundsChangedMutex);
+        std::erase_if(m_boundsChanged, [](const TransformComponent* transform) { return !transform->m_hierarchy; });
+    }
+
+    std::vector<TransformComponent*> removed(m_owners.begin() + static_cast<ptrdiff_t>(newSize), m_owners.end());
+    m_owners.resize(newSize);
+    return removed;
+}
+
+bool TransformHierarchy::SetParent(TransformComponent* transform, TransformComponent* parent)
+{
+    ASSERT(transform->m_hierarchy == this)
+
+    const uint32_t index = transform->m_hierarchyIndex;
+    const uint32_t parentIndex = parent ? parent->m_hierarchyIndex : InvalidIndex;
+    if (parentIndex != InvalidIndex)
+    {
+        ASSERT(parent->m_hierarchy == this)
+        if (parentIndex >= index && parentIndex < index + m_subtreeSizes[index])
+        {
+            PrintError("TransformHierarchy::SetParent: cannot parent a transform to one of its descendants");
+            return false;
+        }
+    }
+
+    const uint32_t position = parentIndex != InvalidIndex ? parentIndex + m_subtreeSizes[parentIndex] : static_cast<uint32_t>(Size());
+    MoveSubtree(index, position, parentIndex);
+    return true;
+}
+
+void TransformHierarchy::UpdateWorldMatrices()
+{
+    // Render matrices blended from the previous update are out of date
+    for (const TransformComponent* transform : m_changed)
+        m_interpolated[transform->m_hierarchyIndex] = false;
+    m_changed.clear();
+    const size_t size = Size();
+    for (size_t i = 0; i < size;)
+    {
+        if (!m_dirty[i])
+        {
+            i++;
+            continue;
+        }
+
+        // Parents come first, the whole subtree is recomputed front to back
+        const size_t end = i + m_subtreeSizes[i];
+        BatchMath::ComposeTransforms(&m_locals[i], &m_worldMatrices[i], end - i);
+        BatchMath::MultiplyByParents(m_worldMatrices.data(), m_parents.data(), i, end);
+        BatchMath::TransformBounds(&m_localBounds[i], &m_worldMatrices[i], &m_worldBounds[i], end - i);
+        for (size_t j = i; j < end; j++)
+        {
+            m_worlds[j] = ComputeWorld(static_cast<uint32_t>(j));
+            m_previousLocals[j] = m_skipInterpolation[j] ? m_locals[j] : m_updatedLocals[j];
+            m_updatedLocals[j] = m_locals[j];
+            m_skipInterpolation[j] = false;
+            m_versions[j]++;
+            m_dirty[j] = false;
+        }
+
+        for (size_t j = i; j < end; j++)
+        {
+            m_changed.push_back(m_owners[j]);
+            m_owners[j]->EOnUpdateModelMatrix.Invoke();
+        }
+        i = end;
+    }
+}
+
+void TransformHierarchy::Interpolate(float alpha)
+{
+    alpha = std::clamp(alpha, 0.0f, 1.0f);
+
+    // Parents first so their render matrix is ready for their children, moves since the update may have reordered
+    m_blendedIndices.clear();
+    for (const TransformComponent* transform : m_changed)
+        m_blendedIndices.push_back(transform->m_hierarchyIndex);
+    if (!std::is_sorted(m_blendedIndices.begin(), m_blendedIndices.end()))
+        std::sort(m_blendedIndices.begin(), m_blendedIndices.end());
+
+    m_blendedLocals.resize(m_blendedIndices.size());
+    for (size_t i = 0; i < m_blendedIndices.size(); i++)
+    {
+        const uint32_t index = m_blendedIndices[i];
+        const TransformLocal& from = m_previousLocals[index];
+        const TransformLocal& to = m_updatedLocals[index];
+        TransformLocal& blended = m_blendedLocals[i];
+        if (alpha >= 1.0f)
+        {
+            blended = to;
+            continue;
+        }
+        blended.position = from.position + (to.position - from.position) * alpha;
+        blended.scale = from.scale + (to.scale - from.scale) * alpha;
+
+        // Normalized lerp on the shortest arc, close enough to a slerp over one step
+        const float sign = from.rotation.x * to.rotation.x + from.rotation.y * to.rotation.y
+            + from.rotation.z * to.rotation.z + from.rotation.w * to.rotation.w < 0.0f ? -1.0f : 1.0f;
+        const float a = 1.0f - alpha;
+        const float b = alpha * sign;
+        Quat rotation(from.rotation.x * a + to.rotation.x * b, from.rotation.y * a + to.rotation.y * b,
+            from.rotation.z * a + to.rotation.z * b, from.rotation.w * a + to.rotation.w * b);
+        const float length = std::sqrt(rotation.x * rotation.x + rotation.y * rotation.y + rotation.z * rotation.z + rotation.w * rotation.w);
+        blended.rotation = length > 0.0f ? Quat(rotation.x / length, rotation.y / length, rotation.z / length, rotation.w / length) : to.rotation;
+    }
+
+    m_blendedMatrices.resize(m_blendedIndices.size());
+    BatchMath::ComposeTransforms(m_blendedLocals.data(), m_blendedMatrices.data(), m_blendedIndices.size());
+    for (size_t i = 0; i < m_blendedIndices.size(); i++)
+    {
+        const uint32_t index = m_blendedIndices[i];
+        // Reparented or teleported since the update, the blend would mix two parents
+        if (m_skipInterpolation[index])
+        {
+            m_interpolated[index] = false;
+            continue;
+        }
+
+        const uint32_t parent = m_parents[index];
+        if (parent == InvalidIndex)
+            m_renderMatrices[index] = m_blendedMatrices[i];
+        else
+            BatchMath::MultiplyMatrices(&GetRenderMatrix(parent), &m_blendedMatrices[i], &m_renderMatrices[index], 1);
+        m_interpolated[index] = true;
+    }
+}
+
+TransformWorld TransformHierarchy::ComputeWorld(uint32_t index) const
+{
+    const TransformLocal& local = m_locals[index];
+    const uint32_t parent = m_parents[index];
+    if (parent == InvalidIndex)
+        return { local.position, local.rotation, local.scale };
+
+    const TransformWorld& parentWorld = m_worlds[parent];
+    return {
+        m_worldMatrices[parent] * local.position,
+        parentWorld.rotation * local.rotation,
+        parentWorld.scale * local.scale
+    };
+}
+
+TransformWorld TransformHierarchy::ComputeCurrentWorld(uint32_t index, Mat4* matrix) const
+{
+    // The parent of the topmost dirty node was not changed since the last update, its world values hold
+    uint32_t top = InvalidIndex;
+    for (uint32_t i = index; i != InvalidIndex; i = m_parents[i])
+    {
+        if (m_dirty[i])
+            top = i;
+    }
+    if (top == InvalidIndex)
+    {
+        if (matrix)
+            *matrix = m_worldMatrices[index];
+        return m_worlds[index];
+    }
+
+    Mat4 composed;
+    const TransformWorld world = ComposeFrom(top, index, composed);
+    if (matrix)
+        *matrix = composed;
+    return world;
+}
+
+TransformWorld TransformHierarchy::ComposeFrom(uint32_t top, uint32_t index, Mat4& matrix) const
+{
+    const TransformLocal& local = m_locals[index];
+    Mat4 localMatrix;
+    BatchMath::ComposeTransforms(&local, &localMatrix, 1);
+
+    const uint32_t parent = m_parents[index];
+    if (index == top && parent == InvalidIndex)
+    {
+        matrix = localMatrix;
+        return { local.position, local.rotation, local.scale };
+    }
+
+    Mat4 parentMatrix;
+    const TransformWorld parentWorld = index == top ? m_worlds[parent] : ComposeFrom(top, parent, parentMatrix);
+    if (index == top)
+        parentMatrix = m_worldMatrices[parent];
+    BatchMath::MultiplyMatrices(&parentMatrix, &localMatrix, &matrix, 1);
+    return {
+        parentMatrix * local.position,
+        parentWorld.rotation * local.rotation,
+        parentWorld.scale * local.scale
+    };
+}
+
+void TransformHierarchy::SetLocalBounds(uint32_t index, const BoundingBox& bounds)
+{
+    m_localBounds[index] = bounds;
+    m_worldBounds[index] = bounds.IsValid() ? bounds.Transform(m_worldMatrices[index]) : BoundingBox();
+    m_versions[index]++;
+
+    std::scoped_lock lock(m_boundsChangedMutex);
+    m_boundsChanged.push_back(m_owners[index]);
+}
+
+std::vector<TransformComponent*> TransformHierarchy::TakeBoundsChanged()
+{
+    std::scoped_lock lock(m_boundsChangedMutex);
+    return std::exchange(m_boundsChanged, {});
+}
+
+TransformComponent* TransformHierarchy::GetParent(uint32_t index) const
+{
+    const uint32_t parent = m_parents[index];
+    return parent != InvalidIndex ? m_owners[parent] : nullptr;
+}
+
+std::vector<TransformComponent*> TransformHierarchy::GetChildren(uint32_t index) const
+{
+    std::vector<TransformComponent*> children;
+    const uint32_t end = index + m_subtreeSizes[index];
+    for (uint32_t child = index + 1; child < end; child += m_subtreeSizes[child])
+    {
+        children.push_back(m_owners[child]);
+    }
+    return children;
+}
+
+void TransformHierarchy::MoveSubtree(uint32_t index, uint32_t position, uint32_t newParent)
+{
+    const uint32_t count = m_subtreeSizes[index];
+
+    // Sizes first, while the ancestor chains still use the old indices
+    AddToAncestors(m_parents[index], -static_cast<int64_t>(count));
+    AddToAncestors(newParent, count);
+
+    // The subtree and the nodes it jumps over swap places, everything outside [begin, end) stays put
+    uint32_t begin = index;
+    uint32_t end = index + count;
+    uint32_t middle = index;
+    uint32_t destination = index;
+    if (position > index + count)
+    {
+        end = position;
+        middle = index + count;
+        destination = position - count;
+    }
+    else if (position < index)
+    {
+        begin = position;
+        destination = position;
+    }
+
+    if (middle != begin)
+    {
+        auto rotate = [&](auto& values)
+        {
+            std::rotate(values.begin() + begin, values.begin() + middle, values.begin() + end);
+        };
+        rotate(m_locals);
+        rotate(m_worldMatrices);
+        rotate(m_worlds);
+        rotate(m_parents);
+        rotate(m_subtreeSizes);
+        rotate(m_dirty);
+        rotate(m_versions);
+        rotate(m_localBounds);
+        rotate(m_worldBounds);
+        rotate(m_owners);
+        rotate(m_previousLocals);
+        rotate(m_updatedLocals);
+        rotate(m_renderMatrices);
+        rotate(m_interpolated);
+        rotate(m_skipInterpolation);
+    }
+
+    auto remap = [&](uint32_t i) -> uint32_t
+    {
+        if (i == InvalidIndex || i < begin || i >= end)
+            return i;
+        if (i >= index && i < index + count)
+            return i - index + destination;
+        return i < index ? i + count : i - count;
+    };
+
+    // Nodes past the range may have a parent inside it
+    for (size_t i = begin; i < Size(); i++)
+    {
+        m_parents[i] = remap(m_parents[i]);
+    }
+    m_parents[destination] = remap(newParent);
+    m_dirty[destination] = true;
+    std::fill_n(m_skipInterpolation.begin() + destination, count, true);
+
+    Reindex(begin, end);
+}
+
+void TransformHierarchy::AddToAncestors(uint32_t parent, int64_t count)
+{
+    for (uint32_t i = parent; i != InvalidIndex; i = m_parents[i])
+    {
+        m_subtreeSizes[i] = static_cast<uint32_t>(m_subtreeSizes[i] + count);
+    }
+}
+
+void TransformHierarchy::Reindex(uint32_t begin, uint32_t end)
+{
+    for (uint32_t i = begin; i < end; i++)
+    {
+        m_owners[i]->m_hierarchyIndex = i;
+    }
+}
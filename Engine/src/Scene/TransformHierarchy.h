@@ -0,0 +1,128 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <galaxymath/Maths.h>
+
+#include "Physic/BoundingBox.h"
+
+class TransformComponent;
+
+struct TransformLocal
+{
+    Vec3f position = Vec3f::Zero();
+    Quat rotation = Quat::Identity();
+    Vec3f scale = Vec3f::One();
+};
+
+// World position, rotation and scale decomposed while building the world matrix
+struct TransformWorld
+{
+    Vec3f position = Vec3f::Zero();
+    Quat rotation = Quat::Identity();
+    Vec3f scale = Vec3f::One();
+};
+
+// Transforms of one scene stored depth first: a parent always comes before its children,
+// and the children of a node are the contiguous range [index + 1, index + subtree size).
+// World matrices are computed in one linear pass that only walks dirty subtrees.
+// Each node has a version bumped whenever its world matrix or world bounds change, systems caching
+// anything derived from a transform compare versions instead of recomputing every frame.
+// The local values of the last two updates are kept so rendering can blend between two simulation steps.
+class TransformHierarchy
+{
+public:
+    static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+    TransformHierarchy() = default;
+    TransformHierarchy(const TransformHierarchy&) = delete;
+    TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+
+    // Adds the transform as the last child of parent, or as a top level node
+    void Insert(TransformComponent* transform, TransformComponent* parent);
+    // Removes the transform and all of its descendants, returned parents first
+    std::vector<TransformComponent*> Remove(TransformComponent* transform);
+    // Moves the transform and its descendants under a new parent, keeps the local values
+    bool SetParent(TransformComponent* transform, TransformComponent* parent);
+
+    void UpdateWorldMatrices();
+    // Transforms whose world matrix changed in the last UpdateWorldMatrices, parents first
+    const std::vector<TransformComponent*>& GetChanged() const { return m_changed; }
+    // Transforms whose local bounds were set since the last call
+    std::vector<TransformComponent*> TakeBoundsChanged();
+
+    size_t Size() const { return m_owners.size(); }
+    void Reserve(size_t count);
+
+    TransformLocal& GetLocal(uint32_t index) { return m_locals[index]; }
+    const TransformLocal& GetLocal(uint32_t index) const { return m_locals[index]; }
+    const Mat4& GetWorldMatrix(uint32_t index) const { return m_worldMatrices[index]; }
+    const TransformWorld& GetWorld(uint32_t index) const { return m_worlds[index]; }
+    // World values of the node from its current local values and the last world values of its parent
+    TransformWorld ComputeWorld(uint32_t index) const;
+    // World values from the current local values of the node and of its ancestors, up to date even when
+    // one of them changed since the last UpdateWorldMatrices. Only walks up to the topmost dirty ancestor.
+    // matrix, when given, receives the matching world matrix.
+    TransformWorld ComputeCurrentWorld(uint32_t index, Mat4* matrix = nullptr) const;
+    void SetDirty(uint32_t index) { m_dirty[index] = true; }
+    bool IsDirty(uint32_t index) const { return m_dirty[index]; }
+
+    // Render matrices of the transforms changed by the last UpdateWorldMatrices, alpha between their
+    // local values before (0) and after (1) it. Each blended local matrix is multiplied by the render
+    // matrix of the parent, so alpha 1 gives the world matrix whatever the parent scale and rotation.
+    // Nodes reparented or teleported since the update keep their world matrix.
+    void Interpolate(float alpha);
+    // Last interpolated matrix, the world matrix when the node was not changed by the last update
+    const Mat4& GetRenderMatrix(uint32_t index) const { return m_interpolated[index] ? m_renderMatrices[index] : m_worldMatrices[index]; }
+    // The next world change of the node is not blended, for teleports. New and reparented nodes are not either.
+    void SkipInterpolation(uint32_t index) { m_skipInterpolation[index] = true; }
+
+    uint64_t GetVersion(uint32_t index) const { return m_versions[index]; }
+    // Bounds in the space of the node, an invalid box (the default) has no world bounds. Thread safe for distinct nodes.
+    void SetLocalBounds(uint32_t index, const BoundingBox& bounds);
+    const BoundingBox& GetWorldBounds(uint32_t index) const { return m_worldBounds[index]; }
+
+    TransformComponent* GetOwner(uint32_t index) const { return m_owners[index]; }
+    TransformComponent* GetParent(uint32_t index) const;
+    uint32_t GetSubtreeSize(uint32_t index) const { return m_subtreeSizes[index]; }
+
+    // Direct children, in order
+    std::vector<TransformComponent*> GetChildren(uint32_t index) const;
+
+private:
+    // Moves the subtree at index so it ends up right before position, in pre-removal indices
+    void MoveSubtree(uint32_t index, uint32_t position, uint32_t newParent);
+    void AddToAncestors(uint32_t parent, int64_t count);
+    void Reindex(uint32_t begin, uint32_t end);
+    // World values and matrix of index from the local values of the chain from top down to it
+    TransformWorld ComposeFrom(uint32_t top, uint32_t index, Mat4& matrix) const;
+
+private:
+    std::vector<TransformLocal> m_locals;
+    std::vector<Mat4> m_worldMatrices;
+    std::vector<TransformWorld> m_worlds;
+    std::vector<uint32_t> m_parents;
+    std::vector<uint32_t> m_subtreeSizes;
+    // One byte per node so parallel component updates can flag their own transform
+    std::vector<uint8_t> m_dirty;
+    std::vector<uint64_t> m_versions;
+    std::vector<BoundingBox> m_localBounds;
+    std::vector<BoundingBox> m_worldBounds;
+    std::vector<TransformComponent*> m_owners;
+    // Local values used by the last two recomputes of each node
+    std::vector<TransformLocal> m_previousLocals;
+    std::vector<TransformLocal> m_updatedLocals;
+    std::vector<Mat4> m_renderMatrices;
+    std::vector<uint8_t> m_interpolated;
+    std::vector<uint8_t> m_skipInterpolation;
+
+    std::vector<TransformComponent*> m_changed;
+    // Reused by Interpolate
+    std::vector<uint32_t> m_blendedIndices;
+    std::vector<TransformLocal> m_blendedLocals;
+    std::vector<Mat4> m_blendedMatrices;
+    // Bounds are set from the parallel component updates
+    std::mutex m_boundsChangedMutex;
+    std::vector<TransformComponent*> m_boundsChanged;
+};
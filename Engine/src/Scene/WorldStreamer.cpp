@@ -0,0 +1,276 @@
+#include "WorldStreamer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+
+#include "GameObject.h"
+#include "Scene.h"
+
+#include "Core/ThreadPool.h"
+#include "Debug/Log.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Before a cell file is opened its memory is guessed from the file size
+    constexpr size_t GuessedBytesPerFileByte = 8;
+    // In the scene, per GameObject with its transform and per component
+    constexpr size_t ObjectMemory = 512;
+    constexpr size_t ComponentMemory = 128;
+    // Objects and components added between two checks of the frame budget
+    constexpr size_t IntegrationStep = 32;
+}
+
+WorldStreamer::WorldStreamer(Scene& scene, const ComponentRegister& componentRegister, const ResourceManager* resourceManager, const StreamingSettings& settings)
+    : m_scene(scene), m_componentRegister(componentRegister), m_resourceManager(resourceManager), m_settings(settings)
+{
+    m_settings.unloadRadius = std::max(m_settings.unloadRadius, m_settings.loadRadius);
+    m_settings.maxPendingLoads = std::max<size_t>(m_settings.maxPendingLoads, 1);
+}
+
+// Loads still running own their state, they are dropped when they finish
+WorldStreamer::~WorldStreamer() = default;
+
+void WorldStreamer::AddCell(const Vec3i& coordinates, const std::filesystem::path& path)
+{
+    const uint64_t key = GetKey(coordinates);
+    if (m_cellIndices.contains(key))
+    {
+        PrintWarning("Cell %d %d %d added twice", coordinates.x, coordinates.y, coordinates.z);
+        return;
+    }
+
+    Cell cell;
+    cell.coordinates = coordinates;
+    cell.path = path;
+    std::error_code error;
+    const uintmax_t fileSize = std::filesystem::file_size(path, error);
+    cell.estimate = error ? 0 : static_cast<size_t>(fileSize) * GuessedBytesPerFileByte;
+
+    m_cellIndices[key] = m_cells.size();
+    m_cells.push_back(std::move(cell));
+}
+
+void WorldStreamer::Update(const Vec3f& focus)
+{
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(m_settings.frameBudget));
+
+    for (Cell& cell : m_cells)
+    {
+        cell.distance = GetDistance(cell, focus);
+        if (cell.state == CellState::Loading && cell.load->done.load(std::memory_order_acquire))
+            FinishLoad(cell);
+        else if ((cell.state == CellState::Integrating || cell.state == CellState::Resident) && cell.distance > m_settings.unloadRadius)
+            BeginUnload(cell);
+    }
+
+    // Nearest first, a cell that does not fit in the memory budget waits for the ones being removed
+    m_order.clear();
+    for (size_t i = 0; i < m_cells.size(); i++)
+    {
+        const Cell& cell = m_cells[i];
+        if (cell.state == CellState::Unloaded && !cell.failed && cell.distance <= m_settings.loadRadius)
+            m_order.push_back(i);
+    }
+    std::ranges::sort(m_order, [this](size_t a, size_t b) { return m_cells[a].distance < m_cells[b].distance; });
+    for (size_t index : m_order)
+    {
+        if (m_pendingLoads >= m_settings.maxPendingLoads)
+            break;
+        Cell& cell = m_cells[index];
+        if (cell.estimate > m_settings.memoryBudget)
+        {
+            PrintError("Cell %s does not fit in the streaming memory budget", cell.path.generic_string().c_str());
+            cell.failed = true;
+            continue;
+        }
+        if (m_memory + cell.estimate > m_settings.memoryBudget)
+        {
+            // The memory of the cells being removed comes back first
+            if (GetCellCount(CellState::Unloading) == 0)
+                Evict(cell.distance);
+            break;
+        }
+        StartLoad(cell);
+    }
+
+    m_order.clear();
+    for (size_t i = 0; i < m_cells.size(); i++)
+    {
+        if (m_cells[i].state == CellState::Integrating)
+            m_order.push_back(i);
+    }
+    std::ranges::sort(m_order, [this](size_t a, size_t b) { return m_cells[a].distance < m_cells[b].distance; });
+    for (size_t index : m_order)
+    {
+        Cell& cell = m_cells[index];
+        while (Clock::now() < deadline)
+        {
+            if (cell.reader->Instantiate(m_scene, cell.root, m_componentRegister, m_resourceManager, IntegrationStep))
+            {
+                // The mapping is not needed anymore
+                SetMemory(cell, cell.memory - std::min(cell.memory, cell.reader->GetFileSize()));
+                cell.reader.reset();
+                cell.state = CellState::Resident;
+                break;
+            }
+        }
+    }
+
+    // At least one object per frame, so that leaving cells always free their memory
+    bool removed = false;
+    for (Cell& cell : m_cells)
+    {
+        if (cell.state != CellState::Unloading)
+            continue;
+        while (!cell.teardown.empty() && (!removed || Clock::now() < deadline))
+        {
+            m_scene.DestroyGameObject(m_scene.Resolve(cell.teardown.back()));
+            cell.teardown.pop_back();
+            removed = true;
+        }
+        if (cell.teardown.empty())
+        {
+            m_scene.DestroyGameObject(m_scene.Resolve(cell.root));
+            cell.root = {};
+            cell.state = CellState::Unloaded;
+            SetMemory(cell, 0);
+        }
+    }
+
+    m_lastUpdateTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+CellState WorldStreamer::GetCellState(const Vec3i& coordinates) const
+{
+    const Cell* cell = FindCell(coordinates);
+    return cell ? cell->state : CellState::Unloaded;
+}
+
+Handle<GameObject> WorldStreamer::GetCellRoot(const Vec3i& coordinates) const
+{
+    const Cell* cell = FindCell(coordinates);
+    return cell ? cell->root : Handle<GameObject>();
+}
+
+size_t WorldStreamer::GetCellCount(CellState state) const
+{
+    return static_cast<size_t>(std::ranges::count_if(m_cells, [state](const Cell& cell) { return cell.state == state; }));
+}
+
+uint64_t WorldStreamer::GetKey(const Vec3i& coordinates)
+{
+    constexpr uint64_t mask = (uint64_t(1) << 21) - 1;
+    return (static_cast<uint64_t>(coordinates.x) & mask)
+        | ((static_cast<uint64_t>(coordinates.y) & mask) << 21)
+        | ((static_cast<uint64_t>(coordinates.z) & mask) << 42);
+}
+
+const WorldStreamer::Cell* WorldStreamer::FindCell(const Vec3i& coordinates) const
+{
+    auto it = m_cellIndices.find(GetKey(coordinates));
+    return it != m_cellIndices.end() ? &m_cells[it->second] : nullptr;
+}
+
+float WorldStreamer::GetDistance(const Cell& cell, const Vec3f& focus) const
+{
+    // To the nearest point of the cell, 0 inside
+    const float size = m_settings.cellSize;
+    auto axis = [size](float value, int coordinate)
+    {
+        const float min = static_cast<float>(coordinate) * size;
+        return std::max({ min - value, 0.0f, value - (min + size) });
+    };
+    const float dx = axis(focus.x, cell.coordinates.x);
+    const float dy = axis(focus.y, cell.coordinates.y);
+    const float dz = axis(focus.z, cell.coordinates.z);
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+void WorldStreamer::SetMemory(Cell& cell, size_t memory)
+{
+    m_memory = m_memory - cell.memory + memory;
+    cell.memory = memory;
+}
+
+void WorldStreamer::StartLoad(Cell& cell)
+{
+    cell.state = CellState::Loading;
+    SetMemory(cell, cell.estimate);
+    m_pendingLoads++;
+
+    // The task only touches its own state, the streamer can be destroyed before it ends
+    std::shared_ptr<PendingLoad> load = std::make_shared<PendingLoad>();
+    cell.load = load;
+    ThreadPool::Enqueue([load, path = cell.path]()
+    {
+        std::unique_ptr<SceneFileReader> reader = std::make_unique<SceneFileReader>();
+        if (reader->Open(path))
+            load->reader = std::move(reader);
+        load->done.store(true, std::memory_order_release);
+    });
+}
+
+void WorldStreamer::FinishLoad(Cell& cell)
+{
+    std::unique_ptr<SceneFileReader> reader = std::move(cell.load->reader);
+    cell.load.reset();
+    m_pendingLoads--;
+
+    if (!reader)
+    {
+        PrintError("Failed to stream cell %s", cell.path.generic_string().c_str());
+        cell.failed = true;
+        cell.state = CellState::Unloaded;
+        SetMemory(cell, 0);
+        return;
+    }
+    // Left while it was loading
+    if (cell.distance > m_settings.unloadRadius)
+    {
+        cell.state = CellState::Unloaded;
+        SetMemory(cell, 0);
+        return;
+    }
+
+    cell.estimate = reader->GetFileSize() + reader->GetObjectCount() * ObjectMemory + reader->GetComponentCount() * ComponentMemory;
+    SetMemory(cell, cell.estimate);
+    cell.reader = std::move(reader);
+    cell.state = CellState::Integrating;
+
+    GameObject* root = m_scene.CreateGameObject().getPtr();
+    root->SetName("Cell " + std::to_string(cell.coordinates.x) + " " + std::to_string(cell.coordinates.y) + " " + std::to_string(cell.coordinates.z));
+    cell.root = root->GetHandle();
+}
+
+void WorldStreamer::BeginUnload(Cell& cell)
+{
+    cell.reader.reset();
+    cell.state = CellState::Unloading;
+    cell.teardown.clear();
+    if (GameObject* root = m_scene.Resolve(cell.root))
+    {
+        for (const SafePtr<GameObject>& child : root->GetChildren())
+            cell.teardown.push_back(child->GetHandle());
+    }
+}
+
+bool WorldStreamer::Evict(float distance)
+{
+    Cell* farthest = nullptr;
+    for (Cell& cell : m_cells)
+    {
+        if (cell.state != CellState::Resident || cell.distance <= m_settings.loadRadius || cell.distance <= distance)
+            continue;
+        if (!farthest || cell.distance > farthest->distance)
+            farthest = &cell;
+    }
+    if (!farthest)
+        return false;
+    BeginUnload(*farthest);
+    return true;
+}
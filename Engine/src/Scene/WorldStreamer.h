@@ -0,0 +1,125 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <galaxymath/Maths.h>
+
+#include "Scene/SceneSerializer.h"
+#include "Utils/Handle.h"
+
+class Scene;
+class GameObject;
+class ComponentRegister;
+class ResourceManager;
+
+// Distances in world units, cells are cubes of cellSize starting at coordinates * cellSize
+struct StreamingSettings
+{
+    float cellSize = 64.0f;
+    // Cells nearer than loadRadius to the focus are loaded, the ones further than unloadRadius are removed
+    float loadRadius = 128.0f;
+    float unloadRadius = 192.0f;
+    // Estimated memory of the cells loading and in the scene, in bytes
+    size_t memoryBudget = size_t(256) << 20;
+    // Main thread time spent adding and removing cell objects per Update, in milliseconds
+    double frameBudget = 2.0;
+    size_t maxPendingLoads = 4;
+};
+
+enum class CellState
+{
+    Unloaded,
+    // The file is read on a worker thread
+    Loading,
+    // Objects are added to the scene within the frame budget
+    Integrating,
+    Resident,
+    // Objects are removed from the scene within the frame budget
+    Unloading,
+};
+
+// Splits a large world in spatial cells, each one a scene file, and keeps the cells around a focus point in the scene.
+// Files are mapped and checked on the thread pool, their objects are then added under one GameObject per cell
+// a few at a time on the main thread, so neither the memory nor the time per frame grow with the world.
+class WorldStreamer
+{
+public:
+    WorldStreamer(Scene& scene, const ComponentRegister& componentRegister, const ResourceManager* resourceManager = nullptr, const StreamingSettings& settings = {});
+    WorldStreamer(const WorldStreamer&) = delete;
+    WorldStreamer& operator=(const WorldStreamer&) = delete;
+    ~WorldStreamer();
+
+    // The cell at coordinates is filled by the scene file at path
+    void AddCell(const Vec3i& coordinates, const std::filesystem::path& path);
+
+    // Main thread, outside of the scene update. Starts and finishes loads around focus,
+    // then adds and removes objects until the frame budget is spent.
+    void Update(const Vec3f& focus);
+
+    CellState GetCellState(const Vec3i& coordinates) const;
+    // Cell GameObject, invalid until the cell starts integrating
+    Handle<GameObject> GetCellRoot(const Vec3i& coordinates) const;
+    size_t GetCellCount(CellState state) const;
+    size_t GetMemoryUsage() const { return m_memory; }
+    // Main thread time of the last Update, in milliseconds
+    double GetLastUpdateTime() const { return m_lastUpdateTime; }
+
+    const StreamingSettings& GetSettings() const { return m_settings; }
+
+private:
+    // Written by the worker, read by the main thread once done is set
+    struct PendingLoad
+    {
+        std::unique_ptr<SceneFileReader> reader;
+        std::atomic<bool> done = false;
+    };
+
+    struct Cell
+    {
+        Vec3i coordinates;
+        std::filesystem::path path;
+        CellState state = CellState::Unloaded;
+        // Counted in m_memory while the cell is not unloaded
+        size_t memory = 0;
+        // Guessed from the file size until the file is opened
+        size_t estimate = 0;
+        float distance = 0.0f;
+        // A file that could not be read is not tried again
+        bool failed = false;
+
+        std::shared_ptr<PendingLoad> load;
+        std::unique_ptr<SceneFileReader> reader;
+        Handle<GameObject> root;
+        // Top level objects left to destroy while unloading
+        std::vector<Handle<GameObject>> teardown;
+    };
+
+    static uint64_t GetKey(const Vec3i& coordinates);
+    const Cell* FindCell(const Vec3i& coordinates) const;
+    float GetDistance(const Cell& cell, const Vec3f& focus) const;
+    void SetMemory(Cell& cell, size_t memory);
+
+    void StartLoad(Cell& cell);
+    void FinishLoad(Cell& cell);
+    void BeginUnload(Cell& cell);
+    // Frees a cell only kept by the unload radius, further than distance. False when there is none.
+    bool Evict(float distance);
+
+private:
+    Scene& m_scene;
+    const ComponentRegister& m_componentRegister;
+    const ResourceManager* m_resourceManager;
+    StreamingSettings m_settings;
+
+    std::vector<Cell> m_cells;
+    std::unordered_map<uint64_t, size_t> m_cellIndices;
+    size_t m_memory = 0;
+    size_t m_pendingLoads = 0;
+    double m_lastUpdateTime = 0.0;
+    // Reused each Update
+    std::vector<size_t> m_order;
+};
@@ -0,0 +1,903 @@
+﻿#include "BatchMath.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "Debug/Log.h"
+#include "Physic/BoundingBox.h"
+#include "Physic/Frustum.h"
+#include "Scene/TransformHierarchy.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define BATCHMATH_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define BATCHMATH_NEON
+#include <arm_neon.h>
+#endif
+
+// Lets the AVX2 kernels use the instructions without building the whole file for AVX2
+#if defined(BATCHMATH_X86) && (defined(__GNUC__) || defined(__clang__))
+#define AVX2_FUNCTION __attribute__((target("avx2,fma")))
+#else
+#define AVX2_FUNCTION
+#endif
+
+static_assert(sizeof(Mat4) == 16 * sizeof(float), "The kernels read a Mat4 as 16 floats");
+static_assert(sizeof(TransformLocal) == 10 * sizeof(float), "The AVX2 kernel gathers TransformLocal with a 10 floats stride");
+
+namespace BatchMath
+{
+    namespace
+    {
+        constexpr uint32_t NoParent = UINT32_MAX;
+
+        struct Kernels
+        {
+            Backend backend;
+            void (*composeTransforms)(const TransformLocal* locals, Mat4* matrices, size_t count);
+            void (*multiplyMatrices)(const Mat4* a, const Mat4* b, Mat4* result, size_t count);
+            void (*multiplyByParents)(Mat4* matrices, const uint32_t* parents, size_t begin, size_t end);
+            void (*transformBounds)(const BoundingBox* localBounds, const Mat4* matrices, BoundingBox* worldBounds, size_t count);
+            void (*cullBounds)(const CullingBounds& bounds, const Frustum& frustum, uint8_t* visible, size_t beginBlock, size_t endBlock);
+        };
+
+        constexpr int PlaneCount = 6;
+
+        // Plane terms of the box test: distance = n.c - d, a box is outside when distance < -(|n|.e)
+        struct CullPlanes
+        {
+            float normalX[PlaneCount], normalY[PlaneCount], normalZ[PlaneCount], distance[PlaneCount];
+            float absX[PlaneCount], absY[PlaneCount], absZ[PlaneCount];
+
+            explicit CullPlanes(const Frustum& frustum)
+            {
+                for (int i = 0; i < PlaneCount; i++)
+                {
+                    const Plane& plane = frustum.planes[i];
+                    normalX[i] = plane.normal.x;
+                    normalY[i] = plane.normal.y;
+                    normalZ[i] = plane.normal.z;
+                    distance[i] = plane.distance;
+                    absX[i] = std::fabs(plane.normal.x);
+                    absY[i] = std::fabs(plane.normal.y);
+                    absZ[i] = std::fabs(plane.normal.z);
+                }
+            }
+        };
+
+        // Keeps the plane that rejected the most boxes of the block, the previous one if none did
+        void StoreLastPlane(uint8_t& lastPlane, const int* rejected)
+        {
+            int best = lastPlane;
+            for (int i = 0; i < PlaneCount; i++)
+            {
+                if (rejected[i] > rejected[best])
+                    best = i;
+            }
+            if (rejected[best] > 0)
+                lastPlane = static_cast<uint8_t>(best);
+        }
+
+        float* Data(Mat4& matrix) { return reinterpret_cast<float*>(&matrix); }
+        const float* Data(const Mat4& matrix) { return reinterpret_cast<const float*>(&matrix); }
+
+        // ====================================================================
+        // Scalar, the galaxymath functions the engine used before
+        // ====================================================================
+
+        void ComposeTransformsScalar(const TransformLocal* locals, Mat4* matrices, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                matrices[i] = Mat4::CreateTransformMatrix(locals[i].position, locals[i].rotation, locals[i].scale);
+        }
+
+        void MultiplyMatricesScalar(const Mat4* a, const Mat4* b, Mat4* result, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                result[i] = a[i] * b[i];
+        }
+
+        void MultiplyByParentsScalar(Mat4* matrices, const uint32_t* parents, size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                if (parents[i] != NoParent)
+                    matrices[i] = matrices[parents[i]] * matrices[i];
+            }
+        }
+
+        void TransformBoundsScalar(const BoundingBox* localBounds, const Mat4* matrices, BoundingBox* worldBounds, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                worldBounds[i] = localBounds[i].IsValid() ? localBounds[i].Transform(matrices[i]) : BoundingBox();
+        }
+
+        // One box at a time, from the plane that rejected the most boxes of the block last time
+        void CullBoundsScalar(const CullingBounds& bounds, const Frustum& frustum, uint8_t* visible, size_t beginBlock, size_t endBlock)
+        {
+            const CullPlanes planes(frustum);
+            for (size_t block = beginBlock; block < endBlock; block++)
+            {
+                const int first = bounds.lastPlanes[block];
+                int rejected[PlaneCount] = {};
+                for (size_t i = block * CullBlockSize; i < (block + 1) * CullBlockSize; i++)
+                {
+                    uint8_t inside = 1;
+                    for (int k = 0; k < PlaneCount; k++)
+                    {
+                        const int p = (first + k) % PlaneCount;
+                        const float distance = planes.normalX[p] * bounds.centerX[i] + planes.normalY[p] * bounds.centerY[i]
+                            + planes.normalZ[p] * bounds.centerZ[i] - planes.distance[p];
+                        const float r = planes.absX[p] * bounds.extentX[i] + planes.absY[p] * bounds.extentY[i] + planes.absZ[p] * bounds.extentZ[i];
+                        // Written so that a NaN center is outside
+                        if (!(distance >= -r))
+                        {
+                            rejected[p]++;
+                            inside = 0;
+                            break;
+                        }
+                    }
+                    visible[i] = inside;
+                }
+                StoreLastPlane(bounds.lastPlanes[block], rejected);
+            }
+        }
+
+        constexpr Kernels s_scalarKernels = {
+            Backend::Scalar, ComposeTransformsScalar, MultiplyMatricesScalar, MultiplyByParentsScalar, TransformBoundsScalar,
+            CullBoundsScalar
+        };
+
+        int CountBits(int mask)
+        {
+            int count = 0;
+            for (; mask != 0; mask &= mask - 1)
+                count++;
+            return count;
+        }
+
+        void StoreVisibleMask(uint8_t* visible, int mask, size_t laneCount)
+        {
+            for (size_t lane = 0; lane < laneCount; lane++)
+                visible[lane] = static_cast<uint8_t>((mask >> lane) & 1);
+        }
+
+        // Column order TRS matrix, used by the SIMD kernels for the elements that do not fill a register
+        void ComposeTransform(const TransformLocal& local, float* out)
+        {
+            const Quat& q = local.rotation;
+            const Vec3f& s = local.scale;
+            const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+            const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+            const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+            out[0] = (1.0f - 2.0f * (yy + zz)) * s.x;
+            out[1] = 2.0f * (xy + wz) * s.x;
+            out[2] = 2.0f * (xz - wy) * s.x;
+            out[3] = 0.0f;
+            out[4] = 2.0f * (xy - wz) * s.y;
+            out[5] = (1.0f - 2.0f * (xx + zz)) * s.y;
+            out[6] = 2.0f * (yz + wx) * s.y;
+            out[7] = 0.0f;
+            out[8] = 2.0f * (xz + wy) * s.z;
+            out[9] = 2.0f * (yz - wx) * s.z;
+            out[10] = (1.0f - 2.0f * (xx + yy)) * s.z;
+            out[11] = 0.0f;
+            out[12] = local.position.x;
+            out[13] = local.position.y;
+            out[14] = local.position.z;
+            out[15] = 1.0f;
+        }
+
+#ifdef BATCHMATH_X86
+        // ====================================================================
+        // SSE, one matrix or box per iteration, 4 lanes for the compose
+        // ====================================================================
+
+        inline void MultiplySSE(const float* a, const float* b, float* result)
+        {
+            const __m128 a0 = _mm_loadu_ps(a);
+            const __m128 a1 = _mm_loadu_ps(a + 4);
+            const __m128 a2 = _mm_loadu_ps(a + 8);
+            const __m128 a3 = _mm_loadu_ps(a + 12);
+
+            __m128 columns[4];
+            for (int c = 0; c < 4; c++)
+            {
+                const float* column = b + c * 4;
+                __m128 sum = _mm_mul_ps(a0, _mm_set1_ps(column[0]));
+                sum = _mm_add_ps(sum, _mm_mul_ps(a1, _mm_set1_ps(column[1])));
+                sum = _mm_add_ps(sum, _mm_mul_ps(a2, _mm_set1_ps(column[2])));
+                columns[c] = _mm_add_ps(sum, _mm_mul_ps(a3, _mm_set1_ps(column[3])));
+            }
+            for (int c = 0; c < 4; c++)
+                _mm_storeu_ps(result + c * 4, columns[c]);
+        }
+
+        void ComposeTransformsSSE(const TransformLocal* locals, Mat4* matrices, size_t count)
+        {
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 two = _mm_set1_ps(2.0f);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const TransformLocal* l = locals + i;
+#define LANES(field) _mm_setr_ps(l[0].field, l[1].field, l[2].field, l[3].field)
+                const __m128 qx = LANES(rotation.x), qy = LANES(rotation.y), qz = LANES(rotation.z), qw = LANES(rotation.w);
+                const __m128 sx = LANES(scale.x), sy = LANES(scale.y), sz = LANES(scale.z);
+                __m128 px = LANES(position.x), py = LANES(position.y), pz = LANES(position.z);
+#undef LANES
+                const __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+                const __m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+                const __m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+                __m128 m00 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+                __m128 m01 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+                __m128 m02 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+                __m128 m10 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+                __m128 m11 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+                __m128 m12 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+                __m128 m20 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+                __m128 m21 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+                __m128 m22 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+                __m128 zero0 = _mm_setzero_ps(), zero1 = _mm_setzero_ps(), zero2 = _mm_setzero_ps();
+                __m128 w = one;
+
+                // Each group of 4 registers becomes the same column of the 4 matrices
+                _MM_TRANSPOSE4_PS(m00, m01, m02, zero0);
+                _MM_TRANSPOSE4_PS(m10, m11, m12, zero1);
+                _MM_TRANSPOSE4_PS(m20, m21, m22, zero2);
+                _MM_TRANSPOSE4_PS(px, py, pz, w);
+
+                const __m128 columns[4][4] = {
+                    { m00, m10, m20, px },
+                    { m01, m11, m21, py },
+                    { m02, m12, m22, pz },
+                    { zero0, zero1, zero2, w },
+                };
+                for (int lane = 0; lane < 4; lane++)
+                {
+                    float* out = Data(matrices[i + lane]);
+                    for (int c = 0; c < 4; c++)
+                        _mm_storeu_ps(out + c * 4, columns[lane][c]);
+                }
+            }
+            for (; i < count; i++)
+                ComposeTransform(locals[i], Data(matrices[i]));
+        }
+
+        void MultiplyMatricesSSE(const Mat4* a, const Mat4* b, Mat4* result, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                MultiplySSE(Data(a[i]), Data(b[i]), Data(result[i]));
+        }
+
+        void MultiplyByParentsSSE(Mat4* matrices, const uint32_t* parents, size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                if (parents[i] != NoParent)
+                    MultiplySSE(Data(matrices[parents[i]]), Data(matrices[i]), Data(matrices[i]));
+            }
+        }
+
+        // Center and extents form: the world extents are the local ones through the absolute 3x3 part
+        void TransformBoundsSSE(const BoundingBox* localBounds, const Mat4* matrices, BoundingBox* worldBounds, size_t count)
+        {
+            const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+            for (size_t i = 0; i < count; i++)
+            {
+                const BoundingBox& local = localBounds[i];
+                if (!local.IsValid())
+                {
+                    worldBounds[i] = BoundingBox();
+                    continue;
+                }
+
+                const float* m = Data(matrices[i]);
+                const __m128 a0 = _mm_loadu_ps(m), a1 = _mm_loadu_ps(m + 4), a2 = _mm_loadu_ps(m + 8), a3 = _mm_loadu_ps(m + 12);
+                const float cx = (local.min.x + local.max.x) * 0.5f, cy = (local.min.y + local.max.y) * 0.5f, cz = (local.min.z + local.max.z) * 0.5f;
+                const float ex = (local.max.x - local.min.x) * 0.5f, ey = (local.max.y - local.min.y) * 0.5f, ez = (local.max.z - local.min.z) * 0.5f;
+
+                __m128 center = _mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(cx)), _mm_mul_ps(a1, _mm_set1_ps(cy)));
+                center = _mm_add_ps(center, _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(cz)), a3));
+                __m128 extents = _mm_mul_ps(_mm_and_ps(a0, absMask), _mm_set1_ps(ex));
+                extents = _mm_add_ps(extents, _mm_mul_ps(_mm_and_ps(a1, absMask), _mm_set1_ps(ey)));
+                extents = _mm_add_ps(extents, _mm_mul_ps(_mm_and_ps(a2, absMask), _mm_set1_ps(ez)));
+
+                alignas(16) float min[4], max[4];
+                _mm_store_ps(min, _mm_sub_ps(center, extents));
+                _mm_store_ps(max, _mm_add_ps(center, extents));
+                worldBounds[i] = BoundingBox(Vec3f(min[0], min[1], min[2]), Vec3f(max[0], max[1], max[2]));
+            }
+        }
+
+        // Four boxes per register. The spheres are tested first, the box test only runs for the lanes
+        // that a sphere crosses a plane without being outside another one.
+        inline int CullLanesSSE(const CullPlanes& planes, const CullingBounds& bounds, size_t i, int first, int* rejected)
+        {
+            const __m128 cx = _mm_loadu_ps(bounds.centerX + i), cy = _mm_loadu_ps(bounds.centerY + i), cz = _mm_loadu_ps(bounds.centerZ + i);
+            const __m128 radius = _mm_loadu_ps(bounds.radius + i);
+            const __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), radius);
+
+            __m128 distances[PlaneCount];
+            auto distanceTo = [&](int p)
+            {
+                __m128 distance = _mm_mul_ps(_mm_set1_ps(planes.normalX[p]), cx);
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(planes.normalY[p]), cy));
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(planes.normalZ[p]), cz));
+                return _mm_sub_ps(distance, _mm_set1_ps(planes.distance[p]));
+            };
+
+            // Whole group behind the plane that rejected the most last time
+            distances[first] = distanceTo(first);
+            const int firstOutside = _mm_movemask_ps(_mm_cmplt_ps(distances[first], negativeRadius));
+            if (firstOutside == 0xF)
+            {
+                rejected[first] += 4;
+                return 0;
+            }
+
+            int outside = 0;
+            int inside = 0xF;
+            for (int p = 0; p < PlaneCount; p++)
+            {
+                if (p != first)
+                    distances[p] = distanceTo(p);
+                const int planeOutside = _mm_movemask_ps(_mm_cmplt_ps(distances[p], negativeRadius));
+                rejected[p] += CountBits(planeOutside & ~outside);
+                outside |= planeOutside;
+                inside &= _mm_movemask_ps(_mm_cmpge_ps(distances[p], radius));
+            }
+            if ((outside | inside) == 0xF)
+                return inside;
+
+            const __m128 ex = _mm_loadu_ps(bounds.extentX + i), ey = _mm_loadu_ps(bounds.extentY + i), ez = _mm_loadu_ps(bounds.extentZ + i);
+            __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (int p = 0; p < PlaneCount; p++)
+            {
+                __m128 r = _mm_mul_ps(_mm_set1_ps(planes.absX[p]), ex);
+                r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(planes.absY[p]), ey));
+                r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(planes.absZ[p]), ez));
+                visible = _mm_and_ps(visible, _mm_cmpge_ps(distances[p], _mm_sub_ps(_mm_setzero_ps(), r)));
+            }
+            return _mm_movemask_ps(visible);
+        }
+
+        void CullBoundsSSE(const CullingBounds& bounds, const Frustum& frustum, uint8_t* visible, size_t beginBlock, size_t endBlock)
+        {
+            const CullPlanes planes(frustum);
+            for (size_t block = beginBlock; block < endBlock; block++)
+            {
+                const size_t i = block * CullBlockSize;
+                const int first = bounds.lastPlanes[block];
+                int rejected[PlaneCount] = {};
+                StoreVisibleMask(visible + i, CullLanesSSE(planes, bounds, i, first, rejected), 4);
+                StoreVisibleMask(visible + i + 4, CullLanesSSE(planes, bounds, i + 4, first, rejected), 4);
+                StoreLastPlane(bounds.lastPlanes[block], rejected);
+            }
+        }
+
+        constexpr Kernels s_sseKernels = {
+            Backend::SSE, ComposeTransformsSSE, MultiplyMatricesSSE, MultiplyByParentsSSE, TransformBoundsSSE,
+            CullBoundsSSE
+        };
+
+        // ====================================================================
+        // AVX2, two matrix columns per register, 8 lanes for the compose
+        // ====================================================================
+
+        AVX2_FUNCTION inline void MultiplyAVX2(const float* a, const float* b, float* result)
+        {
+            const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a));
+            const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+            const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+            const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+            const __m256 b01 = _mm256_loadu_ps(b);
+            const __m256 b23 = _mm256_loadu_ps(b + 8);
+
+            __m256 r01 = _mm256_mul_ps(a0, _mm256_shuffle_ps(b01, b01, 0x00));
+            r01 = _mm256_fmadd_ps(a1, _mm256_shuffle_ps(b01, b01, 0x55), r01);
+            r01 = _mm256_fmadd_ps(a2, _mm256_shuffle_ps(b01, b01, 0xAA), r01);
+            r01 = _mm256_fmadd_ps(a3, _mm256_shuffle_ps(b01, b01, 0xFF), r01);
+            __m256 r23 = _mm256_mul_ps(a0, _mm256_shuffle_ps(b23, b23, 0x00));
+            r23 = _mm256_fmadd_ps(a1, _mm256_shuffle_ps(b23, b23, 0x55), r23);
+            r23 = _mm256_fmadd_ps(a2, _mm256_shuffle_ps(b23, b23, 0xAA), r23);
+            r23 = _mm256_fmadd_ps(a3, _mm256_shuffle_ps(b23, b23, 0xFF), r23);
+
+            _mm256_storeu_ps(result, r01);
+            _mm256_storeu_ps(result + 8, r23);
+        }
+
+        // 4x4 transpose inside each 128 bits half
+        AVX2_FUNCTION inline void Transpose4(__m256& r0, __m256& r1, __m256& r2, __m256& r3)
+        {
+            const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+            const __m256 t1 = _mm256_unpacklo_ps(r2, r3);
+            const __m256 t2 = _mm256_unpackhi_ps(r0, r1);
+            const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+            r0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+            r1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+            r2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            r3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        }
+
+        AVX2_FUNCTION void ComposeTransformsAVX2(const TransformLocal* locals, Mat4* matrices, size_t count)
+        {
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const __m256 two = _mm256_set1_ps(2.0f);
+            const __m256i stride = _mm256_setr_epi32(0, 10, 20, 30, 40, 50, 60, 70);
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const TransformLocal* l = locals + i;
+#define LANES(field) _mm256_i32gather_ps(&l->field, stride, 4)
+                const __m256 qx = LANES(rotation.x), qy = LANES(rotation.y), qz = LANES(rotation.z), qw = LANES(rotation.w);
+                const __m256 sx = LANES(scale.x), sy = LANES(scale.y), sz = LANES(scale.z);
+                __m256 px = LANES(position.x), py = LANES(position.y), pz = LANES(position.z);
+#undef LANES
+                const __m256 xx = _mm256_mul_ps(qx, qx), yy = _mm256_mul_ps(qy, qy), zz = _mm256_mul_ps(qz, qz);
+                const __m256 xy = _mm256_mul_ps(qx, qy), xz = _mm256_mul_ps(qx, qz), yz = _mm256_mul_ps(qy, qz);
+                const __m256 wx = _mm256_mul_ps(qw, qx), wy = _mm256_mul_ps(qw, qy), wz = _mm256_mul_ps(qw, qz);
+
+                __m256 m00 = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(yy, zz), one), sx);
+                __m256 m01 = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)), sx);
+                __m256 m02 = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), sx);
+                __m256 m10 = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), sy);
+                __m256 m11 = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, zz), one), sy);
+                __m256 m12 = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, wx)), sy);
+                __m256 m20 = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), sz);
+                __m256 m21 = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), sz);
+                __m256 m22 = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, yy), one), sz);
+                __m256 zero0 = _mm256_setzero_ps(), zero1 = _mm256_setzero_ps(), zero2 = _mm256_setzero_ps();
+                __m256 w = one;
+
+                // Register k of a group holds a column of matrix k in its low half and of matrix k + 4 in its high half
+                Transpose4(m00, m01, m02, zero0);
+                Transpose4(m10, m11, m12, zero1);
+                Transpose4(m20, m21, m22, zero2);
+                Transpose4(px, py, pz, w);
+
+                const __m256 columns[4][4] = {
+                    { m00, m10, m20, px },
+                    { m01, m11, m21, py },
+                    { m02, m12, m22, pz },
+                    { zero0, zero1, zero2, w },
+                };
+                for (int lane = 0; lane < 4; lane++)
+                {
+                    float* low = Data(matrices[i + lane]);
+                    float* high = Data(matrices[i + lane + 4]);
+                    for (int c = 0; c < 4; c++)
+                    {
+                        _mm_storeu_ps(low + c * 4, _mm256_castps256_ps128(columns[lane][c]));
+                        _mm_storeu_ps(high + c * 4, _mm256_extractf128_ps(columns[lane][c], 1));
+                    }
+                }
+            }
+            for (; i < count; i++)
+                ComposeTransform(locals[i], Data(matrices[i]));
+        }
+
+        AVX2_FUNCTION void MultiplyMatricesAVX2(const Mat4* a, const Mat4* b, Mat4* result, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                MultiplyAVX2(Data(a[i]), Data(b[i]), Data(result[i]));
+        }
+
+        AVX2_FUNCTION void MultiplyByParentsAVX2(Mat4* matrices, const uint32_t* parents, size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                if (parents[i] != NoParent)
+                    MultiplyAVX2(Data(matrices[parents[i]]), Data(matrices[i]), Data(matrices[i]));
+            }
+        }
+
+        AVX2_FUNCTION void TransformBoundsAVX2(const BoundingBox* localBounds, const Mat4* matrices, BoundingBox* worldBounds, size_t count)
+        {
+            const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+            for (size_t i = 0; i < count; i++)
+            {
+                const BoundingBox& local = localBounds[i];
+                if (!local.IsValid())
+                {
+                    worldBounds[i] = BoundingBox();
+                    continue;
+                }
+
+                const float* m = Data(matrices[i]);
+                const __m128 a0 = _mm_loadu_ps(m), a1 = _mm_loadu_ps(m + 4), a2 = _mm_loadu_ps(m + 8), a3 = _mm_loadu_ps(m + 12);
+                const float cx = (local.min.x + local.max.x) * 0.5f, cy = (local.min.y + local.max.y) * 0.5f, cz = (local.min.z + local.max.z) * 0.5f;
+                const float ex = (local.max.x - local.min.x) * 0.5f, ey = (local.max.y - local.min.y) * 0.5f, ez = (local.max.z - local.min.z) * 0.5f;
+
+                __m128 center = _mm_fmadd_ps(a0, _mm_set1_ps(cx), a3);
+                center = _mm_fmadd_ps(a1, _mm_set1_ps(cy), center);
+                center = _mm_fmadd_ps(a2, _mm_set1_ps(cz), center);
+                __m128 extents = _mm_mul_ps(_mm_and_ps(a0, absMask), _mm_set1_ps(ex));
+                extents = _mm_fmadd_ps(_mm_and_ps(a1, absMask), _mm_set1_ps(ey), extents);
+                extents = _mm_fmadd_ps(_mm_and_ps(a2, absMask), _mm_set1_ps(ez), extents);
+
+                alignas(16) float min[4], max[4];
+                _mm_store_ps(min, _mm_sub_ps(center, extents));
+                _mm_store_ps(max, _mm_add_ps(center, extents));
+                worldBounds[i] = BoundingBox(Vec3f(min[0], min[1], min[2]), Vec3f(max[0], max[1], max[2]));
+            }
+        }
+
+        AVX2_FUNCTION inline __m256 DistanceAVX2(const CullPlanes& planes, int p, __m256 cx, __m256 cy, __m256 cz)
+        {
+            __m256 distance = _mm256_fmsub_ps(_mm256_set1_ps(planes.normalX[p]), cx, _mm256_set1_ps(planes.distance[p]));
+            distance = _mm256_fmadd_ps(_mm256_set1_ps(planes.normalY[p]), cy, distance);
+            return _mm256_fmadd_ps(_mm256_set1_ps(planes.normalZ[p]), cz, distance);
+        }
+
+        // A whole block per register, same steps as the SSE kernel
+        AVX2_FUNCTION void CullBoundsAVX2(const CullingBounds& bounds, const Frustum& frustum, uint8_t* visible, size_t beginBlock, size_t endBlock)
+        {
+            static_assert(CullBlockSize == 8, "The AVX2 cull kernel reads a block per register");
+            const CullPlanes planes(frustum);
+            for (size_t block = beginBlock; block < endBlock; block++)
+            {
+                const size_t i = block * CullBlockSize;
+                const int first = bounds.lastPlanes[block];
+                const __m256 cx = _mm256_loadu_ps(bounds.centerX + i), cy = _mm256_loadu_ps(bounds.centerY + i), cz = _mm256_loadu_ps(bounds.centerZ + i);
+                const __m256 radius = _mm256_loadu_ps(bounds.radius + i);
+                const __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), radius);
+
+                __m256 distances[PlaneCount];
+                distances[first] = DistanceAVX2(planes, first, cx, cy, cz);
+                if (_mm256_movemask_ps(_mm256_cmp_ps(distances[first], negativeRadius, _CMP_LT_OQ)) == 0xFF)
+                {
+                    std::memset(visible + i, 0, CullBlockSize);
+                    continue;
+                }
+
+                int rejected[PlaneCount] = {};
+                int outside = 0;
+                int inside = 0xFF;
+                for (int p = 0; p < PlaneCount; p++)
+                {
+                    if (p != first)
+                        distances[p] = DistanceAVX2(planes, p, cx, cy, cz);
+                    const int planeOutside = _mm256_movemask_ps(_mm256_cmp_ps(distances[p], negativeRadius, _CMP_LT_OQ));
+                    rejected[p] = CountBits(planeOutside & ~outside);
+                    outside |= planeOutside;
+                    inside &= _mm256_movemask_ps(_mm256_cmp_ps(distances[p], radius, _CMP_GE_OQ));
+                }
+                StoreLastPlane(bounds.lastPlanes[block], rejected);
+                if ((outside | inside) == 0xFF)
+                {
+                    StoreVisibleMask(visible + i, inside, CullBlockSize);
+                    continue;
+                }
+
+                const __m256 ex = _mm256_loadu_ps(bounds.extentX + i), ey = _mm256_loadu_ps(bounds.extentY + i), ez = _mm256_loadu_ps(bounds.extentZ + i);
+                __m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+                for (int p = 0; p < PlaneCount; p++)
+                {
+                    __m256 r = _mm256_mul_ps(_mm256_set1_ps(planes.absX[p]), ex);
+                    r = _mm256_fmadd_ps(_mm256_set1_ps(planes.absY[p]), ey, r);
+                    r = _mm256_fmadd_ps(_mm256_set1_ps(planes.absZ[p]), ez, r);
+                    mask = _mm256_and_ps(mask, _mm256_cmp_ps(distances[p], _mm256_sub_ps(_mm256_setzero_ps(), r), _CMP_GE_OQ));
+                }
+                StoreVisibleMask(visible + i, _mm256_movemask_ps(mask), CullBlockSize);
+            }
+        }
+
+        constexpr Kernels s_avx2Kernels = {
+            Backend::AVX2, ComposeTransformsAVX2, MultiplyMatricesAVX2, MultiplyByParentsAVX2, TransformBoundsAVX2,
+            CullBoundsAVX2
+        };
+#endif
+
+#ifdef BATCHMATH_NEON
+        // ====================================================================
+        // NEON, one matrix or box per iteration, the compose stays scalar
+        // ====================================================================
+
+        inline void MultiplyNEON(const float* a, const float* b, float* result)
+        {
+            const float32x4_t a0 = vld1q_f32(a);
+            const float32x4_t a1 = vld1q_f32(a + 4);
+            const float32x4_t a2 = vld1q_f32(a + 8);
+            const float32x4_t a3 = vld1q_f32(a + 12);
+
+            float32x4_t columns[4];
+            for (int c = 0; c < 4; c++)
+            {
+                const float* column = b + c * 4;
+                float32x4_t sum = vmulq_n_f32(a0, column[0]);
+                sum = vmlaq_n_f32(sum, a1, column[1]);
+                sum = vmlaq_n_f32(sum, a2, column[2]);
+                columns[c] = vmlaq_n_f32(sum, a3, column[3]);
+            }
+            for (int c = 0; c < 4; c++)
+                vst1q_f32(result + c * 4, columns[c]);
+        }
+
+        void ComposeTransformsNEON(const TransformLocal* locals, Mat4* matrices, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                ComposeTransform(locals[i], Data(matrices[i]));
+        }
+
+        void MultiplyMatricesNEON(const Mat4* a, const Mat4* b, Mat4* result, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                MultiplyNEON(Data(a[i]), Data(b[i]), Data(result[i]));
+        }
+
+        void MultiplyByParentsNEON(Mat4* matrices, const uint32_t* parents, size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                if (parents[i] != NoParent)
+                    MultiplyNEON(Data(matrices[parents[i]]), Data(matrices[i]), Data(matrices[i]));
+            }
+        }
+
+        void TransformBoundsNEON(const BoundingBox* localBounds, const Mat4* matrices, BoundingBox* worldBounds, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                const BoundingBox& local = localBounds[i];
+                if (!local.IsValid())
+                {
+                    worldBounds[i] = BoundingBox();
+                    continue;
+                }
+
+                const float* m = Data(matrices[i]);
+                const float32x4_t a0 = vld1q_f32(m), a1 = vld1q_f32(m + 4), a2 = vld1q_f32(m + 8), a3 = vld1q_f32(m + 12);
+                const float cx = (local.min.x + local.max.x) * 0.5f, cy = (local.min.y + local.max.y) * 0.5f, cz = (local.min.z + local.max.z) * 0.5f;
+                const float ex = (local.max.x - local.min.x) * 0.5f, ey = (local.max.y - local.min.y) * 0.5f, ez = (local.max.z - local.min.z) * 0.5f;
+
+                float32x4_t center = vmlaq_n_f32(a3, a0, cx);
+                center = vmlaq_n_f32(center, a1, cy);
+                center = vmlaq_n_f32(center, a2, cz);
+                float32x4_t extents = vmulq_n_f32(vabsq_f32(a0), ex);
+                extents = vmlaq_n_f32(extents, vabsq_f32(a1), ey);
+                extents = vmlaq_n_f32(extents, vabsq_f32(a2), ez);
+
+                float min[4], max[4];
+                vst1q_f32(min, vsubq_f32(center, extents));
+                vst1q_f32(max, vaddq_f32(center, extents));
+                worldBounds[i] = BoundingBox(Vec3f(min[0], min[1], min[2]), Vec3f(max[0], max[1], max[2]));
+            }
+        }
+
+        constexpr Kernels s_neonKernels = {
+            Backend::NEON, ComposeTransformsNEON, MultiplyMatricesNEON, MultiplyByParentsNEON, TransformBoundsNEON,
+            CullBoundsScalar
+        };
+#endif
+
+        // ====================================================================
+        // Dispatch
+        // ====================================================================
+
+        bool HasAVX2()
+        {
+#if defined(BATCHMATH_X86) && defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 1);
+            const bool fma = (info[2] & (1 << 12)) != 0;
+            const bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+            __cpuidex(info, 7, 0);
+            const bool avx2 = (info[1] & (1 << 5)) != 0;
+            return fma && osSavesYmm && avx2;
+#elif defined(BATCHMATH_X86)
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+            return false;
+#endif
+        }
+
+        const Kernels* GetKernels(Backend backend)
+        {
+            switch (backend)
+            {
+#ifdef BATCHMATH_X86
+            case Backend::SSE:
+                return &s_sseKernels;
+            case Backend::AVX2:
+                return HasAVX2() ? &s_avx2Kernels : nullptr;
+#endif
+#ifdef BATCHMATH_NEON
+            case Backend::NEON:
+                return &s_neonKernels;
+#endif
+            case Backend::Scalar:
+                return &s_scalarKernels;
+            default:
+                return nullptr;
+            }
+        }
+
+        bool NearlyEqual(const float* a, const float* b, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                if (std::fabs(a[i] - b[i]) > 1e-4f * std::fmax(1.0f, std::fabs(b[i])))
+                    return false;
+            }
+            return true;
+        }
+
+        // Boxes inside, outside and across a cube frustum, with a last block padded with NaN centers like the BVH
+        bool CullMatchesScalar(const Kernels& kernels)
+        {
+            constexpr size_t count = 19;
+            constexpr size_t blockCount = (count + CullBlockSize - 1) / CullBlockSize;
+            constexpr size_t size = blockCount * CullBlockSize;
+            const float nan = std::numeric_limits<float>::quiet_NaN();
+            float center[3][size], extent[3][size], radius[size];
+            for (size_t i = 0; i < size; i++)
+            {
+                const float f = static_cast<float>(i);
+                center[0][i] = i < count ? -21.0f + 2.3f * f : nan;
+                center[1][i] = i < count ? 13.0f - 1.7f * f : nan;
+                center[2][i] = i < count ? (i % 3 == 0 ? 11.5f : -4.0f + 0.5f * f) : nan;
+                extent[0][i] = i < count ? 0.5f + 0.25f * static_cast<float>(i % 5) : 0.0f;
+                extent[1][i] = i < count ? 1.0f : 0.0f;
+                extent[2][i] = i < count ? 0.75f + 0.5f * static_cast<float>(i % 2) : 0.0f;
+                radius[i] = std::sqrt(extent[0][i] * extent[0][i] + extent[1][i] * extent[1][i] + extent[2][i] * extent[2][i]);
+            }
+
+            // Inside when -10 <= x, y, z <= 10
+            Frustum frustum;
+            const Vec3f axes[3] = { Vec3f(1.0f, 0.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f), Vec3f(0.0f, 0.0f, 1.0f) };
+            for (int axis = 0; axis < 3; axis++)
+            {
+                frustum.planes[axis * 2] = Plane(axes[axis], -10.0f);
+                frustum.planes[axis * 2 + 1] = Plane(-axes[axis], -10.0f);
+            }
+
+            uint8_t expectedPlanes[blockCount] = {}, actualPlanes[blockCount] = {};
+            uint8_t expected[size], actual[size];
+            const CullingBounds expectedBounds = { center[0], center[1], center[2], extent[0], extent[1], extent[2], radius, expectedPlanes };
+            const CullingBounds actualBounds = { center[0], center[1], center[2], extent[0], extent[1], extent[2], radius, actualPlanes };
+            // Twice, the second pass starts each block from the plane the first one kept
+            for (int pass = 0; pass < 2; pass++)
+            {
+                s_scalarKernels.cullBounds(expectedBounds, frustum, expected, 0, blockCount);
+                kernels.cullBounds(actualBounds, frustum, actual, 0, blockCount);
+                if (std::memcmp(expected, actual, size) != 0)
+                    return false;
+            }
+            return true;
+        }
+
+        // Compares a kernel set with galaxymath, which decides the matrix layout and the quaternion convention
+        bool MatchesScalar(const Kernels& kernels)
+        {
+            constexpr size_t count = 11;
+            TransformLocal locals[count];
+            BoundingBox localBounds[count];
+            for (size_t i = 0; i < count; i++)
+            {
+                const float f = static_cast<float>(i + 1);
+                locals[i].position = Vec3f(f, -2.0f * f, 0.5f * f);
+                locals[i].rotation = Quat::AngleAxis(0.3f * f, Vec3f(1.0f, f, -0.5f * f).GetNormalize());
+                locals[i].scale = Vec3f(1.0f + 0.1f * f, 2.0f, 0.5f);
+                localBounds[i] = BoundingBox(Vec3f(-f, -1.0f, 0.0f), Vec3f(f, 2.0f, 0.5f * f));
+            }
+            uint32_t parents[count];
+            for (size_t i = 0; i < count; i++)
+                parents[i] = i == 0 ? NoParent : static_cast<uint32_t>(i / 2);
+
+            Mat4 expected[count], actual[count];
+            s_scalarKernels.composeTransforms(locals, expected, count);
+            kernels.composeTransforms(locals, actual, count);
+            if (!NearlyEqual(Data(actual[0]), Data(expected[0]), count * 16))
+                return false;
+
+            s_scalarKernels.multiplyByParents(expected, parents, 0, count);
+            kernels.multiplyByParents(actual, parents, 0, count);
+            if (!NearlyEqual(Data(actual[0]), Data(expected[0]), count * 16))
+                return false;
+
+            BoundingBox expectedBounds[count], actualBounds[count];
+            s_scalarKernels.transformBounds(localBounds, expected, expectedBounds, count);
+            kernels.transformBounds(localBounds, expected, actualBounds, count);
+            for (size_t i = 0; i < count; i++)
+            {
+                if (!NearlyEqual(&actualBounds[i].min.x, &expectedBounds[i].min.x, 3) || !NearlyEqual(&actualBounds[i].max.x, &expectedBounds[i].max.x, 3))
+                    return false;
+            }
+            return CullMatchesScalar(kernels);
+        }
+
+        const Kernels* SelectKernels()
+        {
+            for (Backend backend : { Backend::AVX2, Backend::SSE, Backend::NEON })
+            {
+                const Kernels* kernels = GetKernels(backend);
+                if (!kernels)
+                    continue;
+                if (MatchesScalar(*kernels))
+                    return kernels;
+                PrintWarning("Batch math %s kernels differ from galaxymath, not used", GetBackendName(backend));
+            }
+            return &s_scalarKernels;
+        }
+
+        std::atomic<const Kernels*>& CurrentKernels()
+        {
+            static std::atomic<const Kernels*> s_kernels = SelectKernels();
+            return s_kernels;
+        }
+
+        const Kernels& Current()
+        {
+            return *CurrentKernels().load(std::memory_order_relaxed);
+        }
+    }
+
+    Backend GetBackend()
+    {
+        return Current().backend;
+    }
+
+    const char* GetBackendName(Backend backend)
+    {
+        switch (backend)
+        {
+        case Backend::Scalar:
+            return "Scalar";
+        case Backend::SSE:
+            return "SSE";
+        case Backend::AVX2:
+            return "AVX2";
+        case Backend::NEON:
+            return "NEON";
+        }
+        return "Unknown";
+    }
+
+    bool IsSupported(Backend backend)
+    {
+        return GetKernels(backend) != nullptr;
+    }
+
+    bool SetBackend(Backend backend)
+    {
+        const Kernels* kernels = GetKernels(backend);
+        if (!kernels)
+            return false;
+        CurrentKernels().store(kernels, std::memory_order_relaxed);
+        return true;
+    }
+
+    void ComposeTransforms(const TransformLocal* locals, Mat4* matrices, size_t count)
+    {
+        Current().composeTransforms(locals, matrices, count);
+    }
+
+    void MultiplyMatrices(const Mat4* a, const Mat4* b, Mat4* result, size_t count)
+    {
+        Current().multiplyMatrices(a, b, result, count);
+    }
+
+    void MultiplyByParents(Mat4* matrices, const uint32_t* parents, size_t begin, size_t end)
+    {
+        Current().multiplyByParents(matrices, parents, begin, end);
+    }
+
+    void TransformBounds(const BoundingBox* localBounds, const Mat4* matrices, BoundingBox* worldBounds, size_t count)
+    {
+        Current().transformBounds(localBounds, matrices, worldBounds, count);
+    }
+
+    void CullBounds(const CullingBounds& bounds, const Frustum& frustum, uint8_t* visible, size_t beginBlock, size_t endBlock)
+    {
+        Current().cullBounds(bounds, frustum, visible, beginBlock, endBlock);
+    }
+}
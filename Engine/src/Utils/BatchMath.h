@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include <galaxymath/Maths.h>
+
+struct TransformLocal;
+struct BoundingBox;
+struct Frustum;
+
+// Transform and culling math over whole arrays, run by SIMD kernels chosen once from the CPU features.
+// The kernels read a Mat4 as 16 floats in column order, the layout sent to the shaders. At startup each kernel set
+// is checked against galaxymath and falls back to the scalar one if its results differ.
+namespace BatchMath
+{
+    enum class Backend
+    {
+        Scalar,
+        SSE,
+        AVX2,
+        NEON,
+    };
+
+    Backend GetBackend();
+    const char* GetBackendName(Backend backend);
+    bool IsSupported(Backend backend);
+    // Forces a backend, for tests and benchmarks. False if the CPU does not support it.
+    bool SetBackend(Backend backend);
+
+    // matrices[i] = translation * rotation * scale of locals[i]
+    void ComposeTransforms(const TransformLocal* locals, Mat4* matrices, size_t count);
+    // result[i] = a[i] * b[i], result may be a or b
+    void MultiplyMatrices(const Mat4* a, const Mat4* b, Mat4* result, size_t count);
+    // matrices[i] = matrices[parents[i]] * matrices[i] for i in [begin, end), in order so parents must come first.
+    // Nodes without parent (UINT32_MAX) are kept.
+    void MultiplyByParents(Mat4* matrices, const uint32_t* parents, size_t begin, size_t end);
+    // Box around each local box once transformed, an invalid local box gives an invalid world box
+    void TransformBounds(const BoundingBox* localBounds, const Mat4* matrices, BoundingBox* worldBounds, size_t count);
+
+    // Boxes are culled by blocks of CullBlockSize
+    constexpr size_t CullBlockSize = 8;
+
+    // World boxes as center and half extents arrays, plus the radius of the sphere around each box.
+    // Arrays are padded to a multiple of CullBlockSize, a NaN center fails every plane test.
+    struct CullingBounds
+    {
+        const float* centerX;
+        const float* centerY;
+        const float* centerZ;
+        const float* extentX;
+        const float* extentY;
+        const float* extentZ;
+        const float* radius;
+        // One per block: the plane that rejected the most boxes of the block last time, tested first
+        uint8_t* lastPlanes;
+    };
+
+    // visible[i] = 1 if box i touches the frustum (normalized planes), 0 otherwise, for the blocks in [beginBlock, endBlock).
+    // Spheres settle most boxes before the box test, a block whose boxes are all behind its last plane is rejected at once.
+    void CullBounds(const CullingBounds& bounds, const Frustum& frustum, uint8_t* visible, size_t beginBlock, size_t endBlock);
+}
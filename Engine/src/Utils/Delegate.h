@@ -0,0 +1,149 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template<typename Signature>
+class Delegate;
+
+// Copyable callable like std::function, callables up to InlineSize bytes (a lambda capturing a few pointers)
+// are stored in place, only bigger ones allocate.
+template<typename R, typename... Args>
+class Delegate<R(Args...)>
+{
+public:
+    static constexpr size_t InlineSize = 4 * sizeof(void*);
+
+    Delegate() = default;
+    Delegate(std::nullptr_t) {}
+
+    template<typename F> requires (!std::is_same_v<std::decay_t<F>, Delegate> && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+    Delegate(F&& function)
+    {
+        using Stored = std::decay_t<F>;
+        if constexpr (IsInline<Stored>())
+            new (m_storage) Stored(std::forward<F>(function));
+        else
+            new (m_storage) Stored*(new Stored(std::forward<F>(function)));
+        m_operations = &s_operations<Stored>;
+    }
+
+    Delegate(const Delegate& other)
+    {
+        if (other.m_operations)
+            other.m_operations->copy(m_storage, other.m_storage);
+        m_operations = other.m_operations;
+    }
+
+    Delegate(Delegate&& other) noexcept
+    {
+        if (other.m_operations)
+            other.m_operations->move(m_storage, other.m_storage);
+        m_operations = std::exchange(other.m_operations, nullptr);
+    }
+
+    Delegate& operator=(const Delegate& other)
+    {
+        if (this != &other)
+        {
+            Delegate copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    Delegate& operator=(Delegate&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            if (other.m_operations)
+                other.m_operations->move(m_storage, other.m_storage);
+            m_operations = std::exchange(other.m_operations, nullptr);
+        }
+        return *this;
+    }
+
+    ~Delegate() { Reset(); }
+
+    R operator()(Args... args) const
+    {
+        return m_operations->invoke(m_storage, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const { return m_operations != nullptr; }
+
+private:
+    struct Operations
+    {
+        R (*invoke)(void* storage, Args&&... args);
+        void (*copy)(void* destination, const void* source);
+        // Leaves the source destroyed
+        void (*move)(void* destination, void* source);
+        void (*destroy)(void* storage);
+    };
+
+    template<typename F>
+    static constexpr bool IsInline()
+    {
+        return sizeof(F) <= InlineSize && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<F>;
+    }
+
+    template<typename F>
+    static F& Get(void* storage)
+    {
+        if constexpr (IsInline<F>())
+            return *std::launder(static_cast<F*>(storage));
+        else
+            return **std::launder(static_cast<F**>(storage));
+    }
+
+    template<typename F>
+    static constexpr Operations s_operations = {
+        [](void* storage, Args&&... args) -> R
+        {
+            return std::invoke(Get<F>(storage), std::forward<Args>(args)...);
+        },
+        [](void* destination, const void* source)
+        {
+            const F& function = Get<F>(const_cast<void*>(source));
+            if constexpr (IsInline<F>())
+                new (destination) F(function);
+            else
+                new (destination) F*(new F(function));
+        },
+        [](void* destination, void* source)
+        {
+            if constexpr (IsInline<F>())
+            {
+                new (destination) F(std::move(Get<F>(source)));
+                Get<F>(source).~F();
+            }
+            else
+            {
+                new (destination) F*(*std::launder(static_cast<F**>(source)));
+            }
+        },
+        [](void* storage)
+        {
+            if constexpr (IsInline<F>())
+                Get<F>(storage).~F();
+            else
+                delete *std::launder(static_cast<F**>(storage));
+        }
+    };
+
+    void Reset()
+    {
+        if (m_operations)
+            m_operations->destroy(m_storage);
+        m_operations = nullptr;
+    }
+
+private:
+    // Calling a delegate may mutate its callable, like std::function
+    alignas(std::max_align_t) mutable std::byte m_storage[InlineSize];
+    const Operations* m_operations = nullptr;
+};
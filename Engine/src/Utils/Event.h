@@ -1,22 +1,24 @@
 #pragma once
 #include "EngineAPI.h"
-#include <functional>
-#include <vector>
-#include <mutex>
-#pragma once
-#include "EngineAPI.h"
-#include <functional>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <mutex>
 #include <cstdint>
 #include <algorithm>
 
+#include "Delegate.h"
+
 using EventHandle = uint64_t;
 
+// Bindings are copy on write: Bind and Unbind publish a new list under m_mutex,
+// Invoke reads the current list without locking nor allocating.
+// A replaced list is freed by the first write that sees no Invoke running, so binding changes are cheap only when rare.
+// A callback bound or unbound during an Invoke takes effect on the next one.
 template<typename... Args>
 class ENGINE_API Event {
 public:
-    using Callback = std::function<void(Args...)>;
+    using Callback = Delegate<void(Args...)>;
 
     Event() = default;
     Event(const Event&) = delete;
@@ -29,31 +31,38 @@ class ENGINE_API Event {
     {
         std::lock_guard<std::mutex> lock(m_mutex);
         EventHandle id = ++m_nextId;
-        m_callbacks.push_back({ id, std::move(callback) });
+        std::unique_ptr<CallbackList> callbacks = CopyCallbacks();
+        callbacks->push_back({ id, std::move(callback) });
+        Publish(std::move(callbacks));
         return id;
     }
 
     virtual void Unbind(EventHandle id)
     {
         std::lock_guard<std::mutex> lock(m_mutex);
-        std::erase_if(m_callbacks, [id](const Entry& e) { return e.id == id; });
+        std::unique_ptr<CallbackList> callbacks = CopyCallbacks();
+        if (std::erase_if(*callbacks, [id](const Entry& e) { return e.id == id; }) > 0)
+            Publish(std::move(callbacks));
     }
 
     void ClearBindings()
     {
         std::lock_guard<std::mutex> lock(m_mutex);
-        m_callbacks.clear();
+        Publish(nullptr);
     }
 
     virtual void Invoke(Args... args)
     {
-        std::vector<Entry> copy;
-        {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            copy = m_callbacks;
-        }
+        // Most events have no binding, like the model matrix event of most transforms
+        if (!m_hasCallbacks.load(std::memory_order_relaxed))
+            return;
+
+        ReadScope scope(m_readers);
+        const CallbackList* callbacks = m_callbacks.load();
+        if (!callbacks)
+            return;
 
-        for (auto& e : copy)
+        for (const Entry& e : *callbacks)
             e.callback(args...);
     }
 
@@ -64,66 +73,102 @@ class ENGINE_API Event {
 
     EventHandle operator+=(Callback callback)
     {
-        return Bind(callback);    
+        return Bind(std::move(callback));
     }
-    
+
 protected:
     struct Entry {
         EventHandle id;
         Callback callback;
     };
+    using CallbackList = std::vector<Entry>;
+
+    // Counts the Invoke calls reading a list
+    struct ReadScope {
+        ReadScope(std::atomic<uint32_t>& readers) : readers(readers) { readers.fetch_add(1); }
+        ~ReadScope() { readers.fetch_sub(1, std::memory_order_release); }
+        std::atomic<uint32_t>& readers;
+    };
+
+    // CopyCallbacks, Publish and TakeCallbacks need m_mutex
+    std::unique_ptr<CallbackList> CopyCallbacks() const
+    {
+        return m_current ? std::make_unique<CallbackList>(*m_current) : std::make_unique<CallbackList>();
+    }
+
+    void Publish(std::unique_ptr<const CallbackList> callbacks)
+    {
+        if (callbacks && callbacks->empty())
+            callbacks.reset();
+
+        m_callbacks.store(callbacks.get());
+        m_hasCallbacks.store(callbacks != nullptr, std::memory_order_relaxed);
+        if (m_current)
+            m_retired.push_back(std::move(m_current));
+        m_current = std::move(callbacks);
+
+        // The store above comes before this load: an Invoke that was not counted yet will read the new list
+        if (m_readers.load() == 0)
+            m_retired.clear();
+    }
+
+    // Unpublishes the list without freeing it, for the caller to run it
+    std::unique_ptr<const CallbackList> TakeCallbacks()
+    {
+        m_callbacks.store(nullptr);
+        m_hasCallbacks.store(false, std::memory_order_relaxed);
+        return std::move(m_current);
+    }
 
-    std::vector<Entry> m_callbacks;
+    std::atomic<const CallbackList*> m_callbacks = nullptr;
+    std::atomic<bool> m_hasCallbacks = false;
+    std::atomic<uint32_t> m_readers = 0;
+    std::unique_ptr<const CallbackList> m_current;
+    // Replaced lists an Invoke may still be reading
+    std::vector<std::unique_ptr<const CallbackList>> m_retired;
     EventHandle m_nextId = 0;
+    // Only taken by the writers
     mutable std::mutex m_mutex;
 };
 
 // Event that run only once (when bind, call the method if already call)
 class ENGINE_API OnceEvent : public Event<> {
 public:
-    using Callback = std::function<void()>;
+    using Callback = Event<>::Callback;
 
     EventHandle Bind(Callback callback) override
     {
-        bool callNow = false;
-        EventHandle id = 0;
-
         {
             std::lock_guard<std::mutex> lock(m_mutex);
-            if (!m_called) {
-                id = ++m_nextId;
-                m_callbacks.push_back({ id, std::move(callback) });
-            } else {
-                callNow = true;
+            if (!m_called)
+            {
+                EventHandle id = ++m_nextId;
+                std::unique_ptr<CallbackList> callbacks = CopyCallbacks();
+                callbacks->push_back({ id, std::move(callback) });
+                Publish(std::move(callbacks));
+                return id;
             }
         }
 
-        if (callNow)
-            callback();
-
-        return id;
-    }
-
-    void Unbind(EventHandle id) override
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        std::erase_if(m_callbacks, [id](const Entry& e) { return e.id == id; });
+        callback();
+        return 0;
     }
 
     void Invoke() override
     {
-        std::vector<Entry> copy;
+        std::unique_ptr<const CallbackList> callbacks;
         {
             std::lock_guard<std::mutex> lock(m_mutex);
             if (m_called)
                 return;
 
             m_called = true;
-            copy = m_callbacks;
-            m_callbacks.clear();
+            callbacks = TakeCallbacks();
         }
 
-        for (auto& e : copy)
+        if (!callbacks)
+            return;
+        for (const Entry& e : *callbacks)
             e.callback();
     }
 
@@ -0,0 +1,117 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+// Index into a HandlePool plus the generation of the slot when the handle was made.
+// A handle to a removed object never resolves, even once its slot is reused.
+template<typename T>
+struct Handle
+{
+    uint32_t index = 0;
+    // 0 is never a live generation, a default handle is invalid
+    uint32_t generation = 0;
+
+    Handle() = default;
+    Handle(uint32_t index, uint32_t generation) : index(index), generation(generation) {}
+
+    template<typename U> requires std::is_base_of_v<T, U>
+    Handle(const Handle<U>& other) : index(other.index), generation(other.generation) {}
+
+    // For a handle known to point to a U
+    template<typename U>
+    Handle<U> Cast() const { return { index, generation }; }
+
+    bool IsValid() const { return generation != 0; }
+    explicit operator bool() const { return IsValid(); }
+
+    bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+};
+
+// Slot map from handles to objects owned elsewhere.
+// Slots live in fixed pages that are never moved, a resolve is two loads and a compare with no atomics.
+// Add and Remove belong to the owning thread, Get may run on any thread as long as no slot it reads is being removed.
+template<typename T>
+class HandlePool
+{
+public:
+    static constexpr uint32_t PageSize = 4096;
+    static constexpr uint32_t MaxPages = 1024;
+
+    HandlePool() = default;
+    HandlePool(const HandlePool&) = delete;
+    HandlePool& operator=(const HandlePool&) = delete;
+
+    // Throws once every page is used, nothing is changed then
+    Handle<T> Add(T* object)
+    {
+        uint32_t index = m_freeHead;
+        if (index != InvalidIndex)
+        {
+            m_freeHead = GetSlot(index).nextFree;
+        }
+        else
+        {
+            if (m_size == PageSize * MaxPages)
+                throw std::runtime_error("HandlePool is full");
+            index = m_size++;
+            std::unique_ptr<Slot[]>& page = m_pages[index / PageSize];
+            if (!page)
+                page = std::make_unique<Slot[]>(PageSize);
+        }
+
+        Slot& slot = GetSlot(index);
+        slot.object = object;
+        slot.nextFree = InvalidIndex;
+        m_count++;
+        return { index, slot.generation };
+    }
+
+    void Remove(Handle<T> handle)
+    {
+        if (!Get(handle))
+            return;
+
+        Slot& slot = GetSlot(handle.index);
+        slot.object = nullptr;
+        // Skips 0 on wrap around so default handles stay invalid
+        if (++slot.generation == 0)
+            slot.generation = 1;
+        slot.nextFree = m_freeHead;
+        m_freeHead = handle.index;
+        m_count--;
+    }
+
+    T* Get(Handle<T> handle) const
+    {
+        if (!handle.IsValid() || handle.index / PageSize >= MaxPages)
+            return nullptr;
+        const std::unique_ptr<Slot[]>& page = m_pages[handle.index / PageSize];
+        if (!page)
+            return nullptr;
+        const Slot& slot = page[handle.index % PageSize];
+        return slot.generation == handle.generation ? slot.object : nullptr;
+    }
+
+    size_t Count() const { return m_count; }
+
+private:
+    static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+    struct Slot
+    {
+        T* object = nullptr;
+        uint32_t generation = 1;
+        uint32_t nextFree = InvalidIndex;
+    };
+
+    Slot& GetSlot(uint32_t index) { return m_pages[index / PageSize][index % PageSize]; }
+
+private:
+    std::array<std::unique_ptr<Slot[]>, MaxPages> m_pages;
+    uint32_t m_size = 0;
+    uint32_t m_freeHead = InvalidIndex;
+    size_t m_count = 0;
+};
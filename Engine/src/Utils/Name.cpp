@@ -0,0 +1,66 @@
+#include "Name.h"
+
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace
+{
+    // Id 0 is the empty text
+    struct NameTable
+    {
+        std::shared_mutex mutex;
+        // A deque never moves its strings, the views in ids stay valid
+        std::deque<std::string> texts = { std::string() };
+        std::unordered_map<std::string_view, uint32_t> ids = { { std::string_view(), 0 } };
+    };
+
+    NameTable& GetTable()
+    {
+        static NameTable table;
+        return table;
+    }
+}
+
+Name::Name(std::string_view text)
+{
+    NameTable& table = GetTable();
+    {
+        std::shared_lock lock(table.mutex);
+        auto it = table.ids.find(text);
+        if (it != table.ids.end())
+        {
+            m_id = it->second;
+            return;
+        }
+    }
+
+    std::unique_lock lock(table.mutex);
+    // Another thread may have added it between the two locks
+    auto it = table.ids.find(text);
+    if (it == table.ids.end())
+    {
+        const std::string& stored = table.texts.emplace_back(text);
+        it = table.ids.emplace(std::string_view(stored), static_cast<uint32_t>(table.texts.size() - 1)).first;
+    }
+    m_id = it->second;
+}
+
+const std::string& Name::GetString() const
+{
+    NameTable& table = GetTable();
+    std::shared_lock lock(table.mutex);
+    return table.texts[m_id];
+}
+
+Name Name::Find(std::string_view text)
+{
+    NameTable& table = GetTable();
+    std::shared_lock lock(table.mutex);
+    auto it = table.ids.find(text);
+    Name name;
+    if (it != table.ids.end())
+        name.m_id = it->second;
+    return name;
+}
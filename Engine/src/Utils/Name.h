@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// Interned string: equal texts share one id, so a name is compared and hashed as an integer.
+// The texts live in a process wide table and are never freed. Thread safe.
+class Name
+{
+public:
+    Name() = default;
+    Name(std::string_view text);
+    Name(const char* text) : Name(std::string_view(text)) {}
+    Name(const std::string& text) : Name(std::string_view(text)) {}
+
+    // Reference valid for the whole run
+    const std::string& GetString() const;
+    uint32_t GetID() const { return m_id; }
+    bool IsEmpty() const { return m_id == 0; }
+
+    bool operator==(const Name& other) const { return m_id == other.m_id; }
+    bool operator!=(const Name& other) const { return m_id != other.m_id; }
+
+    // Existing name of text, the empty name when it was never interned. Does not grow the table.
+    static Name Find(std::string_view text);
+
+private:
+    uint32_t m_id = 0;
+};
+
+namespace std
+{
+    template <>
+    struct hash<Name>
+    {
+        size_t operator()(const Name& name) const
+        {
+            return hash<uint32_t>()(name.GetID());
+        }
+    };
+}
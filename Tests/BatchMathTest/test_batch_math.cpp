@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Physic/Frustum.h"
+#include "Utils/BatchMath.h"
+
+using namespace testing;
+
+// Boxes spread inside, outside and across a cube frustum, padded to whole blocks like the BVH does
+class BatchMathTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_backend = BatchMath::GetBackend();
+
+        const Vec3f axes[3] = { Vec3f(1.0f, 0.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f), Vec3f(0.0f, 0.0f, 1.0f) };
+        for (int axis = 0; axis < 3; axis++)
+        {
+            frustum.planes[axis * 2] = Plane(axes[axis], -HalfSize);
+            frustum.planes[axis * 2 + 1] = Plane(-axes[axis], -HalfSize);
+        }
+    }
+
+    void TearDown() override
+    {
+        BatchMath::SetBackend(m_backend);
+    }
+
+    // count boxes on a grid from -2 * HalfSize to 2 * HalfSize, the tail of the last block has NaN centers
+    void Fill(size_t count)
+    {
+        const size_t size = (count + BatchMath::CullBlockSize - 1) / BatchMath::CullBlockSize * BatchMath::CullBlockSize;
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        for (auto* array : { &centerX, &centerY, &centerZ })
+            array->assign(size, nan);
+        for (auto* array : { &extentX, &extentY, &extentZ, &radius })
+            array->assign(size, 0.0f);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const float t = static_cast<float>(i) / static_cast<float>(count);
+            centerX[i] = (t * 4.0f - 2.0f) * HalfSize;
+            centerY[i] = std::sin(static_cast<float>(i)) * 2.0f * HalfSize;
+            centerZ[i] = std::cos(static_cast<float>(i) * 0.7f) * 1.5f * HalfSize;
+            extentX[i] = 0.5f + static_cast<float>(i % 7);
+            extentY[i] = 0.25f + static_cast<float>(i % 3);
+            extentZ[i] = 1.0f + static_cast<float>(i % 5) * 0.5f;
+            radius[i] = std::sqrt(extentX[i] * extentX[i] + extentY[i] * extentY[i] + extentZ[i] * extentZ[i]);
+        }
+    }
+
+    // Runs the current backend passes times over every block with its own last planes
+    std::vector<uint8_t> Cull(int passes)
+    {
+        std::vector<uint8_t> lastPlanes(centerX.size() / BatchMath::CullBlockSize, 0);
+        std::vector<uint8_t> visible(centerX.size(), 0xFF);
+        const BatchMath::CullingBounds bounds = { centerX.data(), centerY.data(), centerZ.data(), extentX.data(), extentY.data(), extentZ.data(), radius.data(), lastPlanes.data() };
+        for (int pass = 0; pass < passes; pass++)
+            BatchMath::CullBounds(bounds, frustum, visible.data(), 0, lastPlanes.size());
+        return visible;
+    }
+
+    static constexpr float HalfSize = 10.0f;
+
+    Frustum frustum;
+    std::vector<float> centerX, centerY, centerZ, extentX, extentY, extentZ, radius;
+
+private:
+    BatchMath::Backend m_backend = BatchMath::Backend::Scalar;
+};
+
+// ============================================================================
+// Culling Tests
+// ============================================================================
+
+TEST_F(BatchMathTest, CullBounds_ScalarMatchesBoxTest)
+{
+    Fill(61);
+    ASSERT_TRUE(BatchMath::SetBackend(BatchMath::Backend::Scalar));
+    const std::vector<uint8_t> visible = Cull(1);
+
+    for (size_t i = 0; i < 61; i++)
+    {
+        const bool inside = std::abs(centerX[i]) <= HalfSize + extentX[i]
+            && std::abs(centerY[i]) <= HalfSize + extentY[i]
+            && std::abs(centerZ[i]) <= HalfSize + extentZ[i];
+        EXPECT_EQ(visible[i], inside ? 1 : 0) << "box " << i;
+    }
+}
+
+TEST_F(BatchMathTest, CullBounds_PaddingIsNeverVisible)
+{
+    Fill(61);
+    for (auto backend : { BatchMath::Backend::Scalar, BatchMath::Backend::SSE, BatchMath::Backend::AVX2, BatchMath::Backend::NEON })
+    {
+        if (!BatchMath::SetBackend(backend))
+            continue;
+        const std::vector<uint8_t> visible = Cull(2);
+        for (size_t i = 61; i < visible.size(); i++)
+            EXPECT_EQ(visible[i], 0) << BatchMath::GetBackendName(backend) << " padding " << i;
+    }
+}
+
+TEST_F(BatchMathTest, CullBounds_EveryBackendMatchesScalar)
+{
+    // Whole blocks, a tail of one and a tail of seven
+    for (size_t count : { 64u, 57u, 63u })
+    {
+        Fill(count);
+        ASSERT_TRUE(BatchMath::SetBackend(BatchMath::Backend::Scalar));
+        const std::vector<uint8_t> expected = Cull(3);
+
+        for (auto backend : { BatchMath::Backend::SSE, BatchMath::Backend::AVX2, BatchMath::Backend::NEON })
+        {
+            if (!BatchMath::IsSupported(backend))
+                continue;
+            ASSERT_TRUE(BatchMath::SetBackend(backend));
+            // Later passes start each block from the plane kept by the previous one
+            EXPECT_EQ(Cull(1), expected) << BatchMath::GetBackendName(backend) << " count " << count;
+            EXPECT_EQ(Cull(3), expected) << BatchMath::GetBackendName(backend) << " count " << count;
+        }
+    }
+}
@@ -0,0 +1,13 @@
+
+target("BatchMathTest")
+	set_kind("binary")
+
+	add_deps("Engine")
+	add_includedirs("../../Engine/src")
+
+	add_files("test_batch_math.cpp")
+
+	add_packages("galaxymath")
+	add_packages("thread-pool")
+	add_packages("gtest")
+target_end()
@@ -0,0 +1,280 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Utils/Event.h"
+
+using namespace testing;
+
+// Counts the allocations of the test thread while enabled
+static thread_local bool s_countAllocations = false;
+static thread_local size_t s_allocationCount = 0;
+
+void* operator new(size_t size)
+{
+    if (s_countAllocations)
+        s_allocationCount++;
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+// Event before copy on write bindings, kept to compare against
+template<typename... Args>
+class LockingEvent
+{
+public:
+    using Callback = std::function<void(Args...)>;
+
+    EventHandle Bind(Callback callback)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        EventHandle id = ++m_nextId;
+        m_callbacks.push_back({ id, std::move(callback) });
+        return id;
+    }
+
+    void Invoke(Args... args)
+    {
+        std::vector<Entry> copy;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            copy = m_callbacks;
+        }
+
+        for (auto& e : copy)
+            e.callback(args...);
+    }
+
+private:
+    struct Entry {
+        EventHandle id;
+        Callback callback;
+    };
+
+    std::vector<Entry> m_callbacks;
+    EventHandle m_nextId = 0;
+    std::mutex m_mutex;
+};
+
+// ============================================================================
+// Delegate Tests
+// ============================================================================
+
+TEST(DelegateTest, SmallCallableIsStoredInPlace)
+{
+    int value = 0;
+    int* target = &value;
+
+    s_allocationCount = 0;
+    s_countAllocations = true;
+    Delegate<void(int)> delegate = [target](int add) { *target += add; };
+    Delegate<void(int)> copy = delegate;
+    Delegate<void(int)> moved = std::move(copy);
+    delegate(1);
+    moved(2);
+    s_countAllocations = false;
+
+    EXPECT_EQ(value, 3);
+    EXPECT_EQ(s_allocationCount, 0u);
+}
+
+TEST(DelegateTest, LargeCallableIsCopied)
+{
+    std::array<int, 32> values = {};
+    values[31] = 5;
+    Delegate<int()> delegate = [values]() { return values[31]; };
+    Delegate<int()> copy = delegate;
+    delegate = nullptr;
+
+    EXPECT_FALSE(delegate);
+    EXPECT_EQ(copy(), 5);
+}
+
+TEST(DelegateTest, CapturesAreDestroyed)
+{
+    std::shared_ptr<int> counter = std::make_shared<int>(0);
+    {
+        Delegate<void()> small = [counter]() {};
+        Delegate<void()> large = [counter, padding = std::array<char, 64>()]() {};
+        Delegate<void()> copy = large;
+        EXPECT_EQ(counter.use_count(), 4);
+    }
+    EXPECT_EQ(counter.use_count(), 1);
+}
+
+// ============================================================================
+// Event Tests
+// ============================================================================
+
+TEST(EventTest, Invoke_CallsBindingsInOrder)
+{
+    Event<int> event;
+    std::string calls;
+    event.Bind([&calls](int value) { calls += "a" + std::to_string(value); });
+    event += [&calls](int value) { calls += "b" + std::to_string(value); };
+
+    event.Invoke(1);
+    event(2);
+
+    EXPECT_EQ(calls, "a1b1a2b2");
+}
+
+TEST(EventTest, Unbind_RemovesOnlyThatBinding)
+{
+    Event<> event;
+    int a = 0;
+    int b = 0;
+    EventHandle handle = event.Bind([&a]() { a++; });
+    event.Bind([&b]() { b++; });
+
+    event.Unbind(handle);
+    event.Invoke();
+    event.ClearBindings();
+    event.Invoke();
+
+    EXPECT_EQ(a, 0);
+    EXPECT_EQ(b, 1);
+}
+
+TEST(EventTest, ChangesDuringInvoke_ApplyToNextInvoke)
+{
+    Event<> event;
+    int calls = 0;
+    EventHandle self = 0;
+    self = event.Bind([&]()
+    {
+        calls++;
+        event.Unbind(self);
+        event.Bind([&calls]() { calls += 10; });
+    });
+
+    event.Invoke();
+    EXPECT_EQ(calls, 1);
+    event.Invoke();
+    EXPECT_EQ(calls, 11);
+}
+
+TEST(EventTest, Invoke_DoesNotAllocate)
+{
+    Event<int> event;
+    int sum = 0;
+    for (int i = 0; i < 4; i++)
+        event.Bind([&sum](int value) { sum += value; });
+
+    s_allocationCount = 0;
+    s_countAllocations = true;
+    for (int i = 0; i < 100; i++)
+        event.Invoke(1);
+    s_countAllocations = false;
+
+    EXPECT_EQ(sum, 400);
+    EXPECT_EQ(s_allocationCount, 0u);
+}
+
+TEST(EventTest, BindWhileInvokingOnOtherThreads)
+{
+    Event<> event;
+    std::atomic<int> calls = 0;
+    event.Bind([&calls]() { calls++; });
+
+    constexpr int invokeCount = 10'000;
+    std::vector<std::thread> invokers;
+    for (int i = 0; i < 4; i++)
+    {
+        invokers.emplace_back([&]()
+        {
+            for (int j = 0; j < invokeCount; j++)
+                event.Invoke();
+        });
+    }
+
+    for (int i = 0; i < 1000; i++)
+    {
+        EventHandle handle = event.Bind([]() {});
+        event.Unbind(handle);
+    }
+    for (std::thread& thread : invokers)
+        thread.join();
+
+    // The first binding is in every published list
+    EXPECT_EQ(calls.load(), 4 * invokeCount);
+}
+
+TEST(EventTest, OnceEvent_CallsEachBindingOnce)
+{
+    OnceEvent event;
+    int before = 0;
+    int after = 0;
+    event.Bind([&before]() { before++; });
+
+    event.Invoke();
+    event.Invoke();
+    event.Bind([&after]() { after++; });
+
+    EXPECT_EQ(before, 1);
+    EXPECT_EQ(after, 1);
+}
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+template<typename E>
+static double MeasureInvokeNanoseconds(size_t bindingCount)
+{
+    E event;
+    int sum = 0;
+    for (size_t i = 0; i < bindingCount; i++)
+        event.Bind([&sum](int value) { sum += value; });
+
+    constexpr size_t invokeCount = 1'000'000;
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < invokeCount; i++)
+        event.Invoke(1);
+    const auto end = std::chrono::high_resolution_clock::now();
+    EXPECT_EQ(static_cast<size_t>(sum), invokeCount * bindingCount);
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / invokeCount;
+}
+
+TEST(EventTest, Benchmark_InvokeAgainstLockingEvent)
+{
+    for (size_t bindingCount : { 0, 1, 4, 16 })
+    {
+        const double locking = MeasureInvokeNanoseconds<LockingEvent<int>>(bindingCount);
+        const double current = MeasureInvokeNanoseconds<Event<int>>(bindingCount);
+        std::printf("[ BENCH    ] %2zu bindings: %.1f ns/invoke, was %.1f ns/invoke\n", bindingCount, current, locking);
+
+        EXPECT_LT(current, locking);
+    }
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "Render/OcclusionCuller.h"
+
+using namespace testing;
+
+// The identity view projection maps world x and y in [-1, 1] to the screen and keeps z as the depth
+class OcclusionTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        culler.Begin(Mat4::Identity());
+    }
+
+    // Two triangles covering [min, max] in x and y at the given depth
+    void AddQuad(float min, float max, float depth)
+    {
+        const float vertices[] = {
+            min, min, depth,  max, min, depth,  max, max, depth,
+            min, min, depth,  max, max, depth,  min, max, depth,
+        };
+        culler.AddOccluder(vertices, 6, 3, Mat4::Identity());
+    }
+
+    static BoundingBox Box(float minX, float minY, float minZ, float maxX, float maxY, float maxZ)
+    {
+        return BoundingBox(Vec3f(minX, minY, minZ), Vec3f(maxX, maxY, maxZ));
+    }
+
+    OcclusionCuller culler { 64, 64 };
+};
+
+// ============================================================================
+// Rasterization Tests
+// ============================================================================
+
+TEST_F(OcclusionTest, Rasterize_WritesOccluderDepth)
+{
+    AddQuad(-0.5f, 0.5f, 0.2f);
+    culler.Rasterize();
+
+    EXPECT_FLOAT_EQ(culler.GetDepth(32, 32), 0.2f);
+    EXPECT_EQ(culler.GetDepth(1, 1), FLT_MAX);
+}
+
+TEST_F(OcclusionTest, Rasterize_KeepsNearestDepth)
+{
+    AddQuad(-0.5f, 0.5f, 0.6f);
+    AddQuad(-0.25f, 0.25f, 0.3f);
+    culler.Rasterize();
+
+    EXPECT_FLOAT_EQ(culler.GetDepth(32, 32), 0.3f);
+    EXPECT_FLOAT_EQ(culler.GetDepth(20, 20), 0.6f);
+}
+
+// ============================================================================
+// Occludee Tests
+// ============================================================================
+
+TEST_F(OcclusionTest, IsVisible_EmptyBufferHidesNothing)
+{
+    culler.Rasterize();
+
+    EXPECT_TRUE(culler.IsVisible(Box(-0.1f, -0.1f, 0.5f, 0.1f, 0.1f, 0.6f)));
+}
+
+TEST_F(OcclusionTest, IsVisible_BoxBehindOccluderIsHidden)
+{
+    AddQuad(-0.5f, 0.5f, 0.2f);
+    culler.Rasterize();
+
+    EXPECT_FALSE(culler.IsVisible(Box(-0.3f, -0.3f, 0.5f, 0.3f, 0.3f, 0.6f)));
+}
+
+TEST_F(OcclusionTest, IsVisible_BoxInFrontOrBesideOccluderIsVisible)
+{
+    AddQuad(-0.5f, 0.5f, 0.2f);
+    culler.Rasterize();
+
+    EXPECT_TRUE(culler.IsVisible(Box(-0.3f, -0.3f, 0.05f, 0.3f, 0.3f, 0.1f)));
+    EXPECT_TRUE(culler.IsVisible(Box(0.3f, -0.3f, 0.5f, 0.7f, 0.3f, 0.6f)));
+    // Crossing the occluder
+    EXPECT_TRUE(culler.IsVisible(Box(-0.3f, -0.3f, 0.1f, 0.3f, 0.3f, 0.6f)));
+}
+
+TEST_F(OcclusionTest, IsVisible_UntestableRectIsVisible)
+{
+    AddQuad(-1.0f, 1.0f, 0.2f);
+    culler.Rasterize();
+
+    // Behind the occluder but outside the screen
+    EXPECT_TRUE(culler.IsVisible(Box(1.5f, -0.3f, 0.5f, 2.0f, 0.3f, 0.6f)));
+    EXPECT_TRUE(culler.IsVisible(Box(-0.3f, -2.0f, 0.5f, 0.3f, -1.5f, 0.6f)));
+    // Flat on a pixel edge, the rect covers no pixel
+    EXPECT_TRUE(culler.IsVisible(Box(0.0f, -0.3f, 0.5f, 0.0f, 0.3f, 0.6f)));
+    EXPECT_TRUE(culler.IsVisible(Box(0.0f, 0.0f, 0.5f, 0.0f, 0.0f, 0.6f)));
+    // Touching the screen, still tested
+    EXPECT_FALSE(culler.IsVisible(Box(0.5f, -0.3f, 0.5f, 1.5f, 0.3f, 0.6f)));
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+TEST(OcclusionBenchmark, Benchmark_RasterizeAndTest)
+{
+    OcclusionCuller culler;
+    culler.Begin(Mat4::Identity());
+
+    // A grid of wall quads in front, boxes spread behind them
+    std::vector<float> vertices;
+    for (int i = 0; i < 2000; i++)
+    {
+        const float x = -1.0f + 0.05f * static_cast<float>(i % 40);
+        const float y = -1.0f + 0.04f * static_cast<float>(i / 40);
+        const float depth = 0.1f + 0.0001f * static_cast<float>(i);
+        const float quad[] = {
+            x, y, depth,  x + 0.06f, y, depth,  x + 0.06f, y + 0.05f, depth,
+            x, y, depth,  x + 0.06f, y + 0.05f, depth,  x, y + 0.05f, depth,
+        };
+        vertices.insert(vertices.end(), std::begin(quad), std::end(quad));
+    }
+    culler.AddOccluder(vertices.data(), vertices.size() / 3, 3, Mat4::Identity());
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    culler.Rasterize();
+    const auto rasterized = std::chrono::high_resolution_clock::now();
+
+    constexpr size_t boxCount = 100'000;
+    size_t visible = 0;
+    for (size_t i = 0; i < boxCount; i++)
+    {
+        const float x = -0.95f + 1.9f * static_cast<float>(i % 317) / 317.0f;
+        const float y = -0.95f + 1.9f * static_cast<float>(i % 331) / 331.0f;
+        visible += culler.IsVisible(BoundingBox(Vec3f(x, y, 0.5f), Vec3f(x + 0.02f, y + 0.02f, 0.6f))) ? 1 : 0;
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    std::printf("[ BENCH    ] %zu triangles rasterized in %.1f us\n", culler.GetTriangleCount(),
+        std::chrono::duration<double, std::micro>(rasterized - start).count());
+    std::printf("[ BENCH    ] %zu boxes tested in %.1f us, %zu visible\n", boxCount,
+        std::chrono::duration<double, std::micro>(end - rasterized).count(), visible);
+    EXPECT_EQ(visible, 0u);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
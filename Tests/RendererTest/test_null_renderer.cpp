@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "Component/TransformComponent.h"
+#include "Core/Engine.h"
+#include "Render/NullRenderer.h"
+#include "Resource/Model.h"
+#include "Scene/GameObject.h"
+#include "Scene/Scene.h"
+#include "Render/Vulkan/VulkanIndexBuffer.h"
+#include "Render/Vulkan/VulkanVertexBuffer.h"
+
+using namespace testing;
+
+class NullRendererTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        renderer = IRenderer::Create(RenderAPI::Null);
+        ASSERT_NE(renderer, nullptr);
+        ASSERT_TRUE(renderer->Initialize(nullptr));
+    }
+
+    void TearDown() override
+    {
+        renderer->Cleanup();
+    }
+
+    const NullRendererStats& Stats() const
+    {
+        return static_cast<NullRenderer*>(renderer.get())->GetStats();
+    }
+
+    std::unique_ptr<IRenderer> renderer;
+};
+
+// ============================================================================
+// Upload Tests
+// ============================================================================
+
+TEST_F(NullRendererTest, Initialize_WithoutWindow)
+{
+    EXPECT_TRUE(renderer->IsInitialized());
+    EXPECT_EQ(renderer->GetRenderAPI(), RenderAPI::Null);
+    EXPECT_NE(renderer->GetRenderQueueManager(), nullptr);
+}
+
+TEST_F(NullRendererTest, CreateBuffers_CountsUploads)
+{
+    const std::vector<float> vertices(33, 0.0f);
+    const std::vector<uint32_t> indices = { 0, 1, 2 };
+
+    auto vertexBuffer = renderer->CreateVertexBuffer(vertices.data(), static_cast<uint32_t>(vertices.size()), 11);
+    auto indexBuffer = renderer->CreateIndexBuffer(indices.data(), static_cast<uint32_t>(indices.size()));
+
+    ASSERT_NE(vertexBuffer, nullptr);
+    ASSERT_NE(indexBuffer, nullptr);
+    EXPECT_EQ(vertexBuffer->GetVertexCount(), 3u);
+    EXPECT_EQ(indexBuffer->GetIndexCount(), 3u);
+    EXPECT_EQ(Stats().vertexBuffers, 1u);
+    EXPECT_EQ(Stats().indexBuffers, 1u);
+    EXPECT_EQ(Stats().uploadedBytes, vertices.size() * sizeof(float) + indices.size() * sizeof(uint32_t));
+}
+
+// ============================================================================
+// Draw Tests
+// ============================================================================
+
+TEST_F(NullRendererTest, Draw_CountsTrianglesPerFrame)
+{
+    const std::vector<uint32_t> indices(12, 0);
+    auto indexBuffer = renderer->CreateIndexBuffer(indices.data(), static_cast<uint32_t>(indices.size()));
+
+    ASSERT_TRUE(renderer->BeginFrame());
+    renderer->DrawVertexSubMesh(indexBuffer.get(), 0, 12);
+    renderer->DrawVertexSubMesh(indexBuffer.get(), 6, 6, 1);
+    renderer->EndFrame();
+
+    EXPECT_EQ(renderer->GetTriangleCount(), 6u);
+    EXPECT_EQ(renderer->GetLodTriangleCount(1), 2u);
+    EXPECT_EQ(Stats().drawCalls, 2u);
+    EXPECT_EQ(Stats().frames, 1u);
+
+    ASSERT_TRUE(renderer->BeginFrame());
+    EXPECT_EQ(renderer->GetTriangleCount(), 0u);
+}
+
+// ============================================================================
+// Engine Tests
+// ============================================================================
+
+// The whole engine on the null backend, one instance for the suite like the engine singleton
+class NullEngineTest : public ::testing::Test
+{
+protected:
+    static void SetUpTestSuite()
+    {
+        engine = Engine::Create();
+        EngineDesc desc;
+        desc.renderAPI = RenderAPI::Null;
+        ASSERT_TRUE(engine->Initialize(desc));
+    }
+
+    static void TearDownTestSuite()
+    {
+        engine->WaitBeforeClean();
+        engine->Cleanup();
+    }
+
+    static const NullRendererStats& Stats()
+    {
+        return static_cast<NullRenderer*>(engine->GetRenderer())->GetStats();
+    }
+
+    // Runs frames like the editor loop until done returns true, false past the frame limit
+    template<typename Done>
+    static bool RunFramesUntil(Done done, int maxFrames = 2000)
+    {
+        for (int i = 0; i < maxFrames; i++)
+        {
+            if (!engine->BeginFrame())
+                return false;
+            engine->Update();
+            engine->Render();
+            engine->EndFrame();
+            if (done())
+                return true;
+            // Lets the loading threads progress
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+
+    inline static Engine* engine = nullptr;
+};
+
+TEST_F(NullEngineTest, Initialize_WithoutWindow)
+{
+    EXPECT_EQ(engine->GetWindow(), nullptr);
+    EXPECT_EQ(engine->GetRenderer()->GetRenderAPI(), RenderAPI::Null);
+    EXPECT_NE(engine->GetSceneHolder()->GetCurrentScene(), nullptr);
+}
+
+TEST_F(NullEngineTest, LoadModel_UploadsThroughTheRendererAndDraws)
+{
+    const NullRendererStats before = Stats();
+    ResourceManager* resourceManager = engine->GetResourceManager();
+    SafePtr<Model> model = resourceManager->Load<Model>(RESOURCE_PATH"/models/Cube.obj");
+    ASSERT_TRUE(RunFramesUntil([&]()
+    {
+        if (!model->IsLoaded() || model->GetMeshes().empty())
+            return false;
+        for (const SafePtr<Mesh>& mesh : model->GetMeshes())
+        {
+            if (!mesh->SentToGPU())
+                return false;
+        }
+        return true;
+    }));
+    EXPECT_GE(Stats().vertexBuffers - before.vertexBuffers, model->GetMeshes().size());
+    EXPECT_GE(Stats().indexBuffers - before.indexBuffers, model->GetMeshes().size());
+    EXPECT_GT(Stats().uploadedBytes, before.uploadedBytes);
+
+    // In front of the editor camera, drawn once the scene culled it in
+    Scene* scene = engine->GetSceneHolder()->GetCurrentScene();
+    SafePtr<GameObject> object = Model::CreateGameObject(model.getPtr(), scene);
+    object->GetTransform()->SetLocalPosition(Vec3f(0.0f, 0.0f, 5.0f));
+    const uint64_t drawCalls = Stats().drawCalls;
+    const uint64_t frames = Stats().frames;
+    ASSERT_TRUE(RunFramesUntil([&]() { return engine->GetRenderer()->GetTriangleCount() > 0; }));
+    EXPECT_GT(Stats().drawCalls, drawCalls);
+    EXPECT_GT(Stats().materialBinds, before.materialBinds);
+    EXPECT_GT(Stats().frames, frames);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Component/MeshComponent.h"
+#include "Component/TestComponent.h"
+#include "Component/TransformComponent.h"
+#include "Core/Engine.h"
+#include "Core/ThreadPool.h"
+#include "Render/NullRenderer.h"
+#include "Resource/Material.h"
+#include "Resource/Model.h"
+#include "Resource/ResourceManager.h"
+#include "Resource/Shader.h"
+#include "Scene/GameObject.h"
+#include "Scene/Scene.h"
+
+// Headless stress benchmark: builds a synthetic scene of MeshComponents on the null renderer,
+// runs frames without window or GPU and prints the timings of each stage as JSON.
+//   SceneBench [--objects N] [--depth D] [--moving F] [--components F] [--renderables F]
+//              [--model file.obj] [--frames N] [--warmup N] [--seed N] [--output file.json]
+
+namespace
+{
+    struct Config
+    {
+        size_t objects = 10'000;
+        // Objects per parent chain, 1 for a flat scene
+        size_t depth = 4;
+        // Fractions of the objects moved every frame, with a TestComponent and with a MeshComponent
+        double moving = 0.1;
+        double components = 0.5;
+        double renderables = 1.0;
+        // Meshes of the renderables, dense enough to get levels of detail
+        std::string model = RESOURCE_PATH"/models/Suzanne.obj";
+        size_t frames = 200;
+        // Frames run before sampling, the first one creates every culling proxy
+        size_t warmup = 5;
+        uint32_t seed = 1;
+        std::string output;
+    };
+
+    struct Stage
+    {
+        explicit Stage(const char* name) : name(name) {}
+
+        const char* name;
+        std::vector<double> samples;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    double Milliseconds(Clock::time_point start, Clock::time_point end)
+    {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    bool ParseArguments(int argc, char** argv, Config& config)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const char* name = argv[i];
+            if (i + 1 >= argc)
+            {
+                std::fprintf(stderr, "Missing value for %s\n", name);
+                return false;
+            }
+            const char* value = argv[++i];
+            if (std::strcmp(name, "--objects") == 0)
+                config.objects = std::strtoull(value, nullptr, 10);
+            else if (std::strcmp(name, "--depth") == 0)
+                config.depth = std::max<size_t>(1, std::strtoull(value, nullptr, 10));
+            else if (std::strcmp(name, "--moving") == 0)
+                config.moving = std::atof(value);
+            else if (std::strcmp(name, "--components") == 0)
+                config.components = std::atof(value);
+            else if (std::strcmp(name, "--renderables") == 0)
+                config.renderables = std::atof(value);
+            else if (std::strcmp(name, "--model") == 0)
+                config.model = value;
+            else if (std::strcmp(name, "--frames") == 0)
+                config.frames = std::max<size_t>(1, std::strtoull(value, nullptr, 10));
+            else if (std::strcmp(name, "--warmup") == 0)
+                config.warmup = std::strtoull(value, nullptr, 10);
+            else if (std::strcmp(name, "--seed") == 0)
+                config.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            else if (std::strcmp(name, "--output") == 0)
+                config.output = value;
+            else
+            {
+                std::fprintf(stderr, "Unknown option %s\n", name);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void WriteStage(std::string& json, Stage& stage, bool last)
+    {
+        std::vector<double>& samples = stage.samples;
+        std::sort(samples.begin(), samples.end());
+        double total = 0.0;
+        for (double sample : samples)
+            total += sample;
+        const size_t p95 = std::min(samples.size() - 1, static_cast<size_t>(std::ceil(0.95 * samples.size())) - 1);
+
+        char buffer[256];
+        std::snprintf(buffer, sizeof(buffer),
+            "    \"%s\": { \"mean\": %.4f, \"min\": %.4f, \"p95\": %.4f, \"max\": %.4f }%s\n",
+            stage.name, total / samples.size(), samples.front(), samples[p95], samples.back(), last ? "" : ",");
+        json += buffer;
+    }
+
+    // Runs empty frames until the meshes and the default material are on the renderer, false past the frame limit
+    bool WaitForResources(Engine* engine, const Model* model, const Material* material, int maxFrames = 10'000)
+    {
+        auto ready = [&]()
+        {
+            if (!model->IsLoaded() || model->GetMeshes().empty())
+                return false;
+            for (const SafePtr<Mesh>& mesh : model->GetMeshes())
+            {
+                if (!mesh->SentToGPU())
+                    return false;
+            }
+            const Shader* shader = material->GetShader().getPtr();
+            return material->IsLoaded() && shader && shader->SentToGPU();
+        };
+        for (int i = 0; i < maxFrames && !ready(); i++)
+        {
+            if (!engine->BeginFrame())
+                return false;
+            engine->EndFrame();
+            // Lets the loading threads progress
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return ready();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Config config;
+    if (!ParseArguments(argc, argv, config))
+        return 1;
+
+    Engine* engine = Engine::Create();
+    EngineDesc desc;
+    desc.renderAPI = RenderAPI::Null;
+    if (!engine->Initialize(desc))
+        return 1;
+    IRenderer* renderer = engine->GetRenderer();
+    const NullRendererStats& rendererStats = static_cast<NullRenderer*>(renderer)->GetStats();
+
+    ResourceManager* resourceManager = engine->GetResourceManager();
+    SafePtr<Model> model = resourceManager->Load<Model>(config.model);
+    const std::vector<SafePtr<Material>> materials = { resourceManager->GetDefaultMaterial() };
+    if (!model || !WaitForResources(engine, model.getPtr(), materials.front().getPtr()))
+    {
+        std::fprintf(stderr, "Could not load %s\n", config.model.c_str());
+        engine->WaitBeforeClean();
+        engine->Cleanup();
+        return 1;
+    }
+    const std::vector<SafePtr<Mesh>>& meshes = model->GetMeshes();
+
+    {
+        Scene* scene = engine->GetSceneHolder()->GetCurrentScene();
+        std::mt19937 rng(config.seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        // Chains of depth objects in a cube around the camera, children a little away from their parent
+        const Clock::time_point createStart = Clock::now();
+        const float extent = 2.0f * std::cbrt(static_cast<float>(config.objects));
+        std::vector<TransformComponent*> moving;
+        std::vector<Vec3f> movingOrigins;
+        GameObject* parent = nullptr;
+        for (size_t i = 0; i < config.objects; i++)
+        {
+            if (i % config.depth == 0)
+                parent = nullptr;
+            SafePtr<GameObject> object = scene->CreateGameObject(parent);
+            TransformComponent* transform = object->GetTransform().getPtr();
+
+            const Vec3f position = parent
+                ? Vec3f(unit(rng), unit(rng), unit(rng)) * 2.0f - Vec3f(1.0f)
+                : Vec3f(unit(rng), unit(rng), unit(rng)) * (2.0f * extent) - Vec3f(extent);
+            transform->SetLocalPosition(position);
+            // Gives its bounds to the transform at its first update, then goes through the culling, LOD and queue
+            if (unit(rng) < config.renderables)
+            {
+                MeshComponent* meshComponent = object->AddComponent<MeshComponent>().getPtr();
+                meshComponent->SetMaterials(materials);
+                meshComponent->SetMesh(meshes[i % meshes.size()]);
+            }
+            if (unit(rng) < config.components)
+                object->AddComponent<TestComponent>();
+            if (unit(rng) < config.moving)
+            {
+                moving.push_back(transform);
+                movingOrigins.push_back(position);
+            }
+            parent = object.getPtr();
+        }
+        const double createMilliseconds = Milliseconds(createStart, Clock::now());
+
+        Stage move("move");
+        Stage commands("commands");
+        Stage transforms("transforms");
+        Stage components("components");
+        Stage proxies("proxies");
+        Stage culling("culling");
+        Stage update("update");
+        Stage submit("submit");
+        Stage sort("sort");
+        Stage execute("execute");
+        Stage render("render");
+        Stage frame("frame");
+
+        // The scene is driven like Engine::Update and Engine::Render, with one fixed step per frame so runs compare
+        constexpr float deltaTime = 1.0f / 60.0f;
+        size_t visibleTotal = 0;
+        uint64_t drawCallTotal = 0;
+        std::array<uint64_t, Mesh::MaxLodCount> lodTriangleTotals = {};
+        double firstFrameMilliseconds = 0.0;
+        for (size_t f = 0; f < config.warmup + config.frames; f++)
+        {
+            const Clock::time_point frameStart = Clock::now();
+            const float time = static_cast<float>(f) * deltaTime;
+            for (size_t i = 0; i < moving.size(); i++)
+                moving[i]->SetLocalPosition(movingOrigins[i] + Vec3f(std::sin(time + static_cast<float>(i)), 0.0f, 0.0f));
+            const Clock::time_point updateStart = Clock::now();
+
+            scene->OnUpdate(deltaTime);
+            scene->UpdateView(deltaTime, 1.0f);
+            const Clock::time_point renderStart = Clock::now();
+
+            const uint64_t drawCalls = rendererStats.drawCalls;
+            engine->BeginFrame();
+            scene->OnRender(renderer);
+            engine->EndFrame();
+            const Clock::time_point frameEnd = Clock::now();
+
+            if (f == 0)
+                firstFrameMilliseconds = Milliseconds(frameStart, frameEnd);
+            if (f < config.warmup)
+                continue;
+
+            const SceneUpdateTimings& timings = scene->GetUpdateTimings();
+            move.samples.push_back(Milliseconds(frameStart, updateStart));
+            commands.samples.push_back(timings.commands);
+            transforms.samples.push_back(timings.transforms);
+            components.samples.push_back(timings.components);
+            proxies.samples.push_back(timings.proxies);
+            culling.samples.push_back(timings.culling);
+            update.samples.push_back(Milliseconds(updateStart, renderStart));
+            submit.samples.push_back(timings.submit);
+            sort.samples.push_back(timings.sort);
+            execute.samples.push_back(timings.execute);
+            render.samples.push_back(Milliseconds(renderStart, frameEnd));
+            frame.samples.push_back(Milliseconds(frameStart, frameEnd));
+            visibleTotal += scene->GetVisibleObjects().size();
+            drawCallTotal += rendererStats.drawCalls - drawCalls;
+            for (uint32_t lod = 0; lod < Mesh::MaxLodCount; lod++)
+                lodTriangleTotals[lod] += renderer->GetLodTriangleCount(lod);
+        }
+
+        char buffer[512];
+        std::string json = "{\n";
+        std::snprintf(buffer, sizeof(buffer),
+            "  \"config\": { \"objects\": %zu, \"depth\": %zu, \"moving\": %.3f, \"components\": %.3f, \"renderables\": %.3f, "
+            "\"model\": \"%s\", \"frames\": %zu, \"warmup\": %zu, \"seed\": %u, \"threads\": %zu },\n",
+            config.objects, config.depth, config.moving, config.components, config.renderables,
+            config.model.c_str(), config.frames, config.warmup, config.seed, ThreadPool::GetThreadCount());
+        json += buffer;
+        std::snprintf(buffer, sizeof(buffer), "  \"create_ms\": %.4f,\n  \"first_frame_ms\": %.4f,\n  \"visible_mean\": %.1f,\n  \"draw_calls_mean\": %.1f,\n",
+            createMilliseconds, firstFrameMilliseconds, static_cast<double>(visibleTotal) / config.frames,
+            static_cast<double>(drawCallTotal) / config.frames);
+        json += buffer;
+        json += "  \"lod_triangles_mean\": [";
+        for (uint32_t lod = 0; lod < Mesh::MaxLodCount; lod++)
+        {
+            std::snprintf(buffer, sizeof(buffer), "%s%.1f", lod == 0 ? " " : ", ", static_cast<double>(lodTriangleTotals[lod]) / config.frames);
+            json += buffer;
+        }
+        json += " ],\n  \"stages_ms\": {\n";
+        Stage* stages[] = { &move, &commands, &transforms, &components, &proxies, &culling, &update, &submit, &sort, &execute, &render, &frame };
+        for (size_t i = 0; i < std::size(stages); i++)
+            WriteStage(json, *stages[i], i + 1 == std::size(stages));
+        json += "  }\n}\n";
+
+        std::fputs(json.c_str(), stdout);
+        if (!config.output.empty())
+        {
+            if (FILE* file = std::fopen(config.output.c_str(), "w"))
+            {
+                std::fputs(json.c_str(), file);
+                std::fclose(file);
+            }
+            else
+            {
+                std::fprintf(stderr, "Could not write %s\n", config.output.c_str());
+            }
+        }
+    }
+    engine->WaitBeforeClean();
+    engine->Cleanup();
+    return 0;
+}
@@ -0,0 +1,13 @@
+
+-- Headless, MeshComponents on the null renderer, prints per-stage timings as JSON: xmake run SceneBench --objects 100000 --output bench.json
+target("SceneBench")
+	set_kind("binary")
+
+	add_deps("Engine")
+	add_includedirs("../../Engine/src")
+
+	add_files("scene_bench.cpp")
+
+	add_packages("galaxymath")
+	add_packages("thread-pool")
+target_end()
@@ -0,0 +1,639 @@
+﻿#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "Component/MeshComponent.h"
+#include "Component/TestComponent.h"
+#include "Component/TransformComponent.h"
+#include "Scene/GameObject.h"
+#include "Scene/Scene.h"
+#include "Scene/SceneCommandBuffer.h"
+
+using namespace testing;
+
+// Counts its updates and the time they were given, updated once per second
+class IntervalComponent : public IComponent
+{
+public:
+    DECLARE_COMPONENT_TYPE(IntervalComponent)
+
+    static void DescribeUpdate(ComponentUpdateInfo& info) { info.Parallel().Interval(1.0f); }
+    void OnUpdate(float deltaTime) override
+    {
+        updates++;
+        elapsed += deltaTime;
+    }
+
+    int updates = 0;
+    float elapsed = 0.0f;
+};
+
+// Same members as IntervalComponent without an update, to share its size
+class CounterComponent : public IComponent
+{
+public:
+    DECLARE_COMPONENT_TYPE(CounterComponent)
+
+    int updates = 0;
+    float elapsed = 0.0f;
+};
+
+// Changes the scene directly from its first update instead of going through the command buffer
+class SpawnerComponent : public IComponent
+{
+public:
+    DECLARE_COMPONENT_TYPE(SpawnerComponent)
+
+    static void DescribeUpdate(ComponentUpdateInfo& info) { info.Parallel(); }
+    void OnUpdate(float deltaTime) override
+    {
+        if (spawned)
+            return;
+        spawned = true;
+        created = p_gameObject->GetScene()->CreateGameObject().valid();
+        p_gameObject->AddComponent<TestComponent>();
+    }
+
+    bool spawned = false;
+    bool created = false;
+};
+
+// Batches its changes from a parallel update, like Model::Instantiate does on the main thread
+class BatchSpawnerComponent : public IComponent
+{
+public:
+    DECLARE_COMPONENT_TYPE(BatchSpawnerComponent)
+
+    static void DescribeUpdate(ComponentUpdateInfo& info) { info.Parallel(); }
+    void OnUpdate(float deltaTime) override
+    {
+        if (spawned)
+            return;
+        spawned = true;
+        Scene* scene = p_gameObject->GetScene();
+        scene->ReserveGameObjects(2);
+        scene->ReserveComponents<TestComponent>(2);
+        scene->Batch([&]()
+        {
+            created = scene->CreateGameObject().valid();
+            scene->CreateGameObject();
+        });
+    }
+
+    bool spawned = false;
+    bool created = false;
+};
+
+// Updated at its significance times the frame rate, each update takes cost microseconds
+class SignificanceComponent : public IComponent
+{
+public:
+    DECLARE_COMPONENT_TYPE(SignificanceComponent)
+
+    static void DescribeUpdate(ComponentUpdateInfo& info) { info.Significance(); }
+    float GetSignificance(const Vec3f& viewPosition) const override { return significance; }
+    void OnUpdate(float deltaTime) override
+    {
+        updates++;
+        const auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(cost);
+        while (std::chrono::steady_clock::now() < end)
+        {
+        }
+    }
+
+    int updates = 0;
+    float significance = 1.0f;
+    int cost = 0;
+};
+
+class SceneTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        scene = std::make_unique<Scene>();
+    }
+
+    void TearDown() override
+    {
+        scene.reset();
+    }
+
+    std::unique_ptr<Scene> scene;
+};
+
+// ============================================================================
+// Component Lookup Tests
+// ============================================================================
+
+TEST_F(SceneTest, AddComponent_GetComponentReturnsIt)
+{
+    SafePtr<GameObject> object = scene->CreateGameObject();
+    SafePtr<TestComponent> component = object->AddComponent<TestComponent>();
+
+    EXPECT_EQ(object->GetComponent<TestComponent>().getPtr(), component.getPtr());
+    EXPECT_TRUE(object->HasComponent<TestComponent>());
+}
+
+TEST_F(SceneTest, GetComponent_MissingTypeReturnsNull)
+{
+    SafePtr<GameObject> object = scene->CreateGameObject();
+
+    EXPECT_FALSE(object->GetComponent<MeshComponent>());
+    EXPECT_FALSE(object->HasComponent<MeshComponent>());
+}
+
+TEST_F(SceneTest, GetComponent_ReturnsComponentOfThisObject)
+{
+    SafePtr<GameObject> first = scene->CreateGameObject();
+    SafePtr<GameObject> second = scene->CreateGameObject();
+    first->AddComponent<TestComponent>();
+    SafePtr<TestComponent> secondComponent = second->AddComponent<TestComponent>();
+
+    EXPECT_EQ(second->GetComponent<TestComponent>().getPtr(), secondComponent.getPtr());
+}
+
+TEST_F(SceneTest, RemoveComponent_ClearsMaskAndKeepsOthers)
+{
+    SafePtr<GameObject> first = scene->CreateGameObject();
+    SafePtr<GameObject> second = scene->CreateGameObject();
+    first->AddComponent<TestComponent>();
+    SafePtr<TestComponent> secondComponent = second->AddComponent<TestComponent>();
+
+    first->RemoveComponent<TestComponent>();
+
+    EXPECT_FALSE(first->HasComponent<TestComponent>());
+    EXPECT_EQ(first->GetComponents().size(), 1u);
+    EXPECT_EQ(second->GetComponent<TestComponent>().getPtr(), secondComponent.getPtr());
+}
+
+TEST_F(SceneTest, RemoveAllComponents_ExpiresComponents)
+{
+    SafePtr<GameObject> object = scene->CreateGameObject();
+    SafePtr<TestComponent> component = object->AddComponent<TestComponent>();
+
+    scene->RemoveAllComponents(object.getPtr());
+
+    EXPECT_FALSE(component.valid());
+    EXPECT_TRUE(object->GetComponents().empty());
+    EXPECT_FALSE(object->HasComponent<TestComponent>());
+}
+
+// ============================================================================
+// View Tests
+// ============================================================================
+
+TEST_F(SceneTest, View_FollowsAddedAndRemovedComponents)
+{
+    SafePtr<GameObject> first = scene->CreateGameObject();
+    SafePtr<GameObject> second = scene->CreateGameObject();
+    first->AddComponent<TestComponent>();
+
+    SceneView<TransformComponent, TestComponent> view = scene->View<TransformComponent, TestComponent>();
+    EXPECT_EQ(view.Size(), 1u);
+
+    SafePtr<TestComponent> secondComponent = second->AddComponent<TestComponent>();
+    first->RemoveComponent<TestComponent>();
+    ASSERT_EQ(view.Size(), 1u);
+
+    for (auto [transform, test] : view)
+    {
+        EXPECT_EQ(&transform, second->GetTransform().getPtr());
+        EXPECT_EQ(&test, secondComponent.getPtr());
+    }
+
+    scene->DestroyGameObject(second.getPtr());
+    EXPECT_TRUE(view.Empty());
+}
+
+TEST_F(SceneTest, View_ParallelForEachVisitsEveryObject)
+{
+    constexpr size_t objectCount = 1000;
+    for (size_t i = 0; i < objectCount; i++)
+        scene->CreateGameObject()->AddComponent<TestComponent>();
+
+    std::atomic<size_t> visited = 0;
+    scene->View<TestComponent>().ParallelForEach([&visited](TestComponent&) { visited++; }, 16);
+
+    EXPECT_EQ(visited.load(), objectCount);
+}
+
+// ============================================================================
+// Index Tests
+// ============================================================================
+
+TEST_F(SceneTest, FindGameObjectsByName_FollowsRenames)
+{
+    SafePtr<GameObject> first = scene->CreateGameObject();
+    SafePtr<GameObject> second = scene->CreateGameObject();
+    first->SetName("Enemy");
+    second->SetName("Enemy");
+
+    EXPECT_EQ(scene->FindGameObjectsByName("Enemy").size(), 2u);
+    EXPECT_EQ(first->GetInternedName(), Name("Enemy"));
+
+    first->SetName("Boss");
+    EXPECT_EQ(scene->FindGameObjectByName("Boss"), first.getPtr());
+    ASSERT_EQ(scene->FindGameObjectsByName("Enemy").size(), 1u);
+    EXPECT_EQ(scene->FindGameObjectsByName("Enemy")[0], second.getPtr());
+    EXPECT_EQ(scene->FindGameObjectByName("Missing"), nullptr);
+}
+
+TEST_F(SceneTest, FindGameObjects_FiltersLayersAndTags)
+{
+    constexpr uint8_t enemyLayer = 3;
+    constexpr uint8_t flyingTag = 5;
+    SafePtr<GameObject> walker = scene->CreateGameObject();
+    SafePtr<GameObject> flyer = scene->CreateGameObject();
+    SafePtr<GameObject> bird = scene->CreateGameObject();
+    walker->SetLayer(enemyLayer);
+    flyer->SetLayer(enemyLayer);
+    flyer->AddTag(flyingTag);
+    bird->AddTag(flyingTag);
+
+    EXPECT_EQ(scene->GetGameObjectsInLayer(enemyLayer).size(), 2u);
+    std::vector<GameObject*> flyingEnemies = scene->FindGameObjects(LayerMask(1) << enemyLayer, TagMask(1) << flyingTag);
+    ASSERT_EQ(flyingEnemies.size(), 1u);
+    EXPECT_EQ(flyingEnemies[0], flyer.getPtr());
+
+    flyer->SetLayer(0);
+    EXPECT_EQ(scene->GetGameObjectsInLayer(enemyLayer).size(), 1u);
+    EXPECT_EQ(scene->FindGameObjects(LayerMask(1), TagMask(1) << flyingTag).size(), 2u);
+}
+
+TEST_F(SceneTest, DestroyGameObject_LeavesIndices)
+{
+    SafePtr<GameObject> parent = scene->CreateGameObject();
+    parent->SetName("Level");
+    for (int i = 0; i < 10; i++)
+    {
+        SafePtr<GameObject> child = scene->CreateGameObject(parent.getPtr());
+        child->SetName("Tree");
+        child->SetLayer(2);
+    }
+    SafePtr<GameObject> kept = scene->CreateGameObject();
+    kept->SetName("Tree");
+
+    scene->DestroyGameObject(parent.getPtr());
+
+    EXPECT_TRUE(scene->FindGameObjectsByName("Level").empty());
+    ASSERT_EQ(scene->FindGameObjectsByName("Tree").size(), 1u);
+    EXPECT_EQ(scene->FindGameObjectByName("Tree"), kept.getPtr());
+    EXPECT_TRUE(scene->GetGameObjectsInLayer(2).empty());
+}
+
+// ============================================================================
+// Destroy Tests
+// ============================================================================
+
+TEST_F(SceneTest, DestroyGameObject_RemovesWholeSubtree)
+{
+    SafePtr<GameObject> parent = scene->CreateGameObject();
+    std::vector<SafePtr<TestComponent>> destroyed;
+    std::vector<SafePtr<GameObject>> survivors;
+    SafePtr<GameObject> child;
+    for (size_t i = 0; i < 100; i++)
+    {
+        // Survivors interleaved with the subtree in the component arrays
+        if (i % 10 == 0)
+        {
+            survivors.push_back(scene->CreateGameObject());
+            survivors.back()->AddComponent<TestComponent>();
+        }
+        // Every other object is a grandchild
+        child = scene->CreateGameObject(i % 2 ? child.getPtr() : parent.getPtr());
+        destroyed.push_back(child->AddComponent<TestComponent>());
+    }
+    SceneView<TransformComponent, TestComponent> view = scene->View<TransformComponent, TestComponent>();
+    const size_t before = scene->GetGameObjects().size();
+
+    scene->DestroyGameObject(parent.getPtr());
+
+    EXPECT_EQ(scene->GetGameObjects().size(), before - 101);
+    for (const SafePtr<TestComponent>& component : destroyed)
+        EXPECT_FALSE(component.valid());
+    EXPECT_EQ(view.Size(), survivors.size());
+    for (auto [transform, test] : view)
+        EXPECT_EQ(transform.GetGameObject()->GetComponent<TestComponent>().getPtr(), &test);
+
+    // Storage indices still match after the compaction
+    for (const SafePtr<GameObject>& survivor : survivors)
+    {
+        survivor->RemoveComponent<TestComponent>();
+        EXPECT_FALSE(survivor->HasComponent<TestComponent>());
+    }
+    EXPECT_TRUE(view.Empty());
+}
+
+// ============================================================================
+// Deferred Change Tests
+// ============================================================================
+
+TEST_F(SceneTest, StructuralChangeDuringUpdate_AppliedAtNextFlush)
+{
+    SafePtr<GameObject> spawner = scene->CreateGameObject();
+    SafePtr<SpawnerComponent> component = spawner->AddComponent<SpawnerComponent>();
+    const size_t before = scene->GetGameObjects().size();
+
+    scene->OnUpdate(0.0f);
+    EXPECT_TRUE(component->spawned);
+    EXPECT_FALSE(component->created);
+    EXPECT_EQ(scene->GetGameObjects().size(), before);
+    EXPECT_FALSE(spawner->HasComponent<TestComponent>());
+
+    scene->FlushCommands();
+    EXPECT_EQ(scene->GetGameObjects().size(), before + 1);
+    EXPECT_TRUE(spawner->HasComponent<TestComponent>());
+}
+
+TEST_F(SceneTest, FlushCommands_RunsEveryThreadInRecordOrder)
+{
+    std::vector<int> order;
+    auto record = [&](int value)
+    {
+        scene->GetCommandBuffer().Enqueue([&order, value](Scene&) { order.push_back(value); });
+    };
+    record(1);
+    std::thread([&]() { record(2); }).join();
+    record(3);
+
+    scene->FlushCommands();
+    EXPECT_EQ(order, std::vector<int>({ 1, 2, 3 }));
+}
+
+TEST_F(SceneTest, BatchDuringUpdate_DefersInsteadOfBlocking)
+{
+    SafePtr<GameObject> spawner = scene->CreateGameObject();
+    SafePtr<BatchSpawnerComponent> component = spawner->AddComponent<BatchSpawnerComponent>();
+    const size_t before = scene->GetGameObjects().size();
+
+    scene->OnUpdate(0.0f);
+    EXPECT_TRUE(component->spawned);
+    EXPECT_FALSE(component->created);
+    EXPECT_EQ(scene->GetGameObjects().size(), before);
+
+    scene->FlushCommands();
+    EXPECT_EQ(scene->GetGameObjects().size(), before + 2);
+}
+
+// ============================================================================
+// Transform Tests
+// ============================================================================
+
+TEST_F(SceneTest, WorldQueries_FollowAParentChangedThisFrame)
+{
+    SafePtr<GameObject> parent = scene->CreateGameObject();
+    SafePtr<GameObject> child = scene->CreateGameObject(parent.getPtr());
+    SafePtr<GameObject> grandChild = scene->CreateGameObject(child.getPtr());
+    child->GetTransform()->SetLocalPosition(Vec3f(1.0f, 0.0f, 0.0f));
+    grandChild->GetTransform()->SetLocalPosition(Vec3f(0.0f, 1.0f, 0.0f));
+    scene->OnUpdate(0.0f);
+
+    // The parent and the grand child change, the child in between stays clean
+    parent->GetTransform()->SetLocalPosition(Vec3f(5.0f, 0.0f, 0.0f));
+    parent->GetTransform()->SetLocalRotation(Quat(0.0f, 0.70710678f, 0.0f, 0.70710678f));
+    parent->GetTransform()->SetLocalScale(Vec3f(2.0f, 3.0f, 4.0f));
+    grandChild->GetTransform()->SetLocalRotation(Quat(0.38268343f, 0.0f, 0.0f, 0.92387953f));
+
+    std::vector<TransformWorld> sameFrame;
+    for (GameObject* object : { child.getPtr(), grandChild.getPtr() })
+    {
+        TransformComponent* transform = object->GetTransform().getPtr();
+        sameFrame.push_back({ transform->GetWorldPosition(), transform->GetWorldRotation(), transform->GetWorldScale() });
+    }
+
+    scene->OnUpdate(0.0f);
+    size_t i = 0;
+    for (GameObject* object : { child.getPtr(), grandChild.getPtr() })
+    {
+        const TransformWorld& expected = sameFrame[i++];
+        TransformComponent* transform = object->GetTransform().getPtr();
+        const Vec3f position = transform->GetWorldPosition();
+        const Quat rotation = transform->GetWorldRotation();
+        const Vec3f scale = transform->GetWorldScale();
+        EXPECT_NEAR(expected.position.x, position.x, 1e-4f);
+        EXPECT_NEAR(expected.position.y, position.y, 1e-4f);
+        EXPECT_NEAR(expected.position.z, position.z, 1e-4f);
+        EXPECT_NEAR(expected.rotation.x, rotation.x, 1e-4f);
+        EXPECT_NEAR(expected.rotation.y, rotation.y, 1e-4f);
+        EXPECT_NEAR(expected.rotation.z, rotation.z, 1e-4f);
+        EXPECT_NEAR(expected.rotation.w, rotation.w, 1e-4f);
+        EXPECT_NEAR(expected.scale.x, scale.x, 1e-4f);
+        EXPECT_NEAR(expected.scale.y, scale.y, 1e-4f);
+        EXPECT_NEAR(expected.scale.z, scale.z, 1e-4f);
+    }
+}
+
+// ============================================================================
+// Culling Tests
+// ============================================================================
+
+TEST_F(SceneTest, AlwaysVisible_SkipsCullingUntilBoundsOrDestroy)
+{
+    SafePtr<GameObject> object = scene->CreateGameObject();
+    TransformComponent* transform = object->ResolveTransform();
+    auto isVisible = [this](const GameObject* gameObject)
+    {
+        return std::ranges::find(scene->GetVisibleObjects(), gameObject) != scene->GetVisibleObjects().end();
+    };
+    // One step, then the per frame culling
+    auto frame = [this]()
+    {
+        scene->OnUpdate(0.0f);
+        scene->UpdateView(0.0f, 1.0f);
+    };
+
+    // Without bounds an object is never culled, nor drawn unless it asks to be
+    frame();
+    EXPECT_FALSE(isVisible(object.getPtr()));
+    transform->SetLocalBounds(BoundingBox(), true);
+    frame();
+    EXPECT_TRUE(isVisible(object.getPtr()));
+    frame();
+    EXPECT_EQ(std::ranges::count(scene->GetVisibleObjects(), object.getPtr()), 1);
+
+    transform->SetLocalBounds(BoundingBox());
+    frame();
+    EXPECT_FALSE(isVisible(object.getPtr()));
+
+    transform->SetLocalBounds(BoundingBox(), true);
+    frame();
+    GameObject* destroyed = object.getPtr();
+    scene->DestroyGameObject(destroyed);
+    EXPECT_FALSE(isVisible(destroyed));
+    frame();
+    EXPECT_FALSE(isVisible(destroyed));
+}
+
+// ============================================================================
+// Component Type Tests
+// ============================================================================
+
+TEST_F(SceneTest, ComponentType_HashIsConstantAndIDsAreShared)
+{
+    static_assert(ComponentRegister::GetTypeHash<TestComponent>() == HashComponentName("TestComponent"));
+    static_assert(ComponentRegister::GetTypeHash<TestComponent>() != ComponentRegister::GetTypeHash<MeshComponent>());
+
+    // First use from several threads at once
+    std::vector<ComponentID> ids(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < ids.size(); i++)
+        threads.emplace_back([&ids, i]() { ids[i] = ComponentRegister::GetComponentID<SignificanceComponent>(); });
+    for (std::thread& thread : threads)
+        thread.join();
+    for (ComponentID id : ids)
+        EXPECT_EQ(id, ids.front());
+    EXPECT_LT(ids.front(), ComponentRegister::GetTypeCount());
+
+    ComponentRegister componentRegister;
+    componentRegister.RegisterComponent<TestComponent>();
+    const ComponentTypeInfo* info = componentRegister.Find("TestComponent");
+    ASSERT_NE(info, nullptr);
+    EXPECT_EQ(info->id, ComponentRegister::GetComponentID<TestComponent>());
+    EXPECT_EQ(componentRegister.Get(info->id), info);
+    EXPECT_EQ(componentRegister.Find(ComponentRegister::GetTypeHash<MeshComponent>()), nullptr);
+}
+
+TEST_F(SceneTest, ComponentArena_DoesNotInterleaveTypesOfTheSameSize)
+{
+    static_assert(sizeof(IntervalComponent) == sizeof(CounterComponent));
+    std::vector<uintptr_t> intervals;
+    std::vector<uintptr_t> counters;
+    for (int i = 0; i < 32; i++)
+    {
+        SafePtr<GameObject> object = scene->CreateGameObject();
+        intervals.push_back(reinterpret_cast<uintptr_t>(object->AddComponent<IntervalComponent>().getPtr()));
+        counters.push_back(reinterpret_cast<uintptr_t>(object->AddComponent<CounterComponent>().getPtr()));
+    }
+
+    const auto [intervalMin, intervalMax] = std::ranges::minmax(intervals);
+    const auto [counterMin, counterMax] = std::ranges::minmax(counters);
+    EXPECT_TRUE(intervalMax < counterMin || counterMax < intervalMin);
+}
+
+// ============================================================================
+// Update Budget Tests
+// ============================================================================
+
+TEST_F(SceneTest, Interval_SpreadsUpdatesAndPassesElapsedTime)
+{
+    std::vector<SafePtr<IntervalComponent>> components;
+    for (size_t i = 0; i < 100; i++)
+        components.push_back(scene->CreateGameObject()->AddComponent<IntervalComponent>());
+
+    // Ten seconds at four frames per second
+    size_t mostPerFrame = 0;
+    for (int frame = 0; frame < 40; frame++)
+    {
+        scene->OnUpdate(0.25f);
+        mostPerFrame = std::max(mostPerFrame, scene->GetBudgetStats().updated);
+    }
+
+    EXPECT_LT(mostPerFrame, 50u);
+    for (const SafePtr<IntervalComponent>& component : components)
+    {
+        EXPECT_GE(component->updates, 9);
+        EXPECT_LE(component->updates, 10);
+        // The wait spreading the instances is not passed on, every update gets one interval
+        EXPECT_FLOAT_EQ(component->elapsed, static_cast<float>(component->updates) * 1.0f);
+    }
+}
+
+TEST_F(SceneTest, Significance_ScalesUpdateRate)
+{
+    SafePtr<SignificanceComponent> near = scene->CreateGameObject()->AddComponent<SignificanceComponent>();
+    SafePtr<SignificanceComponent> far = scene->CreateGameObject()->AddComponent<SignificanceComponent>();
+    far->significance = 0.25f;
+
+    for (int frame = 0; frame < 20; frame++)
+        scene->OnUpdate(0.1f);
+
+    EXPECT_GE(near->updates, 19);
+    EXPECT_GE(far->updates, 4);
+    EXPECT_LE(far->updates, 6);
+}
+
+TEST_F(SceneTest, Budget_LimitsUpdatesWithoutStarving)
+{
+    std::vector<SafePtr<SignificanceComponent>> components;
+    for (size_t i = 0; i < 100; i++)
+    {
+        components.push_back(scene->CreateGameObject()->AddComponent<SignificanceComponent>());
+        components.back()->cost = 20;
+    }
+    scene->SetUpdateBudget(0.5);
+
+    // The first frame spreads the instances over one interval and measures the cost of the ones it runs
+    scene->OnUpdate(0.1f);
+    EXPECT_LT(scene->GetBudgetStats().updated, 100u);
+    for (int frame = 0; frame < 20; frame++)
+    {
+        scene->OnUpdate(0.1f);
+        const BudgetStats& stats = scene->GetBudgetStats();
+        EXPECT_EQ(stats.due, 100u);
+        EXPECT_GT(stats.updated, 0u);
+        EXPECT_LT(stats.updated, 100u);
+    }
+    // The ones left behind come first on the next frames
+    for (const SafePtr<SignificanceComponent>& component : components)
+        EXPECT_GE(component->updates, 2);
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+static double MeasureLookupNanoseconds(size_t objectCount)
+{
+    Scene scene;
+    std::vector<GameObject*> objects;
+    objects.reserve(objectCount);
+    for (size_t i = 0; i < objectCount; i++)
+    {
+        SafePtr<GameObject> object = scene.CreateGameObject();
+        object->AddComponent<TestComponent>();
+        objects.push_back(object.getPtr());
+    }
+
+    constexpr size_t lookupCount = 1'000'000;
+    size_t found = 0;
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < lookupCount; i++)
+    {
+        GameObject* object = objects[(i * 7919) % objectCount];
+        found += scene.HasComponent<TestComponent>(object) ? 1 : 0;
+        found += scene.GetComponent<TestComponent>(object) ? 1 : 0;
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    EXPECT_EQ(found, 2 * lookupCount);
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / lookupCount;
+}
+
+TEST_F(SceneTest, Benchmark_ComponentLookupIsFlat)
+{
+    const double baseline = MeasureLookupNanoseconds(1'000);
+    std::printf("[ BENCH    ] %8zu objects: %.1f ns/lookup\n", static_cast<size_t>(1'000), baseline);
+
+    for (size_t objectCount : { 10'000, 100'000, 1'000'000 })
+    {
+        const double nanoseconds = MeasureLookupNanoseconds(objectCount);
+        std::printf("[ BENCH    ] %8zu objects: %.1f ns/lookup\n", objectCount, nanoseconds);
+
+        // Cache misses grow with the scene, a linear scan would grow by 1000x
+        EXPECT_LT(nanoseconds, baseline * 20.0);
+    }
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
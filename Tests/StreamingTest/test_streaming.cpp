@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#include "Component/TestComponent.h"
+#include "Component/TransformComponent.h"
+#include "Core/ThreadPool.h"
+#include "Scene/GameObject.h"
+#include "Scene/Scene.h"
+#include "Scene/SceneSerializer.h"
+#include "Scene/WorldStreamer.h"
+
+using namespace testing;
+
+// Cell files of objectCount objects with a TestComponent each, written once per test
+class StreamingTest : public ::testing::Test
+{
+protected:
+    static constexpr size_t ObjectCount = 100;
+
+    void SetUp() override
+    {
+        ThreadPool::Initialize();
+        componentRegister.RegisterComponent<TransformComponent>();
+        componentRegister.RegisterComponent<TestComponent>();
+        directory = std::filesystem::temp_directory_path() / "StreamingTest";
+        std::filesystem::create_directories(directory);
+        for (int i = 0; i < 2; i++)
+        {
+            Scene cell;
+            for (size_t j = 0; j < ObjectCount; j++)
+            {
+                SafePtr<GameObject> object = cell.CreateGameObject();
+                object->AddComponent<TestComponent>();
+            }
+            ASSERT_TRUE(SceneSerializer::Save(cell, GetCellPath(i)));
+        }
+        scene = std::make_unique<Scene>();
+    }
+
+    void TearDown() override
+    {
+        scene.reset();
+        std::filesystem::remove_all(directory);
+        ThreadPool::Terminate();
+    }
+
+    std::filesystem::path GetCellPath(int index) const
+    {
+        return directory / ("cell" + std::to_string(index) + ".scene");
+    }
+
+    // Updates until the cell reaches state, false after a second
+    static bool UpdateUntil(WorldStreamer& streamer, const Vec3f& focus, const Vec3i& cell, CellState state)
+    {
+        const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (std::chrono::steady_clock::now() < end)
+        {
+            streamer.Update(focus);
+            if (streamer.GetCellState(cell) == state)
+                return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+
+    ComponentRegister componentRegister;
+    std::filesystem::path directory;
+    std::unique_ptr<Scene> scene;
+};
+
+// ============================================================================
+// Reader Tests
+// ============================================================================
+
+TEST_F(StreamingTest, Reader_InstantiatesInSteps)
+{
+    SceneFileReader reader;
+    ASSERT_TRUE(reader.Open(GetCellPath(0)));
+    EXPECT_EQ(reader.GetObjectCount(), ObjectCount);
+    EXPECT_EQ(reader.GetComponentCount(), ObjectCount);
+
+    const size_t before = scene->GetGameObjects().size();
+    const Handle<GameObject> root = scene->GetRootObject()->GetHandle();
+    EXPECT_FALSE(reader.Instantiate(*scene, root, componentRegister, nullptr, 30));
+    EXPECT_EQ(scene->GetGameObjects().size(), before + 30);
+
+    size_t calls = 1;
+    bool done = false;
+    while (!done)
+    {
+        done = reader.Instantiate(*scene, root, componentRegister, nullptr, 30);
+        calls++;
+    }
+    // 100 objects then 100 components
+    EXPECT_EQ(calls, 7u);
+    EXPECT_EQ(scene->GetGameObjects().size(), before + ObjectCount);
+    EXPECT_EQ(scene->View<TestComponent>().Size(), ObjectCount);
+}
+
+TEST_F(StreamingTest, Reader_RejectsInvalidFile)
+{
+    SceneFileReader reader;
+    EXPECT_FALSE(reader.Open(directory / "missing.scene"));
+    EXPECT_FALSE(reader.IsOpen());
+}
+
+// ============================================================================
+// Streamer Tests
+// ============================================================================
+
+TEST_F(StreamingTest, Streamer_LoadsNearCellsAndRemovesFarOnes)
+{
+    StreamingSettings settings;
+    settings.cellSize = 10.0f;
+    settings.loadRadius = 5.0f;
+    settings.unloadRadius = 15.0f;
+    WorldStreamer streamer(*scene, componentRegister, nullptr, settings);
+    streamer.AddCell(Vec3i(0, 0, 0), GetCellPath(0));
+    streamer.AddCell(Vec3i(10, 0, 0), GetCellPath(1));
+    const size_t before = scene->GetGameObjects().size();
+
+    ASSERT_TRUE(UpdateUntil(streamer, Vec3f(5.0f), Vec3i(0, 0, 0), CellState::Resident));
+    EXPECT_EQ(streamer.GetCellState(Vec3i(10, 0, 0)), CellState::Unloaded);
+    // The cell objects and the cell root
+    EXPECT_EQ(scene->GetGameObjects().size(), before + ObjectCount + 1);
+    EXPECT_GT(streamer.GetMemoryUsage(), 0u);
+
+    ASSERT_TRUE(UpdateUntil(streamer, Vec3f(105.0f, 5.0f, 5.0f), Vec3i(10, 0, 0), CellState::Resident));
+    ASSERT_TRUE(UpdateUntil(streamer, Vec3f(105.0f, 5.0f, 5.0f), Vec3i(0, 0, 0), CellState::Unloaded));
+    EXPECT_EQ(scene->GetGameObjects().size(), before + ObjectCount + 1);
+}
+
+TEST_F(StreamingTest, Streamer_KeepsMemoryInBudget)
+{
+    StreamingSettings settings;
+    settings.cellSize = 10.0f;
+    settings.loadRadius = 50.0f;
+    settings.unloadRadius = 50.0f;
+    size_t cellMemory = 0;
+    {
+        Scene measured;
+        WorldStreamer streamer(measured, componentRegister, nullptr, settings);
+        streamer.AddCell(Vec3i(0, 0, 0), GetCellPath(0));
+        ASSERT_TRUE(UpdateUntil(streamer, Vec3f(5.0f), Vec3i(0, 0, 0), CellState::Resident));
+        cellMemory = streamer.GetMemoryUsage();
+    }
+    // Room for one resident cell, not for the guess of the second one
+    settings.memoryBudget = cellMemory + std::filesystem::file_size(GetCellPath(1)) * 8 - 1;
+    WorldStreamer streamer(*scene, componentRegister, nullptr, settings);
+    streamer.AddCell(Vec3i(0, 0, 0), GetCellPath(0));
+    streamer.AddCell(Vec3i(1, 0, 0), GetCellPath(1));
+
+    ASSERT_TRUE(UpdateUntil(streamer, Vec3f(5.0f), Vec3i(0, 0, 0), CellState::Resident));
+    for (int i = 0; i < 10; i++)
+    {
+        streamer.Update(Vec3f(5.0f));
+        EXPECT_LE(streamer.GetMemoryUsage(), settings.memoryBudget);
+    }
+    EXPECT_EQ(streamer.GetCellState(Vec3i(1, 0, 0)), CellState::Unloaded);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
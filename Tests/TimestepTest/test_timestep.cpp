@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include "Component/TransformComponent.h"
+#include "Core/FixedTimestep.h"
+#include "Scene/GameObject.h"
+#include "Scene/Scene.h"
+#include "Utils/BatchMath.h"
+
+using namespace testing;
+
+class TimestepTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        scene = std::make_unique<Scene>();
+    }
+
+    void TearDown() override
+    {
+        scene.reset();
+    }
+
+    static void ExpectMatrixAt(const Mat4& matrix, const Vec3f& position)
+    {
+        TransformLocal local;
+        local.position = position;
+        Mat4 expected;
+        BatchMath::ComposeTransforms(&local, &expected, 1);
+
+        const float* values = reinterpret_cast<const float*>(&matrix);
+        const float* expectedValues = reinterpret_cast<const float*>(&expected);
+        for (int i = 0; i < 16; i++)
+            EXPECT_NEAR(values[i], expectedValues[i], 1e-5f) << "at " << i;
+    }
+
+    std::unique_ptr<Scene> scene;
+};
+
+// ============================================================================
+// Fixed Timestep Tests
+// ============================================================================
+
+TEST_F(TimestepTest, Advance_FirstCallRunsOneStep)
+{
+    FixedTimestep timestep;
+
+    EXPECT_EQ(timestep.Advance(0.0), 1u);
+    EXPECT_EQ(timestep.Advance(0.0), 0u);
+    EXPECT_FLOAT_EQ(timestep.GetAlpha(), 0.0f);
+}
+
+TEST_F(TimestepTest, Advance_KeepsRemainderAsAlpha)
+{
+    TimestepSettings settings;
+    settings.step = 0.01;
+    FixedTimestep timestep(settings);
+    timestep.Advance(0.0);
+
+    EXPECT_EQ(timestep.Advance(0.025), 2u);
+    EXPECT_NEAR(timestep.GetAlpha(), 0.5f, 1e-4f);
+    EXPECT_EQ(timestep.Advance(0.005), 1u);
+    EXPECT_NEAR(timestep.GetAlpha(), 0.0f, 1e-4f);
+    EXPECT_EQ(timestep.GetStepCount(), 4u);
+}
+
+TEST_F(TimestepTest, Advance_CapsStepsAndDropsTime)
+{
+    TimestepSettings settings;
+    settings.step = 0.01;
+    settings.maxStepsPerFrame = 3;
+    FixedTimestep timestep(settings);
+    timestep.Advance(0.0);
+
+    // A one second hitch does not queue a hundred steps for the next frames
+    EXPECT_EQ(timestep.Advance(1.0), 3u);
+    EXPECT_NEAR(timestep.GetDroppedTime(), 0.97, 1e-6);
+    EXPECT_EQ(timestep.Advance(0.0), 0u);
+    EXPECT_LT(timestep.GetAlpha(), 1.0f);
+}
+
+// ============================================================================
+// Interpolation Tests
+// ============================================================================
+
+TEST_F(TimestepTest, Interpolate_BlendsMovedTransforms)
+{
+    SafePtr<GameObject> moving = scene->CreateGameObject();
+    SafePtr<GameObject> still = scene->CreateGameObject();
+    scene->OnUpdate(0.0f);
+
+    moving->GetTransform()->SetLocalPosition(Vec3f(10.0f, 0.0f, 0.0f));
+    scene->OnUpdate(0.0f);
+    scene->Interpolate(0.25f);
+
+    ExpectMatrixAt(moving->GetTransform()->GetRenderMatrix(), Vec3f(2.5f, 0.0f, 0.0f));
+    ExpectMatrixAt(still->GetTransform()->GetRenderMatrix(), Vec3f(0.0f));
+
+    // Not moved by the next update, drawn where the simulation left it
+    scene->OnUpdate(0.0f);
+    ExpectMatrixAt(moving->GetTransform()->GetRenderMatrix(), Vec3f(10.0f, 0.0f, 0.0f));
+}
+
+TEST_F(TimestepTest, Interpolate_SkipsNewAndTeleportedTransforms)
+{
+    SafePtr<GameObject> object = scene->CreateGameObject();
+    object->GetTransform()->SetLocalPosition(Vec3f(4.0f, 0.0f, 0.0f));
+    scene->OnUpdate(0.0f);
+    scene->Interpolate(0.5f);
+    ExpectMatrixAt(object->GetTransform()->GetRenderMatrix(), Vec3f(4.0f, 0.0f, 0.0f));
+
+    object->GetTransform()->SetLocalPosition(Vec3f(100.0f, 0.0f, 0.0f));
+    object->GetTransform()->SkipInterpolation();
+    scene->OnUpdate(0.0f);
+    scene->Interpolate(0.5f);
+    ExpectMatrixAt(object->GetTransform()->GetRenderMatrix(), Vec3f(100.0f, 0.0f, 0.0f));
+}
+
+TEST_F(TimestepTest, Interpolate_FullAlphaMatchesWorldUnderScaledRotatedParent)
+{
+    // A world position, rotation and scale cannot describe the child of this parent, the shear must survive
+    SafePtr<GameObject> parent = scene->CreateGameObject();
+    SafePtr<GameObject> child = scene->CreateGameObject(parent.getPtr());
+    parent->GetTransform()->SetLocalScale(Vec3f(4.0f, 1.0f, 0.5f));
+    parent->GetTransform()->SetLocalRotation(Quat(0.0f, 0.38268343f, 0.0f, 0.92387953f));
+    child->GetTransform()->SetLocalRotation(Quat(0.0f, 0.0f, 0.38268343f, 0.92387953f));
+    scene->OnUpdate(0.0f);
+
+    parent->GetTransform()->SetLocalPosition(Vec3f(1.0f, 2.0f, 3.0f));
+    child->GetTransform()->SetLocalPosition(Vec3f(2.0f, 0.0f, 1.0f));
+    scene->OnUpdate(0.0f);
+    scene->Interpolate(1.0f);
+
+    for (const SafePtr<GameObject>& object : { parent, child })
+    {
+        const float* values = reinterpret_cast<const float*>(&object->GetTransform()->GetRenderMatrix());
+        const float* expected = reinterpret_cast<const float*>(&object->GetTransform()->GetWorldMatrix());
+        for (int i = 0; i < 16; i++)
+            EXPECT_NEAR(values[i], expected[i], 1e-5f) << "at " << i;
+    }
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}